@@ -0,0 +1,174 @@
+/*********************                                                        */
+/*! \file bench-cube-and-conquer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Compares CubeAndConquer with a single-threaded check_sat on
+**        bit-vector factoring problems.
+**
+** The problems ask for nontrivial factors of a semiprime (sat) and of a
+** prime (unsat) of about 2 * [bits] bits, with the first available
+** backend.
+**
+** Usage: bench-cube-and-conquer [threads] [split literals] [bits]
+**
+**/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cube_and_conquer.h"
+#include "smt.h"
+
+#if BUILD_BTOR
+#include "boolector_factory.h"
+#endif
+#if BUILD_BITWUZLA
+#include "bitwuzla_factory.h"
+#endif
+#if BUILD_CVC5
+#include "cvc5_factory.h"
+#endif
+#if BUILD_MSAT
+#include "msat_factory.h"
+#endif
+#if BUILD_YICES2
+#include "yices2_factory.h"
+#endif
+#if BUILD_Z3
+#include "z3_factory.h"
+#endif
+
+using namespace smt;
+using namespace std;
+
+// a solver of the first available backend, nullptr if there are none
+SmtSolver make_solver()
+{
+#if BUILD_BTOR
+  return BoolectorSolverFactory::create(false);
+#elif BUILD_BITWUZLA
+  return BitwuzlaSolverFactory::create(false);
+#elif BUILD_YICES2
+  return Yices2SolverFactory::create(false);
+#elif BUILD_CVC5
+  return Cvc5SolverFactory::create(false);
+#elif BUILD_Z3
+  return Z3SolverFactory::create(false);
+#elif BUILD_MSAT
+  return MsatSolverFactory::create(false);
+#else
+  return nullptr;
+#endif
+}
+
+bool is_prime(uint64_t n)
+{
+  if (n < 2)
+  {
+    return false;
+  }
+  for (uint64_t d = 2; d * d <= n; ++d)
+  {
+    if (n % d == 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the largest prime below 2^bits
+uint64_t prime_below(unsigned int bits)
+{
+  uint64_t p = (uint64_t(1) << bits) - 1;
+  while (!is_prime(p))
+  {
+    --p;
+  }
+  return p;
+}
+
+// x * y = n with 1 < x <= y, on 2 * bits bits
+TermVec factoring(const SmtSolver & s, unsigned int bits, uint64_t n)
+{
+  Sort half = s->make_sort(BV, bits);
+  Sort full = s->make_sort(BV, 2 * bits);
+  Term x = s->make_symbol("x", half);
+  Term y = s->make_symbol("y", half);
+  Term xw = s->make_term(Op(Zero_Extend, bits), x);
+  Term yw = s->make_term(Op(Zero_Extend, bits), y);
+  return { s->make_term(
+               Equal, s->make_term(BVMul, xw, yw), s->make_term(n, full)),
+           s->make_term(BVUgt, x, s->make_term(1, half)),
+           s->make_term(BVUle, x, y) };
+}
+
+double seconds_since(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char ** argv)
+{
+  size_t num_threads =
+      argc > 1 ? stoul(argv[1]) : thread::hardware_concurrency();
+  size_t num_split = argc > 2 ? stoul(argv[2]) : 6;
+  unsigned int bits = argc > 3 ? stoul(argv[3]) : 18;
+  if (!make_solver())
+  {
+    cout << "no solver backend available" << endl;
+    return 0;
+  }
+  num_threads = max<size_t>(num_threads, 1);
+
+  uint64_t p = prime_below(bits);
+  uint64_t q = prime_below(bits - 1);
+  uint64_t r = prime_below(2 * bits - 1);
+  cout << "threads: " << num_threads << ", split literals: " << num_split
+       << endl;
+
+  for (uint64_t n : { p * q, r })
+  {
+    SmtSolver single = make_solver();
+    for (const Term & a : factoring(single, bits, n))
+    {
+      single->assert_formula(a);
+    }
+    auto start = chrono::steady_clock::now();
+    Result single_res = single->check_sat();
+    double single_time = seconds_since(start);
+
+    SmtSolver source = make_solver();
+    vector<SmtSolver> workers;
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+      workers.push_back(make_solver());
+    }
+    start = chrono::steady_clock::now();
+    CubeAndConquer cc(source, workers);
+    for (const Term & a : factoring(source, bits, n))
+    {
+      cc.assert_formula(a);
+    }
+    Result cc_res = cc.check_sat(num_split);
+    double cc_time = seconds_since(start);
+
+    cout << n << ": check_sat " << single_res << " in " << single_time
+         << "s, cube and conquer " << cc_res << " in " << cc_time << "s ("
+         << cc.get_num_refuted() << " cubes refuted, speedup "
+         << single_time / cc_time << ")" << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*********************                                                        */
+/*! \file bench-generic-let.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Yoni Zohar
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Compares the size and time of the let-based serialization of
+**        quantified formulas in GenericSolver against fully expanding
+**        the formula.
+**
+** Usage: bench-generic-let <path to solver binary> [depth] [args...]
+**
+**/
+
+// generic solvers are not supported on macos
+#ifndef __APPLE__
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "generic_solver.h"
+#include "smt.h"
+
+using namespace smt;
+using namespace std;
+
+// exposes the serialization of GenericSolver
+class BenchGenericSolver : public GenericSolver
+{
+ public:
+  using GenericSolver::GenericSolver;
+  using GenericSolver::to_smtlib_def;
+};
+
+// size of the fully expanded term, without building it
+size_t expanded_size(Term t, unordered_map<Term, size_t> & cache)
+{
+  auto it = cache.find(t);
+  if (it != cache.end())
+  {
+    return it->second;
+  }
+  size_t result;
+  if (t->get_op().is_null())
+  {
+    result = t->to_string().size();
+  }
+  else
+  {
+    // "(" op " " child ... ")"
+    result = 2 + t->get_op().to_string().size();
+    for (auto c : t)
+    {
+      result += 1 + expanded_size(c, cache);
+    }
+  }
+  cache[t] = result;
+  return result;
+}
+
+// the fully expanded term, as it was written before let bindings
+void expand(Term t, string & out)
+{
+  if (t->get_op().is_null())
+  {
+    out += t->to_string();
+    return;
+  }
+  out += "(" + t->get_op().to_string();
+  for (auto c : t)
+  {
+    out += " ";
+    expand(c, out);
+  }
+  out += ")";
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2)
+  {
+    cout << "Usage: " << argv[0] << " <path to solver binary> [depth] [args...]"
+         << endl;
+    return 1;
+  }
+  string path = argv[1];
+  size_t depth = argc > 2 ? stoul(argv[2]) : 24;
+  vector<string> args;
+  for (int i = 3; i < argc; ++i)
+  {
+    args.push_back(argv[i]);
+  }
+
+  auto s = make_shared<BenchGenericSolver>(path, args);
+  s->set_logic("BV");
+  Sort bvsort = s->make_sort(BV, 32);
+  Term x = s->make_param("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+
+  // every level uses the previous one twice, the shape of
+  // an unrolled circuit inside a quantifier
+  Term body = x;
+  for (size_t i = 0; i < depth; ++i)
+  {
+    Term prev = body;
+    body = s->make_term(BVAdd, s->make_term(BVMul, prev, y), prev);
+  }
+  body = s->make_term(Equal, body, y);
+
+  auto start = chrono::steady_clock::now();
+  Term formula = s->make_term(Forall, x, body);
+  s->assert_formula(formula);
+  Result r = s->check_sat();
+  auto end = chrono::steady_clock::now();
+
+  unordered_map<Term, size_t> cache;
+  size_t let_bytes = s->to_smtlib_def(formula).size();
+  size_t expanded_bytes = expanded_size(body, cache);
+
+  cout << "depth: " << depth << endl;
+  cout << "result: " << r << endl;
+  cout << "let bytes: " << let_bytes << endl;
+  cout << "expanded bytes: " << expanded_bytes << endl;
+  cout << "let define + check-sat time: "
+       << chrono::duration<double>(end - start).count() << "s" << endl;
+
+  // only print the expanded version when it fits in memory comfortably
+  if (expanded_bytes < (1ul << 28))
+  {
+    start = chrono::steady_clock::now();
+    string expanded;
+    expand(body, expanded);
+    end = chrono::steady_clock::now();
+    cout << "expanded printing time (without sending): "
+         << chrono::duration<double>(end - start).count() << "s" << endl;
+  }
+  else
+  {
+    cout << "expanded printing skipped" << endl;
+  }
+  return 0;
+}
+
+#endif  // __APPLE__
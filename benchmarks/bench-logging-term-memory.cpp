@@ -0,0 +1,102 @@
+/*********************                                                        */
+/*! \file bench-logging-term-memory.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Reports the memory used per LoggingTerm, with and without the
+**        pool allocator of LoggingSolver.
+**
+** Only the LoggingTerms are counted: all of them wrap the same
+** underlying term, so the memory of the underlying solver is not
+** included.
+**
+** Usage: bench-logging-term-memory [number of terms]
+**
+**/
+
+#include <malloc.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "generic_sort.h"
+#include "generic_term.h"
+#include "logging_sort.h"
+#include "logging_term.h"
+#include "smt.h"
+
+using namespace smt;
+using namespace std;
+
+size_t heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().uordblks;
+#else
+  return mallinfo().uordblks;
+#endif
+}
+
+// builds num_terms binary terms over a fixed set of leaves
+// and returns the heap bytes per term
+template <class MakeTerm>
+double bytes_per_term(size_t num_terms, MakeTerm make_term)
+{
+  Sort wrapped_sort = make_generic_sort(BV, 32);
+  Sort sort = make_logging_sort(BV, wrapped_sort, 32);
+  Term wrapped =
+      make_shared<GenericTerm>(wrapped_sort, Op(), TermVec{}, "x", true);
+
+  const size_t num_leaves = 1000;
+  TermVec terms;
+  terms.reserve(num_leaves + num_terms);
+  for (size_t i = 0; i < num_leaves; ++i)
+  {
+    terms.push_back(make_term(
+        wrapped, sort, Op(), TermVec{}, "x" + to_string(i), true, i));
+  }
+
+  // the temporary children vectors are freed right away
+  size_t before = heap_in_use();
+  for (size_t i = 0; i < num_terms; ++i)
+  {
+    terms.push_back(make_term(
+        wrapped,
+        sort,
+        Op(BVAdd),
+        TermVec{ terms[i % num_leaves], terms[(7 * i + 1) % num_leaves] },
+        num_leaves + i));
+  }
+  size_t after = heap_in_use();
+  return double(after - before) / num_terms;
+}
+
+int main(int argc, char ** argv)
+{
+  size_t num_terms = argc > 1 ? stoul(argv[1]) : 1000000;
+
+  double shared_bytes = bytes_per_term(num_terms, [](auto &&... args) {
+    return Term(make_shared<LoggingTerm>(args...));
+  });
+
+  LoggingTermPool * pool = new LoggingTermPool();
+  double pool_bytes = bytes_per_term(num_terms, [pool](auto &&... args) {
+    return Term(allocate_shared<LoggingTerm>(
+        LoggingTermAllocator<LoggingTerm>(pool), args...));
+  });
+  pool->release();
+
+  cout << "sizeof(LoggingTerm): " << sizeof(LoggingTerm) << endl;
+  cout << "binary terms: " << num_terms << endl;
+  cout << "bytes per term (make_shared): " << shared_bytes << endl;
+  cout << "bytes per term (pool): " << pool_bytes << endl;
+  return 0;
+}
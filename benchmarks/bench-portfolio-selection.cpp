@@ -0,0 +1,202 @@
+/*********************                                                        */
+/*! \file bench-portfolio-selection.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Measures the CPU time saved by a PortfolioSolver that launches
+**        only the members a SolverSelector ranks best, compared to
+**        launching all of them.
+**
+** The queries are bit-vector factoring problems (nonlinear) and chains
+** of additions (linear) of several widths. A first pass launches every
+** member and fills the performance table; the table is saved to
+** [table file] if given. Then the same queries are solved launching all
+** members, the top-1 member, and all members one after another in time
+** slices.
+**
+** Usage: bench-portfolio-selection [queries per family] [table file]
+**
+**/
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "portfolio_solver.h"
+#include "smt.h"
+#include "solver_selector.h"
+
+#if BUILD_BTOR
+#include "boolector_factory.h"
+#endif
+#if BUILD_BITWUZLA
+#include "bitwuzla_factory.h"
+#endif
+#if BUILD_CVC5
+#include "cvc5_factory.h"
+#endif
+#if BUILD_MSAT
+#include "msat_factory.h"
+#endif
+#if BUILD_YICES2
+#include "yices2_factory.h"
+#endif
+#if BUILD_Z3
+#include "z3_factory.h"
+#endif
+
+using namespace smt;
+using namespace std;
+
+// one solver of each available backend
+vector<SmtSolver> make_members()
+{
+  vector<SmtSolver> res;
+#if BUILD_BTOR
+  res.push_back(BoolectorSolverFactory::create(false));
+#endif
+#if BUILD_BITWUZLA
+  res.push_back(BitwuzlaSolverFactory::create(false));
+#endif
+#if BUILD_CVC5
+  res.push_back(Cvc5SolverFactory::create(false));
+#endif
+#if BUILD_MSAT
+  res.push_back(MsatSolverFactory::create(false));
+#endif
+#if BUILD_YICES2
+  res.push_back(Yices2SolverFactory::create(false));
+#endif
+#if BUILD_Z3
+  res.push_back(Z3SolverFactory::create(false));
+#endif
+  return res;
+}
+
+// asserts the i-th query of a family
+void assert_query(const SmtSolver & s, bool nonlinear, size_t i)
+{
+  uint64_t width = 24 + 8 * (i % 4);
+  Sort bvsort = s->make_sort(BV, width);
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term one = s->make_term(1, bvsort);
+  if (nonlinear)
+  {
+    // nontrivial factors of an odd number
+    Term n = s->make_term(1000003 + 2 * i, bvsort);
+    s->assert_formula(s->make_term(Equal, s->make_term(BVMul, x, y), n));
+    s->assert_formula(s->make_term(BVUgt, x, one));
+    s->assert_formula(s->make_term(BVUgt, y, one));
+    Term half = s->make_term(1ULL << (width / 2), bvsort);
+    s->assert_formula(s->make_term(BVUlt, x, half));
+    s->assert_formula(s->make_term(BVUlt, y, half));
+  }
+  else
+  {
+    Term sum = x;
+    for (size_t j = 0; j < 50 + 10 * i; ++j)
+    {
+      Term z = s->make_symbol("z" + to_string(j), bvsort);
+      s->assert_formula(s->make_term(BVUlt, z, s->make_term(j + 2, bvsort)));
+      sum = s->make_term(BVAdd, sum, z);
+    }
+    s->assert_formula(s->make_term(Equal, sum, y));
+    s->assert_formula(s->make_term(BVUgt, y, s->make_term(100 + i, bvsort)));
+  }
+}
+
+struct RunStats
+{
+  double cpu_seconds = 0;
+  double wall_seconds = 0;
+  size_t answered = 0;
+};
+
+RunStats run(shared_ptr<SolverSelector> sel,
+             size_t k,
+             double time_slice,
+             size_t num_queries)
+{
+  RunStats stats;
+  for (bool nonlinear : { true, false })
+  {
+    for (size_t i = 0; i < num_queries; ++i)
+    {
+      // a fresh portfolio, so that the members start from scratch
+      // the terms are built by a separate solver of the first backend
+      SmtSolver source = make_members().front();
+      shared_ptr<PortfolioSolver> p =
+          make_shared<PortfolioSolver>(source, make_members());
+      p->set_logic("QF_BV");
+      if (sel)
+      {
+        p->set_selector(sel, k, time_slice);
+      }
+      assert_query(p, nonlinear, i);
+      auto start = chrono::steady_clock::now();
+      Result r = p->check_sat();
+      stats.wall_seconds +=
+          chrono::duration<double>(chrono::steady_clock::now() - start)
+              .count();
+      stats.cpu_seconds += p->get_cpu_time().count();
+      stats.answered += r.is_sat() || r.is_unsat();
+    }
+  }
+  return stats;
+}
+
+void print(const string & name, const RunStats & stats, const RunStats & base)
+{
+  cout << name << ": " << stats.answered << " answered, " << stats.wall_seconds
+       << "s wall, " << stats.cpu_seconds << "s CPU ("
+       << base.cpu_seconds - stats.cpu_seconds << "s CPU saved)" << endl;
+}
+
+int main(int argc, char ** argv)
+{
+  size_t num_queries = argc > 1 ? stoul(argv[1]) : 8;
+  size_t num_members = make_members().size();
+  if (num_members < 2)
+  {
+    cout << "at least two solver backends are needed, " << num_members
+         << " available" << endl;
+    return 0;
+  }
+
+  // training: launch every member and record who wins
+  shared_ptr<SolverSelector> sel = make_shared<SolverSelector>();
+  run(sel, num_members, 0, num_queries);
+  if (argc > 2)
+  {
+    sel->save_file(argv[2]);
+  }
+
+  RunStats all = run(nullptr, num_members, 0, num_queries);
+  // a copy of the trained table, to compare the selections on equal terms
+  auto frozen = [&sel]() {
+    stringstream ss;
+    sel->save(ss);
+    shared_ptr<SolverSelector> res = make_shared<SolverSelector>();
+    res->load(ss);
+    return res;
+  };
+  RunStats top1 = run(frozen(), 1, 0, num_queries);
+  RunStats sliced = run(frozen(), num_members, 0.1, num_queries);
+
+  cout << "members: " << num_members << ", queries: " << 2 * num_queries
+       << endl;
+  print("all members", all, all);
+  print("top-1 member", top1, all);
+  print("sequential, 0.1s slices", sliced, all);
+  return 0;
+}
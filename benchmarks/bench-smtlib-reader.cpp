@@ -0,0 +1,182 @@
+/*********************                                                        */
+/*! \file bench-smtlib-reader.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Measures the parsing throughput of SmtLibReader, reading files
+**        (memory-mapped), reading the same files from a std::ifstream,
+**        and with parse_parallel, with its speedup over parse.
+**
+** Commands are parsed and terms are built with the first available
+** backend, but nothing is asserted or solved. Without file arguments, a
+** generated QF_UFBV file with [size] assertions is parsed.
+**
+** Usage: bench-smtlib-reader [repeats] [size] [threads] [files...]
+**
+**/
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "smt.h"
+#include "smtlib_reader.h"
+
+#if BUILD_BTOR
+#include "boolector_factory.h"
+#endif
+#if BUILD_BITWUZLA
+#include "bitwuzla_factory.h"
+#endif
+#if BUILD_CVC5
+#include "cvc5_factory.h"
+#endif
+#if BUILD_MSAT
+#include "msat_factory.h"
+#endif
+#if BUILD_YICES2
+#include "yices2_factory.h"
+#endif
+#if BUILD_Z3
+#include "z3_factory.h"
+#endif
+
+using namespace smt;
+using namespace std;
+
+// a solver of the first available backend, nullptr if there are none
+SmtSolver make_solver()
+{
+#if BUILD_BTOR
+  return BoolectorSolverFactory::create(false);
+#elif BUILD_BITWUZLA
+  return BitwuzlaSolverFactory::create(false);
+#elif BUILD_YICES2
+  return Yices2SolverFactory::create(false);
+#elif BUILD_CVC5
+  return Cvc5SolverFactory::create(false);
+#elif BUILD_Z3
+  return Z3SolverFactory::create(false);
+#elif BUILD_MSAT
+  return MsatSolverFactory::create(false);
+#else
+  return nullptr;
+#endif
+}
+
+// builds the terms of each command, without solving
+class ParseOnlyReader : public SmtLibReader
+{
+ public:
+  ParseOnlyReader(SmtSolver & solver) : SmtLibReader(solver) {}
+
+  void assert_formula(const Term & assertion) override {}
+  Result check_sat() override { return Result(UNKNOWN); }
+  Result check_sat_assuming(const TermVec & assumptions) override
+  {
+    return Result(UNKNOWN);
+  }
+};
+
+// writes a QF_UFBV file with size assertions over 100 symbols
+void generate(const string & file, size_t size)
+{
+  ofstream out(file);
+  out << "(set-logic QF_UFBV)" << endl;
+  out << "(declare-fun |the function| ((_ BitVec 32)) (_ BitVec 32))" << endl;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    out << "(declare-fun bench_symbol_" << i << " () (_ BitVec 32))" << endl;
+  }
+  for (size_t i = 0; i < size; ++i)
+  {
+    string a = "bench_symbol_" + to_string(i % 100);
+    string b = "bench_symbol_" + to_string((i * 7 + 3) % 100);
+    out << "(assert (let ((t (bvadd " << a << " (|the function| " << b
+        << ")))) (or (bvult t #x" << hex << (i * 2654435761u) % 0xffffffff
+        << dec << ") (= (bvmul t " << b << ") " << a << "))))" << endl;
+  }
+  out << "(check-sat)" << endl;
+}
+
+// returns the seconds spent in parse, summed over the repeats
+template <class F>
+double time_parses(size_t repeats, F parse)
+{
+  double total = 0;
+  for (size_t i = 0; i < repeats; ++i)
+  {
+    // a fresh solver, because the symbols are declared again
+    SmtSolver s = make_solver();
+    ParseOnlyReader reader(s);
+    auto start = chrono::steady_clock::now();
+    parse(reader);
+    total += chrono::duration<double>(chrono::steady_clock::now() - start)
+                 .count();
+  }
+  return total;
+}
+
+int main(int argc, char ** argv)
+{
+  size_t repeats = argc > 1 ? stoul(argv[1]) : 5;
+  size_t size = argc > 2 ? stoul(argv[2]) : 100000;
+  size_t num_threads =
+      argc > 3 ? stoul(argv[3]) : thread::hardware_concurrency();
+  if (!make_solver())
+  {
+    cout << "no solver backend available" << endl;
+    return 0;
+  }
+
+  vector<string> files(argv + min(argc, 4), argv + argc);
+  if (files.empty())
+  {
+    files.push_back("bench-smtlib-reader.smt2");
+    generate(files.back(), size);
+  }
+
+  for (const string & f : files)
+  {
+    ifstream probe(f, ios::binary | ios::ate);
+    if (!probe)
+    {
+      cout << f << ": cannot open" << endl;
+      continue;
+    }
+    double mb = double(probe.tellg()) / (1 << 20) * repeats;
+
+    try
+    {
+      double mapped = time_parses(
+          repeats, [&f](ParseOnlyReader & r) { r.parse(f); });
+      double streamed =
+          time_parses(repeats, [&f](ParseOnlyReader & r) {
+            ifstream in(f);
+            r.parse(in, false, f);
+          });
+      double parallel =
+          time_parses(repeats, [&f, num_threads](ParseOnlyReader & r) {
+            r.parse_parallel(f, num_threads);
+          });
+      cout << f << ": file " << mb / mapped << " MB/s, stream "
+           << mb / streamed << " MB/s, parallel (" << num_threads
+           << " threads) " << mb / parallel << " MB/s, speedup "
+           << mapped / parallel << endl;
+    }
+    catch (SmtException & e)
+    {
+      cout << f << ": skipped, " << e.what() << endl;
+    }
+  }
+  return 0;
+}
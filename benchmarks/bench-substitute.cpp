@@ -0,0 +1,207 @@
+/*********************                                                        */
+/*! \file bench-substitute.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Compares the ways of substituting a batch of terms, with each
+**        available backend.
+**
+** The workload is an unrolling: a bit-vector transition relation over
+** [vars] state variables is copied to [frames] time frames by
+** substituting fresh symbols for the current and next state variables.
+** Each frame is substituted with
+**   - substitute, once per term
+**   - the generic AbsSmtSolver::substitute_terms
+**   - the backend's substitute_terms
+**
+** Usage: bench-substitute [vars] [frames]
+**
+**/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "smt.h"
+
+#if BUILD_BTOR
+#include "boolector_factory.h"
+#endif
+#if BUILD_BITWUZLA
+#include "bitwuzla_factory.h"
+#endif
+#if BUILD_CVC5
+#include "cvc5_factory.h"
+#endif
+#if BUILD_MSAT
+#include "msat_factory.h"
+#endif
+#if BUILD_YICES2
+#include "yices2_factory.h"
+#endif
+#if BUILD_Z3
+#include "z3_factory.h"
+#endif
+
+using namespace smt;
+using namespace std;
+
+// the available backends, by name
+vector<pair<string, function<SmtSolver()>>> backends()
+{
+  vector<pair<string, function<SmtSolver()>>> res;
+#if BUILD_BTOR
+  res.push_back(
+      { "btor", [] { return BoolectorSolverFactory::create(false); } });
+#endif
+#if BUILD_BITWUZLA
+  res.push_back(
+      { "bitwuzla", [] { return BitwuzlaSolverFactory::create(false); } });
+#endif
+#if BUILD_CVC5
+  res.push_back({ "cvc5", [] { return Cvc5SolverFactory::create(false); } });
+#endif
+#if BUILD_MSAT
+  res.push_back({ "msat", [] { return MsatSolverFactory::create(false); } });
+#endif
+#if BUILD_YICES2
+  res.push_back(
+      { "yices2", [] { return Yices2SolverFactory::create(false); } });
+#endif
+#if BUILD_Z3
+  res.push_back({ "z3", [] { return Z3SolverFactory::create(false); } });
+#endif
+  return res;
+}
+
+double seconds_since(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+struct Unrolling
+{
+  TermVec vars;
+  TermVec next_vars;
+  // one constraint per state variable, over vars and next_vars
+  TermVec trans;
+  // for each frame, the map to the symbols of that frame
+  vector<UnorderedTermMap> frame_maps;
+};
+
+// a transition relation where the constraints share subterms, like those
+// of a hardware model
+Unrolling make_unrolling(const SmtSolver & s, size_t num_vars, size_t frames)
+{
+  Unrolling u;
+  Sort bvsort = s->make_sort(BV, 32);
+  for (size_t i = 0; i < num_vars; ++i)
+  {
+    u.vars.push_back(s->make_symbol("x" + to_string(i), bvsort));
+    u.next_vars.push_back(
+        s->make_symbol("x" + to_string(i) + ".next", bvsort));
+  }
+
+  // a layer of shared subterms over the current state
+  TermVec shared;
+  for (size_t i = 0; i < num_vars; ++i)
+  {
+    const Term & a = u.vars[i];
+    const Term & b = u.vars[(i + 1) % num_vars];
+    const Term & c = u.vars[(i + 7) % num_vars];
+    Term sum = s->make_term(BVAdd, a, s->make_term(BVMul, b, c));
+    shared.push_back(s->make_term(
+        Ite, s->make_term(BVUlt, a, b), sum, s->make_term(BVXor, sum, c)));
+  }
+  for (size_t i = 0; i < num_vars; ++i)
+  {
+    Term update = s->make_term(
+        BVAnd, shared[i], s->make_term(BVOr, shared[(i + 3) % num_vars],
+                                       shared[(i + 5) % num_vars]));
+    u.trans.push_back(s->make_term(Equal, u.next_vars[i], update));
+  }
+
+  // the symbols of frame k + 1 are the next state of frame k
+  vector<TermVec> frame_vars(frames + 1);
+  for (size_t k = 0; k <= frames; ++k)
+  {
+    for (size_t i = 0; i < num_vars; ++i)
+    {
+      frame_vars[k].push_back(s->make_symbol(
+          "x" + to_string(i) + "@" + to_string(k), bvsort));
+    }
+  }
+  for (size_t k = 0; k < frames; ++k)
+  {
+    UnorderedTermMap m;
+    for (size_t i = 0; i < num_vars; ++i)
+    {
+      m[u.vars[i]] = frame_vars[k][i];
+      m[u.next_vars[i]] = frame_vars[k + 1][i];
+    }
+    u.frame_maps.push_back(move(m));
+  }
+  return u;
+}
+
+int main(int argc, char ** argv)
+{
+  size_t num_vars = argc > 1 ? stoul(argv[1]) : 200;
+  size_t frames = argc > 2 ? stoul(argv[2]) : 50;
+
+  auto available = backends();
+  if (available.empty())
+  {
+    cout << "no solver backend available" << endl;
+    return 0;
+  }
+  cout << "vars: " << num_vars << ", frames: " << frames << endl;
+
+  for (const auto & backend : available)
+  {
+    // a fresh solver per method, so none reuses terms built by another
+    double times[3];
+    for (size_t method = 0; method < 3; ++method)
+    {
+      SmtSolver s = backend.second();
+      Unrolling u = make_unrolling(s, num_vars, frames);
+      auto start = chrono::steady_clock::now();
+      for (const UnorderedTermMap & m : u.frame_maps)
+      {
+        TermVec res;
+        if (method == 0)
+        {
+          for (const Term & t : u.trans)
+          {
+            res.push_back(s->substitute(t, m));
+          }
+        }
+        else if (method == 1)
+        {
+          res = s->AbsSmtSolver::substitute_terms(u.trans, m);
+        }
+        else
+        {
+          res = s->substitute_terms(u.trans, m);
+        }
+      }
+      times[method] = seconds_since(start);
+    }
+
+    cout << backend.first << ": substitute " << times[0]
+         << "s, generic substitute_terms " << times[1]
+         << "s, native substitute_terms " << times[2] << "s (speedup "
+         << times[0] / times[2] << ")" << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*********************                                                        */
+/*! \file bench-term-hashtable.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Measures the hash-consing throughput of TermHashTable on the
+**        terms of a large bit-vector unrolling, as built by
+**        LoggingSolver::make_term.
+**
+** The terms are LoggingTerms wrapping GenericTerms that are built
+** directly, so that no underlying solver contributes to the time.
+** For comparison, the same workload runs on the previous table layout
+** (a std::unordered_map of hash values to UnorderedTermSet).
+**
+** Usage: bench-term-hashtable [steps] [state vars]
+**
+**/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "generic_sort.h"
+#include "generic_term.h"
+#include "logging_sort.h"
+#include "logging_term.h"
+#include "smt.h"
+#include "term_hashtable.h"
+
+using namespace smt;
+using namespace std;
+
+// the node-based table that TermHashTable replaced
+class NodeTermHashTable
+{
+ public:
+  bool lookup_or_insert(Term & t)
+  {
+    size_t hashval = t->hash();
+    if (table.find(hashval) != table.end()
+        && table.at(hashval).find(t) != table.at(hashval).end())
+    {
+      t = *(table[hashval].find(t));
+      return true;
+    }
+    table[hashval].insert(t);
+    return false;
+  }
+  void reserve(size_t n) { table.reserve(n); }
+
+ protected:
+  unordered_map<size_t, UnorderedTermSet> table;
+};
+
+// exposes the wrapped term of a LoggingTerm
+class BenchLoggingTerm : public LoggingTerm
+{
+ public:
+  using LoggingTerm::LoggingTerm;
+  const Term & get_wrapped_term() const { return wrapped_term; }
+};
+
+const Term & wrapped(const Term & t)
+{
+  return static_cast<BenchLoggingTerm *>(t.get())->get_wrapped_term();
+}
+
+// builds terms the way LoggingSolver::make_term does
+template <class Table>
+class TermBuilder
+{
+ public:
+  TermBuilder(Table & table)
+      : table(table),
+        wrapped_sort(make_generic_sort(BV, 32)),
+        sort(make_logging_sort(BV, wrapped_sort, 32)),
+        next_term_id(0)
+  {
+  }
+
+  Term make_symbol(const string & name)
+  {
+    Term w = make_shared<GenericTerm>(wrapped_sort, Op(), TermVec{}, name, true);
+    return hash_cons(make_shared<BenchLoggingTerm>(
+        w, sort, Op(), TermVec{}, name, true, next_term_id));
+  }
+
+  Term make_term(PrimOp po, const Term & t0, const Term & t1)
+  {
+    Term w = make_shared<GenericTerm>(
+        wrapped_sort, Op(po), TermVec{ wrapped(t0), wrapped(t1) }, "");
+    return hash_cons(make_shared<BenchLoggingTerm>(
+        w, sort, Op(po), TermVec{ t0, t1 }, next_term_id));
+  }
+
+ protected:
+  Term hash_cons(Term res)
+  {
+    if (!table.lookup_or_insert(res))
+    {
+      next_term_id++;
+    }
+    return res;
+  }
+
+  Table & table;
+  Sort wrapped_sort;
+  Sort sort;
+  size_t next_term_id;
+};
+
+// unrolls s_j' = (s_j * s_{j+1}) + in for a number of steps,
+// twice: the second time every term is already in the table
+template <class Table>
+double unroll(Table & table, size_t steps, size_t num_vars, size_t & num_terms)
+{
+  TermBuilder<Table> b(table);
+  auto start = chrono::steady_clock::now();
+  for (size_t round = 0; round < 2; ++round)
+  {
+    num_terms = 0;
+    vector<Term> state;
+    for (size_t j = 0; j < num_vars; ++j)
+    {
+      state.push_back(b.make_symbol("s" + to_string(j)));
+    }
+    for (size_t i = 0; i < steps; ++i)
+    {
+      Term in = b.make_symbol("in" + to_string(i));
+      vector<Term> next;
+      for (size_t j = 0; j < num_vars; ++j)
+      {
+        Term prod = b.make_term(BVMul, state[j], state[(j + 1) % num_vars]);
+        next.push_back(b.make_term(BVAdd, prod, in));
+        num_terms += 2;
+      }
+      state = std::move(next);
+    }
+  }
+  auto end = chrono::steady_clock::now();
+  return chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char ** argv)
+{
+  // the depth of the term DAG is the number of steps. Destroying
+  // very deep DAGs recursively may exhaust the stack.
+  size_t steps = argc > 1 ? stoul(argv[1]) : 2000;
+  size_t num_vars = argc > 2 ? stoul(argv[2]) : 64;
+  size_t num_terms = 0;
+
+  NodeTermHashTable node_table;
+  double node_time = unroll(node_table, steps, num_vars, num_terms);
+
+  TermHashTable table;
+  double flat_time = unroll(table, steps, num_vars, num_terms);
+
+  TermHashTable reserved_table;
+  reserved_table.reserve(num_terms + steps + num_vars);
+  double reserved_time = unroll(reserved_table, steps, num_vars, num_terms);
+
+  cout << "terms per round: " << num_terms << endl;
+  cout << "make_term calls: " << 2 * num_terms << endl;
+  cout << "unordered_map of sets: " << node_time << "s, "
+       << 2 * num_terms / node_time / 1e6 << "M terms/s" << endl;
+  cout << "TermHashTable: " << flat_time << "s, "
+       << 2 * num_terms / flat_time / 1e6 << "M terms/s" << endl;
+  cout << "TermHashTable (reserved): " << reserved_time << "s, "
+       << 2 * num_terms / reserved_time / 1e6 << "M terms/s" << endl;
+  return 0;
+}
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -115,6 +116,7 @@ class BzlaSolver : public AbsSmtSolver
   Term make_term(Op op, const TermVec & terms) const override;
   void reset() override;
   void reset_assertions() override;
+  void interrupt() override;
   Term substitute(const Term term,
                   const UnorderedTermMap & substitution_map) const override;
   TermVec substitute_terms(
@@ -129,6 +131,7 @@ class BzlaSolver : public AbsSmtSolver
     if (bzla == nullptr)
     {
       bzla = new bitwuzla::Bitwuzla(*tm, options);
+      bzla->configure_terminator(&terminator);
     }
     return bzla;
   }
@@ -138,6 +141,16 @@ class BzlaSolver : public AbsSmtSolver
   bitwuzla::TermManager * tm;
   mutable bitwuzla::Bitwuzla * bzla;
 
+  // polled by bitwuzla during check_sat, see interrupt
+  class BzlaTerminator : public bitwuzla::Terminator
+  {
+   public:
+    bool terminate() override { return interrupted; }
+    // set by interrupt, cleared at the start of each query
+    std::atomic<bool> interrupted{ false };
+  };
+  mutable BzlaTerminator terminator;
+
   std::unordered_map<std::string, Term> symbol_table;
   std::uint64_t context_level;
 
@@ -154,6 +167,7 @@ class BzlaSolver : public AbsSmtSolver
     }
 
     bitwuzla::Result res;
+    terminator.interrupted = false;
     try
     {
       res = get_bitwuzla()->check_sat(assumptions);
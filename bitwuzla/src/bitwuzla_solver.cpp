@@ -142,6 +142,7 @@ void BzlaSolver::assert_formula(const Term & t)
 Result BzlaSolver::check_sat()
 {
   bitwuzla::Result r;
+  terminator.interrupted = false;
   try
   {
     r = get_bitwuzla()->check_sat();
@@ -668,6 +669,8 @@ void BzlaSolver::reset_assertions()
       "Bitwuzla does not currently support reset_assertions");
 }
 
+void BzlaSolver::interrupt() { terminator.interrupted = true; }
+
 Term BzlaSolver::substitute(const Term term,
                             const UnorderedTermMap & substitution_map) const
 {
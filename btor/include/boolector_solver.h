@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -45,6 +46,8 @@ class BoolectorSolver : public AbsSmtSolver
       throw InternalSolverException(msg);
     };
     boolector_set_abort(throw_exception);
+    // polled by boolector_sat, see interrupt
+    boolector_set_term(btor, terminate, &interrupted);
   };
   BoolectorSolver(const BoolectorSolver &) = delete;
   BoolectorSolver & operator=(const BoolectorSolver &) = delete;
@@ -114,12 +117,16 @@ class BoolectorSolver : public AbsSmtSolver
   void reset_assertions() override;
   Term substitute(const Term term,
                   const UnorderedTermMap & substitution_map) const override;
+  TermVec substitute_terms(
+      const TermVec & terms,
+      const UnorderedTermMap & substitution_map) const override;
   // helper methods for making a term with a primitive op
   Term apply_prim_op(PrimOp op, Term t) const;
   Term apply_prim_op(PrimOp op, Term t0, Term t1) const;
   Term apply_prim_op(PrimOp op, Term t0, Term t1, Term t2) const;
   Term apply_prim_op(PrimOp op, TermVec terms) const;
   void dump_smt2(std::string filename) const override;
+  void interrupt() override;
 
   // getters for solver-specific objects
   // for interacting with third-party Boolector-specific software
@@ -139,6 +146,11 @@ class BoolectorSolver : public AbsSmtSolver
   ///< set this flag with set_opt("base-context-1", "true")
   size_t context_level = 0;  ///< tracks the current solving context level
 
+  // set by interrupt, cleared at the start of each query
+  std::atomic<bool> interrupted{ false };
+  // termination callback for boolector_set_term
+  static int32_t terminate(void * state);
+
   // helper functions
   template <class I>
   inline Result check_sat_assuming(I it, const I & end)
@@ -152,6 +164,7 @@ class BoolectorSolver : public AbsSmtSolver
       ++it;
     }
 
+    interrupted = false;
     int32_t res = boolector_sat(btor);
     if (res == BOOLECTOR_SAT)
     {
@@ -85,6 +85,7 @@ class BoolectorTerm : public AbsTerm
   bool is_value() const override;
   virtual std::string to_string() override;
   uint64_t to_int() const override;
+  BVValue to_bv_value() override;
   /** Iterators for traversing the children
    */
   TermIter begin() override;
@@ -297,6 +297,7 @@ void BoolectorSolver::assert_formula(const Term & t)
 
 Result BoolectorSolver::check_sat()
 {
+  interrupted = false;
   int32_t res = boolector_sat(btor);
   if (res == BOOLECTOR_SAT)
   {
@@ -781,6 +782,14 @@ void BoolectorSolver::reset()
   boolector_release_all(btor);
   boolector_delete(btor);
   btor = boolector_new();
+  boolector_set_term(btor, terminate, &interrupted);
+}
+
+void BoolectorSolver::interrupt() { interrupted = true; }
+
+int32_t BoolectorSolver::terminate(void * state)
+{
+  return static_cast<std::atomic<bool> *>(state)->load();
 }
 
 void BoolectorSolver::reset_assertions()
@@ -806,20 +815,25 @@ void BoolectorSolver::reset_assertions()
 Term BoolectorSolver::substitute(
     const Term term, const UnorderedTermMap & substitution_map) const
 {
-  BoolectorNodeMap * bmap = boolector_nodemap_new(btor);
+  return substitute_terms({ term }, substitution_map)[0];
+}
 
-  std::shared_ptr<BoolectorTerm> bt =
-      std::static_pointer_cast<BoolectorTerm>(term);
+TermVec BoolectorSolver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
+{
+  // one map for the whole batch
+  BoolectorNodeMap * bmap = boolector_nodemap_new(btor);
 
   std::shared_ptr<BoolectorTerm> key;
   std::shared_ptr<BoolectorTerm> value;
-  for (auto elem : substitution_map)
+  for (const auto & elem : substitution_map)
   {
     key = std::static_pointer_cast<BoolectorTerm>(elem.first);
     value = std::static_pointer_cast<BoolectorTerm>(elem.second);
     // boolectornodemap only supports var -> term mappings
     if (!key->is_symbol())
     {
+      boolector_nodemap_delete(bmap);
       throw IncorrectUsageException(
           "boolector backend currently only supports symbol->term "
           "substitution");
@@ -827,14 +841,22 @@ Term BoolectorSolver::substitute(
     boolector_nodemap_map(bmap, key->node, value->node);
   }
 
-  // perform the substitution
-  BoolectorNode * substituted =
-      boolector_nodemap_substitute_node(btor, bmap, bt->node);
-  // need to copy it because deleting the map will decrement the reference
-  // counter
-  substituted = boolector_copy(btor, substituted);
+  TermVec res;
+  res.reserve(terms.size());
+  for (const Term & term : terms)
+  {
+    std::shared_ptr<BoolectorTerm> bt =
+        std::static_pointer_cast<BoolectorTerm>(term);
+    // perform the substitution
+    BoolectorNode * substituted =
+        boolector_nodemap_substitute_node(btor, bmap, bt->node);
+    // need to copy it because deleting the map will decrement the reference
+    // counter
+    substituted = boolector_copy(btor, substituted);
+    res.push_back(std::make_shared<BoolectorTerm>(btor, substituted));
+  }
   boolector_nodemap_delete(bmap);
-  return std::make_shared<BoolectorTerm> (btor, substituted);
+  return res;
 }
 
 void BoolectorSolver::dump_smt2(std::string filename) const
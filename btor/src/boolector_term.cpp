@@ -393,6 +393,20 @@ uint64_t BoolectorTerm::to_int() const
   return std::stoull(s, &sz, 2);
 }
 
+BVValue BoolectorTerm::to_bv_value()
+{
+  if (!boolector_is_const(btor, node))
+  {
+    throw IncorrectUsageException(
+        "Can't get bitstring from a non-constant term.");
+  }
+  // the assignment is already a bit-string
+  const char * assignment = boolector_bv_assignment(btor, node);
+  std::string s(assignment);
+  boolector_free_bv_assignment(btor, assignment);
+  return BVValue(s, boolector_get_width(btor, node), 2);
+}
+
 /** Iterators for traversing the children
  */
 TermIter BoolectorTerm::begin()
@@ -28,6 +28,7 @@ Configures the CMAKE build environment.
 --static                create static libaries (default: off)
 --without-tests         build without the smt-switch test suite (default: off)
 --no-system-gtest       do not use system GTest sources; forces download (default: off)
+--benchmarks            build the benchmark programs (default: off)
 --python                compile with python bindings (default: off)
 --python-executabe      point to a particular Python interpreter - will look around this for include and lib dirs
 --smtlib-reader         include the smt-lib reader - requires bison/flex (default:off)
@@ -62,6 +63,7 @@ z3_home=default
 static=default
 build_tests=default
 system_gtest=default
+benchmarks=default
 python=default
 python_executable=default
 smtlib_reader=default
@@ -177,6 +179,9 @@ do
         --no-system-gtest)
             system_gtest=no
             ;;
+        --benchmarks)
+            benchmarks=yes
+            ;;
         --python)
             python=yes
             ;;
@@ -290,6 +295,9 @@ cmake_opts="$cmake_opts -DCMAKE_BUILD_TYPE=$build_type"
 [ $system_gtest != default ] \
     && cmake_opts="$cmake_opts -DSYSTEM_GTEST=$system_gtest"
 
+[ $benchmarks != default ] \
+    && cmake_opts="$cmake_opts -DBUILD_BENCHMARKS=ON"
+
 [ $python != default ] \
     && cmake_opts="$cmake_opts -DBUILD_PYTHON_BINDINGS=ON"
 
@@ -121,6 +121,9 @@ class Cvc5Solver : public AbsSmtSolver
   void reset_assertions() override;
   Term substitute(const Term term,
                   const UnorderedTermMap & substitution_map) const override;
+  TermVec substitute_terms(
+      const TermVec & terms,
+      const UnorderedTermMap & substitution_map) const override;
   void dump_smt2(std::string filename) const override;
 
   // helpers
@@ -1018,6 +1018,13 @@ void Cvc5Solver::reset_assertions()
 Term Cvc5Solver::substitute(const Term term,
                             const UnorderedTermMap & substitution_map) const
 {
+  return substitute_terms({ term }, substitution_map)[0];
+}
+
+TermVec Cvc5Solver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
+{
+  // convert the map once for the whole batch
   std::vector<::cvc5::Term> keys;
   std::vector<::cvc5::Term> values;
   keys.reserve(substitution_map.size());
@@ -1029,8 +1036,14 @@ Term Cvc5Solver::substitute(const Term term,
     values.push_back(std::static_pointer_cast<Cvc5Term>(elem.second)->term);
   }
 
-  ::cvc5::Term cterm = std::static_pointer_cast<Cvc5Term>(term)->term;
-  return std::make_shared<Cvc5Term>(cterm.substitute(keys, values));
+  TermVec res;
+  res.reserve(terms.size());
+  for (const Term & term : terms)
+  {
+    ::cvc5::Term cterm = std::static_pointer_cast<Cvc5Term>(term)->term;
+    res.push_back(std::make_shared<Cvc5Term>(cterm.substitute(keys, values)));
+  }
+  return res;
 }
 
 void Cvc5Solver::dump_smt2(std::string filename) const
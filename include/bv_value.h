@@ -0,0 +1,110 @@
+/*********************                                                        */
+/*! \file bv_value.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-neutral representation of bit-vector values.
+**
+** Used to move bit-vector constants between solvers without formatting
+** them as decimal SMT-LIB strings. Conversions to and from the binary
+** and hexadecimal forms are linear in the width.
+**
+**/
+
+// IWYU pragma: private, include "smt.h"
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace smt {
+
+class BVValue
+{
+ public:
+  /** Creates a zero bit-vector value
+   *  @param width the bit-width of the value
+   */
+  explicit BVValue(uint64_t width = 0);
+
+  /** Creates a bit-vector value from an unsigned integer
+   *  bits above the width are dropped
+   *  @param width the bit-width of the value
+   *  @param val the value
+   */
+  BVValue(uint64_t width, uint64_t val);
+
+
+  /** Creates a bit-vector value from a string of digits (no prefix)
+   *  throws an IncorrectUsageException if the digits are malformed or
+   *  the value does not fit in the width
+   *  @param digits the digits, most significant first
+   *  @param width the bit-width of the value
+   *  @param base 2, 10 or 16. Base 10 is quadratic in the width.
+   */
+  BVValue(const std::string & digits, uint64_t width, uint64_t base);
+
+  /** Parses a bit-vector value as printed by a solver
+   *  e.g. #b0101, #x5, 0b0101 or (_ bv5 4)
+   *  throws an IncorrectUsageException if it cannot be parsed
+   *  @param repr the printed value
+   *  @param width the bit-width of the value
+   */
+  static BVValue from_smt2(const std::string & repr, uint64_t width);
+
+  /** Creates a bit-vector value from its 64-bit words
+   *  bits above the width are dropped
+   *  @param width the bit-width of the value
+   *  @param words (width + 63) / 64 words, least significant first
+   */
+  static BVValue from_words(uint64_t width, const uint64_t * words);
+
+  uint64_t get_width() const { return width; };
+
+  bool get_bit(uint64_t i) const;
+
+  void set_bit(uint64_t i, bool b);
+
+  /** @return the 64-bit words of the value, least significant first
+   *  bits above the width are always zero
+   */
+  const std::vector<uint64_t> & get_words() const { return words; };
+
+  /** @return true iff the value is representable by a uint64_t */
+  bool fits_uint64() const;
+
+  /** @return the value as a uint64_t
+   *  throws an IncorrectUsageException if !fits_uint64()
+   */
+  uint64_t to_uint64() const;
+
+  /** @return the value as a string of width binary digits
+   *  (most significant first, no prefix)
+   */
+  std::string to_binary_string() const;
+
+  /** @return the value as a decimal string
+   *  quadratic in the width, only for solvers that require base 10
+   */
+  std::string to_decimal_string() const;
+
+  bool operator==(const BVValue & other) const;
+  bool operator!=(const BVValue & other) const { return !(*this == other); };
+
+ protected:
+  uint64_t width;
+  std::vector<uint64_t> words;
+};
+
+std::ostream & operator<<(std::ostream & output, const BVValue & v);
+
+}  // namespace smt
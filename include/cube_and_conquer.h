@@ -0,0 +1,143 @@
+/*********************                                                        */
+/*! \file cube_and_conquer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Splits a problem into cubes and solves them in parallel.
+**
+** k splitting literals (Boolean symbols, or bits of bit-vector symbols)
+** give 2^k cubes, the conjunctions of the literals or their negations.
+** Each worker solver runs in its own thread, with the assertions
+** transferred to it by a TermTranslator, and solves one cube after
+** another with check_sat_assuming. The problem is sat as soon as one
+** cube is, and unsat once every cube is refuted.
+**
+** Example:
+**   CubeAndConquer cc(source, { BoolectorSolverFactory::create(false),
+**                               BoolectorSolverFactory::create(false) });
+**   cc.assert_formula(source->make_term(Equal, product, n));
+**   Result r = cc.check_sat(4);
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "smt.h"
+#include "term_translator.h"
+
+namespace smt {
+
+class CubeAndConquer
+{
+ public:
+  /** @param source the solver that builds the terms, it never solves
+   *  @param workers fresh solvers, one per thread, of backends that
+   *         support term transfer (not generic solvers). They are set
+   *         to incremental. Other options, e.g. produce-models for
+   *         get_value, should be set before.
+   */
+  CubeAndConquer(const SmtSolver & source, std::vector<SmtSolver> workers);
+
+  CubeAndConquer(const CubeAndConquer &) = delete;
+  CubeAndConquer & operator=(const CubeAndConquer &) = delete;
+
+  /** @param t a formula of the source solver */
+  void assert_formula(const Term & t);
+
+  /** Chooses splitting literals from the assertions: the Boolean symbols
+   *  in the most subterms first, then the bits of the bit-vector symbols
+   *  in the most subterms, from the most significant one, taking one bit
+   *  of each symbol in turn.
+   *  Requires term iteration on the source solver.
+   *  @param k the number of literals
+   *  @return at most k literals, fewer if the assertions do not have
+   *          enough bits
+   */
+  TermVec choose_split_literals(size_t k) const;
+
+  /** Splits on the given literals and solves the cubes.
+   *  The other workers are interrupted (see AbsSmtSolver::interrupt)
+   *  after a sat cube. Workers that do not support interrupting finish
+   *  their current cube first. All the threads are joined on return.
+   *  @param literals Boolean formulas of the source solver
+   *  @return sat if a cube is sat, unsat if all of them are unsat,
+   *          unknown otherwise. If no cube was sat and a worker threw an
+   *          exception, rethrows the first one.
+   */
+  Result check_sat_cubes(const TermVec & literals);
+
+  /** check_sat_cubes on choose_split_literals(k) */
+  Result check_sat(size_t k);
+
+  /** @return the literals of the sat cube of the last check, as terms of
+   *  the source solver (each literal or its negation)
+   *  throws an IncorrectUsageException if the last check was not sat
+   */
+  TermVec get_sat_cube() const;
+
+  /** @param t a term of the source solver
+   *  @return its value in the model of the sat cube, as a term of the
+   *  source solver
+   *  throws an IncorrectUsageException if the last check was not sat
+   */
+  Term get_value(const Term & t);
+
+  /** @return the number of cubes refuted in the last check */
+  size_t get_num_refuted() const { return num_refuted; };
+
+  const std::vector<SmtSolver> & get_workers() const { return workers; };
+
+ protected:
+  SmtSolver source;
+  std::vector<SmtSolver> workers;
+  // one per worker, they are only used by the main thread
+  std::vector<TermTranslator> translators;
+
+  TermVec assertions;
+  // number of assertions transferred to each worker
+  std::vector<size_t> num_transferred;
+  // a fresh symbol per splitting literal in each worker,
+  // constrained to be equal to the literal
+  std::vector<UnorderedTermMap> split_symbols;
+
+  // the cubes of the last check
+  TermVec literals;
+  std::vector<TermVec> worker_literals;
+  std::atomic<uint64_t> next_cube;
+  uint64_t num_cubes;
+
+  // The fields below are protected by m.
+  // Index of the worker that found a sat cube, workers.size() until then.
+  size_t winner;
+  uint64_t sat_cube;
+  size_t num_refuted;
+  size_t num_running;
+  std::vector<std::exception_ptr> errors;
+
+  std::mutex m;
+  std::condition_variable cv;
+
+  /** Transfers the new assertions and the splitting literals to a worker */
+  void setup_worker(size_t i);
+
+  /** Solves cubes with worker i until none are left or one is sat */
+  void run_worker(size_t i);
+
+  /** @return the assumptions of a cube for worker i */
+  TermVec cube_assumptions(size_t i, uint64_t cube) const;
+};
+
+}  // namespace smt
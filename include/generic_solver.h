@@ -18,14 +18,25 @@
 **    is limited to values between 2 and 256.
 ** 3. Generic solvers cannot be used in term transfer/translation.
 ** 4. This feature is currently linux only -- no support for macOS.
+** 5. In pipelined mode, a failing command that only answers `success`
+**    (e.g., set-option, declare-fun, assert) is reported when the queue
+**    is flushed, i.e., at the next command that produces a result.
+** 6. To be able to restart the binary (see check_sat_async), a solver
+**    created with restartable = true keeps the commands that make up its
+**    current state. Their size is about the size of everything that was
+**    sent to the binary, minus popped scopes.
 **
 **/
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "generic_sort.h"
 #include "generic_term.h"
@@ -33,15 +44,122 @@
 
 namespace smt {
 
+/** Key of the hash-cons table of GenericSolver.
+ *  Identifies a term by its operator and the unique ids of its
+ *  (hash-consed) children. The sort is determined by those.
+ */
+struct GenericTermKey
+{
+  Op op;
+  std::vector<std::size_t> child_ids;
+
+  bool operator==(const GenericTermKey & other) const
+  {
+    return op == other.op && child_ids == other.child_ids;
+  }
+};
+
+struct GenericTermKeyHash
+{
+  std::size_t operator()(const GenericTermKey & key) const;
+};
+
+class GenericSolver;
+
+/** Handle to a check-sat query that runs in the binary of a GenericSolver
+ *  while the caller continues. See GenericSolver::check_sat_async.
+ *  The solver must outlive the handle. While the query runs, no other
+ *  command can be sent to the solver.
+ */
+class GenericAsyncResult
+{
+ public:
+  GenericAsyncResult() : solver(nullptr), query_id(0) {}
+
+  /** Does not block.
+   *  @return true iff the result is available (see get) or the deadline
+   *  has passed, in which case the query was given up.
+   */
+  bool is_ready();
+
+  /** Blocks until the binary answers or the deadline passes.
+   *  @return the result of the query. When the deadline passes, the
+   *  binary is restarted with the current assertion stack and the
+   *  result is unknown.
+   */
+  Result get();
+
+  /** Gives up on the query: the binary is restarted with the current
+   *  assertion stack and the result becomes unknown.
+   *  Has no effect if the result is already available.
+   */
+  void cancel();
+
+ protected:
+  GenericAsyncResult(GenericSolver * solver, uint64_t query_id)
+      : solver(solver), query_id(query_id)
+  {
+  }
+
+  GenericSolver * solver;
+  uint64_t query_id;
+  // null while the query is running
+  Result result;
+
+  friend class GenericSolver;
+};
+
 class GenericSolver : public AbsSmtSolver
 {
  public:
+  /** @param path the path to the solver binary
+   *  @param cmd_line_args the command line arguments for the binary
+   *  @param write_buf_size the size of the buffer for writing to the binary
+   *  @param read_buf_size the size of the buffer for reading from it
+   *  @param pipelined if true, commands that only answer `success` are
+   *         queued and sent in batches (see flush_pending_commands)
+   *  @param restartable if true, the solver keeps the commands that make
+   *         up the state of the binary, to restore it after a restart.
+   *         Needed for check_sat_async and check_sat_assuming_async.
+   */
   GenericSolver(std::string path,
                 std::vector<std::string> cmd_line_args,
                 unsigned int write_buf_size = 256,
-                unsigned int read_buf_size = 256);
+                unsigned int read_buf_size = 256,
+                bool pipelined = false,
+                bool restartable = false);
   ~GenericSolver();
 
+  /** Sends all queued commands to the binary and verifies
+   *  their `success` responses.
+   *  Only relevant in pipelined mode; a no-op otherwise.
+   *  Commands that produce a result (check-sat, get-value, ...)
+   *  flush the queue automatically.
+   *  throws IncorrectUsageException if one of the queued commands
+   *  did not succeed.
+   */
+  void flush_pending_commands() const;
+
+  /** Sends a check-sat command without waiting for the result.
+   *  The response is read with poll when the handle is queried, so
+   *  the caller is never blocked for longer than the timeout.
+   *  Only available if the solver was created with restartable = true.
+   *  @param timeout the wall-clock time the query may take, starting now.
+   *         Zero means no deadline.
+   *  @return a handle to the result of the query
+   */
+  GenericAsyncResult check_sat_async(
+      std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  /** Like check_sat_async, for check-sat-assuming.
+   *  @param assumptions boolean literals, as in check_sat_assuming
+   *  @param timeout see check_sat_async
+   *  @return a handle to the result of the query
+   */
+  GenericAsyncResult check_sat_assuming_async(
+      const TermVec & assumptions,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
   /***************************************************************/
   /* methods from AbsSmtSolver that are currently not implemented*/
   /***************************************************************/
@@ -134,6 +252,21 @@ class GenericSolver : public AbsSmtSolver
   // returns a string representation of a term in smtlib
   std::string to_smtlib_def(Term term) const;
 
+  /** returns a string representation of a non-ground term in smtlib,
+   *  where subterms that occur more than once are bound with `let`.
+   *  The size of the result is linear in the size of the DAG.
+   */
+  std::string to_smtlib_let_def(const Term & term) const;
+
+  /** writes the application of the top-most operator of term to out.
+   *  write_child is used to write each of the children.
+   */
+  void write_app(
+      const Term & term,
+      std::string & out,
+      const std::function<void(const Term &, std::string &)> & write_child)
+      const;
+
   // when an SMT-LIB compliant solver is supposed
   // to return a result (e.g., get-value),
   // a result that starts with "(error " indicates
@@ -143,8 +276,10 @@ class GenericSolver : public AbsSmtSolver
   // expect a result.
   void check_no_error(std::string str) const;
 
-  // parse solver's response from get-sat-assumptions
-  UnorderedTermSet get_assumptions_from_string(std::string result) const;
+  // parse solver's response from get-unsat-assumptions,
+  // given as the tokens of the response
+  UnorderedTermSet get_assumptions_from_string(
+      const std::vector<std::string_view> & tokens) const;
 
   // create an smt-lib constant array value.
   // used for make_term
@@ -160,8 +295,10 @@ class GenericSolver : public AbsSmtSolver
   // parse result (sat, unsat, unknown) from solver's output
   Result str_to_result(std::string result) const;
 
-  // parse actual value from a get-value response
-  std::string strip_value_from_result(std::string result) const;
+  // parse actual value from a get-value response,
+  // given as the tokens of the response
+  std::string strip_value_from_result(
+      const std::vector<std::string_view> & tokens) const;
 
   /** helper function for bv constant
    * abs_decimal is the string represnentation of the absolute value of the
@@ -193,8 +330,13 @@ class GenericSolver : public AbsSmtSolver
 
   // open a connection to the binary via a pipe
   void start_solver();
+  // start the process of the binary, without sending anything
+  void launch_process();
   // close the connection to the binary
   void close_solver();
+  // start the binary over and resend the commands in replay_cmds,
+  // which restores the current assertion stack
+  void restart_solver();
 
   // internally defining and storing a function symbol
   void define_fun(std::string str,
@@ -208,20 +350,59 @@ class GenericSolver : public AbsSmtSolver
   // internal function to read solver's response
   std::string read_internal() const;
 
+  /** read once from the binary to the end of out_buf.
+   *  @return false iff the binary closed its output
+   */
+  bool read_chunk() const;
+
+  // remove the response that scan_response found from out_buf
+  // and return it
+  std::string take_response() const;
+
+  // send a command that produces a result without reading the result,
+  // and start an async query
+  GenericAsyncResult start_async(std::string cmd,
+                                 std::chrono::milliseconds timeout);
+
+  /** read the response of a running async query.
+   *  @param query_id the id of the query
+   *  @param block whether to wait for the response (or the deadline)
+   *  @return the result, or a null result if it is not available yet
+   */
+  Result async_result(uint64_t query_id, bool block);
+
+  /** give up on a running async query and restart the binary
+   *  @param query_id the id of the query
+   *  @param reason the explanation of the unknown result
+   *  @return an unknown result
+   */
+  Result cancel_async(uint64_t query_id, std::string reason);
+
+  // the check-sat-assuming command for the assumptions
+  std::string check_sat_assuming_cmd(const TermVec & assumptions) const;
+
   // internal function to write to the solver's process
   void write_internal(std::string str) const;
 
+  /** scan the output that was read so far, continuing where
+   *  the previous call stopped.
+   *  @return true iff a complete response was read. It then starts at
+   *  out_begin and ends right before scan_pos.
+   */
+  bool scan_response() const;
+
   // run a command with the binary
   std::string run_command(std::string cmd,
                           bool verify_success_flag = true) const;
 
+  // run a command that is not tied to a term, and record it in
+  // global_cmds once the binary answered success. In pipelined mode
+  // it is recorded when the queue is flushed, like other failures.
+  void run_global_command(const std::string & cmd) const;
+
   // verify that we got `success`
   void verify_success(std::string result) const;
 
-  // cmoputes  whether the current output from the solver
-  // is done being read
-  bool is_done(int just_read, std::string result) const;
-
   /***********
    * members *
    ***********/
@@ -237,13 +418,58 @@ class GenericSolver : public AbsSmtSolver
   int outpipefd[2];
   pid_t pid;
   int status;
-  char * write_buf;
-  char * read_buf;
 
   // buffer sizes
   unsigned int write_buf_size;
   unsigned int read_buf_size;
 
+  // if true, commands that only answer `success` are queued
+  // and streamed to the binary in batches
+  bool pipelined;
+
+  // if true, replay_cmds and replay_scopes are maintained
+  bool restartable;
+
+  // NOTE the pipe state is updated by const methods
+  // (e.g., make_term defines terms in the binary),
+  // so it is marked mutable
+
+  // queued commands that were not yet sent to the binary
+  mutable std::string pending_cmds;
+  // start offset of each queued command in pending_cmds
+  mutable std::vector<size_t> pending_offsets;
+  // for each queued command, true iff it goes to global_cmds
+  // once it succeeds
+  mutable std::vector<bool> pending_global;
+  // output of the binary. Responses are read directly into
+  // this buffer, which is reused and grows as needed.
+  mutable std::string out_buf;
+  // start of the first response in out_buf that was not consumed yet
+  mutable size_t out_begin;
+  // state of the response scanner, which is kept across reads
+  // so that every byte is scanned once
+  mutable size_t scan_pos;
+  mutable int scan_depth;
+  // 0, or the delimiter of the quoted symbol / string literal
+  // the scanner is in
+  mutable char scan_quote;
+  mutable bool scan_started;
+  mutable bool scan_done;
+
+  // commands that succeeded and make up the current state of the binary,
+  // in the order they were sent. Popped scopes are removed.
+  mutable std::vector<std::string> replay_cmds;
+  // for each context level, the index in replay_cmds of the
+  // push command that opened it
+  std::vector<size_t> replay_scopes;
+
+  // id of the running async query, or 0 if there is none
+  uint64_t async_query;
+  // id of the last async query
+  uint64_t async_counter;
+  bool async_has_deadline;
+  std::chrono::steady_clock::time_point async_deadline;
+
   // tracks the context level of the solver
   // (e.g., number of pushes - number of pops)
   uint64_t context_level_;
@@ -259,6 +485,17 @@ class GenericSolver : public AbsSmtSolver
   std::unique_ptr<std::unordered_map<std::string, Term>> name_term_map;
   std::unique_ptr<std::unordered_map<Term, std::string>> term_name_map;
 
+  // hash-cons table for terms with an operator.
+  // Building a term that already exists returns the stored term
+  // without printing or sending anything to the binary.
+  std::unique_ptr<std::unordered_map<GenericTermKey, Term, GenericTermKeyHash>>
+      op_term_table;
+
+  // commands that are not tied to a term, in the order they were sent:
+  // options, the logic, and sort / datatype declarations.
+  // Used by GenericSolverPool to bring its workers up to date.
+  mutable std::vector<std::string> global_cmds;
+
   // Map between names and Generic datatypes and vice versa
   std::unique_ptr<
       std::unordered_map<std::string, std::shared_ptr<GenericDatatype>>>
@@ -266,6 +503,10 @@ class GenericSolver : public AbsSmtSolver
   std::unique_ptr<
       std::unordered_map<std::shared_ptr<GenericDatatype>, std::string>>
       datatype_name_map;
+
+  // So GenericSolverPool can replay definitions on its workers
+  friend class GenericSolverPool;
+  friend class GenericAsyncResult;
 };
 
 }  // namespace smt
@@ -0,0 +1,157 @@
+/*********************                                                        */
+/*! \file generic_solver_pool.h
+** \verbatim
+** Top contributors (to current version):
+**   Yoni Zohar
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A pool of generic solver processes that answers independent
+**        queries in parallel.
+**
+** Terms are built with a single GenericSolver (see get_solver).
+** Each query is sent to an idle worker process running the same binary.
+** Before that, the worker receives the global commands (options, logic,
+** sort declarations) and the declarations / definitions of the terms
+** the query depends on, unless it already has them.
+**
+** Limitations:
+** 1. Terms should not be built while queries are running.
+** 2. The assertion stack of the solver returned by get_solver is not
+**    used by the workers. Use GenericSolverPool::assert_formula instead.
+** 3. Like GenericSolver, this is linux only -- no support for macOS.
+**
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "generic_solver.h"
+
+namespace smt {
+
+class GenericSolverPool
+{
+ public:
+  /** Launches num_workers processes of the binary, in addition to the
+   *  one that is used for building terms.
+   *  @param path the path to the solver binary
+   *  @param cmd_line_args the command line arguments for the binary
+   *  @param num_workers the number of worker processes
+   *  @param write_buf_size see GenericSolver
+   *  @param read_buf_size see GenericSolver
+   */
+  GenericSolverPool(std::string path,
+                    std::vector<std::string> cmd_line_args,
+                    size_t num_workers,
+                    unsigned int write_buf_size = 256,
+                    unsigned int read_buf_size = 256);
+  ~GenericSolverPool();
+
+  /** @return the solver that is used to build the terms of the queries.
+   *  It runs in pipelined mode (see GenericSolver).
+   */
+  SmtSolver get_solver() const;
+
+  /** @return the number of worker processes
+   */
+  size_t get_num_workers() const;
+
+  /** Adds an assertion that holds for all subsequent queries.
+   *  @param t a boolean term built with get_solver()
+   */
+  void assert_formula(const Term & t);
+
+  /** Checks satisfiability of the pool's assertions under the given
+   *  assumptions on an idle worker. Blocks until a worker is available.
+   *  Can be called from several threads at once.
+   *  @param assumptions boolean literals built with get_solver()
+   *  @return the result of the query
+   */
+  Result check_sat_assuming(const TermVec & assumptions);
+
+  /** Runs the queries in parallel on all workers.
+   *  @param queries a vector of assumption vectors
+   *  @return the results, in the same order as the queries
+   */
+  std::vector<Result> check_sat_assuming_all(
+      const std::vector<TermVec> & queries);
+
+ protected:
+  struct Worker
+  {
+    // null if the process could not be restarted
+    std::unique_ptr<GenericSolver> solver;
+    // names of the terms that were declared or defined in the worker
+    std::unordered_set<std::string> defined;
+    // number of global commands and assertions the worker received
+    size_t num_global_cmds;
+    size_t num_assertions;
+  };
+
+  // start (or restart) the process of a worker.
+  // If this throws, the worker is left without a process.
+  void start_worker(Worker & w);
+
+  // wait for an idle worker and take it
+  size_t acquire_worker();
+
+  // return a worker to the idle ones
+  void release_worker(size_t idx);
+
+  // an acquired worker, which is released when this goes out of scope
+  struct WorkerLease
+  {
+    WorkerLease(GenericSolverPool & pool)
+        : pool(pool), idx(pool.acquire_worker())
+    {
+    }
+    ~WorkerLease() { pool.release_worker(idx); }
+    WorkerLease(const WorkerLease &) = delete;
+    WorkerLease & operator=(const WorkerLease &) = delete;
+
+    GenericSolverPool & pool;
+    size_t idx;
+  };
+
+  /** Sends everything the terms depend on that the worker does not have,
+   *  and the assertions it has not received yet.
+   *  Must be called while holding solver_mutex.
+   */
+  void sync_worker(Worker & w, const TermVec & terms);
+
+  // the path and command line arguments of the binary
+  std::string path;
+  std::vector<std::string> cmd_line_args;
+  unsigned int write_buf_size;
+  unsigned int read_buf_size;
+
+  // the solver used to build terms
+  std::shared_ptr<GenericSolver> solver;
+
+  // assertions that hold in all queries
+  TermVec assertions;
+
+  std::vector<Worker> workers;
+
+  // indices of the workers that are not running a query
+  std::vector<size_t> idle_workers;
+
+  // protects idle_workers
+  std::mutex idle_mutex;
+  std::condition_variable idle_cv;
+
+  // protects the maps of solver and assertions while syncing workers
+  std::mutex solver_mutex;
+};
+
+}  // namespace smt
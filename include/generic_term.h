@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <vector>
 
 #include "ops.h"
 #include "smt_defs.h"
@@ -39,14 +41,19 @@ class GenericTerm : public AbsTerm
   virtual ~GenericTerm();
 
   /** Returns true iff the term AND sort are equivalent
+   *  Terms with an operator are compared structurally
+   *  (operator and children), other terms by their representation.
    *  @param t the term to compare with (assumed to be GenericTerm)
    *  @return true iff the term and sort match t
    */
   bool compare(const Term & t) const override;
   Op get_op() const override;
   Sort get_sort() const override;
+  // unique for every GenericTerm object
   std::size_t get_id() const override;
+  // returns the string representation, which is computed once on demand
   std::string to_string() override;
+  // structural hash, computed once in the constructor
   std::size_t hash() const override;
   bool is_value() const override;
   uint64_t to_int() const override;
@@ -63,15 +70,34 @@ class GenericTerm : public AbsTerm
  protected:
   std::string compute_string() const;
 
-  /** check whether this is a ground term
-   * (does not have free variables)
+  /** compares everything but the children: the hash, operator, arity
+   *  and sort, and the representation of terms without an operator
+   *  @param gt the term to compare with
+   *  @return false if gt is certainly different from this term
+   */
+  bool shallow_compare(const GenericTerm * gt) const;
+
+  /** compute the free parameters of the term, and
+   * check whether this is a ground term (does not have any).
+   * Parameters bound by a quantifier are not free in it.
    * Should only be called from the constructor.
    */
   bool compute_ground();
 
+  /** compute the structural hash of this term:
+   * a hash of the representation for terms without an operator,
+   * and a combination of the operator and the children's hashes otherwise.
+   * Should only be called from the constructor.
+   */
+  std::size_t compute_hash() const;
+
   // true iff this is a ground term
   bool ground;
 
+  // the free parameters, sorted and without duplicates.
+  // Empty for ground terms.
+  std::vector<const GenericTerm *> free_params;
+
   /**
    * A hash function for strings,
    * to be used to compute the hash of the term.
@@ -99,8 +125,18 @@ class GenericTerm : public AbsTerm
   // is this a variable
   bool is_par;
 
+  // the cached structural hash
+  std::size_t hash_;
+
+  // the unique id of this term
+  std::size_t id_;
+
+  // used to give GenericTerms a unique id
+  static std::atomic<std::size_t> next_id;
+
   // So GenericSolver can access protected members:
   friend class GenericSolver;
+  friend class GenericSolverPool;
 };
 
 class GenericTermIter : public TermIterBase
@@ -17,9 +17,11 @@
 #pragma once
 
 #include <utility>
+#include <vector>
 
 #include "exceptions.h"
 #include "smt.h"
+#include "term_id_map.h"
 
 
 namespace smt
@@ -103,9 +105,29 @@ protected:
 
 private:
  // derived classes should interact with cache through the methods above only
- smt::UnorderedTermMap cache_;       /**< cache for updating terms */
+ smt::TermIdMap cache_;              /**< cache for updating terms */
  smt::UnorderedTermMap * ext_cache_; /**< external (user-provided) cache. If
                                         non-null, used instead of cache_ */
+
+ // an entry of the traversal stack
+ struct VisitFrame
+ {
+   smt::Term term;
+   size_t first_child;  ///< where its children start in the children buffer
+   bool expanded;       ///< true iff its children were pushed after it
+ };
+
+ // traversal buffers, kept between calls to visit to reuse their memory
+ std::vector<VisitFrame> visit_stack_;
+ smt::TermVec children_buf_;
+ smt::TermIdMap visited_;
+ smt::TermVec cached_children_;
+
+ // the children of the term visited in post-order, if they were collected
+ // when it was expanded. Lets visit_term avoid iterating over it again
+ const smt::AbsTerm * cur_term_ = nullptr;
+ const smt::Term * cur_children_ = nullptr;
+ size_t cur_num_children_ = 0;
 };
 
 }
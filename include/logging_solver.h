@@ -17,18 +17,46 @@
 #pragma once
 
 #include "solver.h"
+#include "logging_term.h"
 #include "term_hashtable.h"
 
 #include <string>
 
 namespace smt {
 
+/** Counters of the hash-cons table of a LoggingSolver */
+struct LoggingSolverStats
+{
+  std::size_t num_terms;      ///< terms currently in the table
+  std::size_t num_created;    ///< terms created so far
+  std::size_t num_collected;  ///< terms freed by garbage collection so far
+  std::size_t table_bytes;    ///< memory used by the table itself
+  std::size_t pool_bytes;     ///< memory allocated for the terms
+};
+
 class LoggingSolver : public AbsSmtSolver
 {
  public:
   LoggingSolver(SmtSolver s);
   ~LoggingSolver();
 
+  /** Frees the terms that are no longer referenced outside of the
+   *  hash-cons table, together with their wrapped terms.
+   *  Without this, every term stays alive as long as the solver.
+   *  @return the number of freed terms
+   */
+  std::size_t collect_garbage() const;
+
+  /** Collect garbage automatically whenever the hash-cons table
+   *  grew by the given number of terms since the last collection.
+   *  @param num_terms the number of new terms, 0 disables (the default)
+   */
+  void set_gc_interval(std::size_t num_terms);
+
+  /** @return the counters of the hash-cons table
+   */
+  LoggingSolverStats get_stats() const;
+
   // implemented
   Sort make_sort(const std::string name, uint64_t arity) const override;
   Sort make_sort(const SortKind sk) const override;
@@ -62,6 +90,7 @@ class LoggingSolver : public AbsSmtSolver
   Term make_term(const std::string val,
                  const Sort & sort,
                  uint64_t base = 10) const override;
+  Term make_term(const BVValue & val, const Sort & sort) const override;
   Term make_term(const Term & val, const Sort & sort) const override;
   Term make_symbol(const std::string name, const Sort & sort) override;
   Term get_symbol(const std::string & name) override;
@@ -93,6 +122,7 @@ class LoggingSolver : public AbsSmtSolver
   void pop(uint64_t num = 1) override;
   uint64_t get_context_level() const override;
   void reset_assertions() override;
+  void interrupt() override;
 
  protected:
   SmtSolver wrapped_solver;  ///< the underlying solver
@@ -111,6 +141,28 @@ class LoggingSolver : public AbsSmtSolver
   // this was better than making them non-const because most solvers
   // can respect the const-ness of those make_term functions
   mutable size_t next_term_id;  ///< used to give LoggingTerms a unique id
+
+  // called whenever a term was added to the hash-cons table
+  void term_added() const;
+
+  // creates a LoggingTerm in term_pool
+  template <class... Args>
+  Term make_logging_term(Args &&... args) const
+  {
+    return std::allocate_shared<LoggingTerm>(
+        LoggingTermAllocator<LoggingTerm>(term_pool),
+        std::forward<Args>(args)...);
+  }
+
+  // the memory of the LoggingTerms. Released (not deleted)
+  // on destruction, since terms may outlive the solver.
+  LoggingTermPool * term_pool;
+
+  // 0, or the table growth that triggers a garbage collection
+  std::size_t gc_interval;
+  // the size of the table after the last garbage collection
+  mutable std::size_t gc_last_size;
+  mutable std::size_t num_collected;
 };
 
 }  // namespace smt
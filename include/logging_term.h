@@ -16,12 +16,137 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "ops.h"
 #include "smt_defs.h"
 #include "term.h"
 
 namespace smt {
 
+/** \class LoggingTermPool
+ *  A pool for the allocations of the LoggingTerms of a LoggingSolver.
+ *  Terms are created with std::allocate_shared, so every allocation holds
+ *  a LoggingTerm with its control block and they all have the same size.
+ *  The pool hands out slots from large chunks without per-allocation
+ *  overhead, and reuses freed slots.
+ *
+ *  Terms can outlive their solver. The solver calls release instead of
+ *  deleting the pool, and the pool deletes itself once the last term
+ *  allocated from it is freed.
+ */
+class LoggingTermPool
+{
+ public:
+  LoggingTermPool();
+
+  /** the owner no longer uses the pool. It is deleted when
+   *  nothing that was allocated from it is alive.
+   */
+  void release();
+
+  void * allocate(std::size_t bytes, std::size_t align);
+  void deallocate(void * p, std::size_t bytes);
+
+  /** @return the number of bytes held by the pool
+   */
+  std::size_t memory_usage() const;
+
+ protected:
+  ~LoggingTermPool();
+
+  mutable std::mutex pool_mutex;
+  std::vector<char *> chunks;
+  // the size of all slots, fixed by the first allocation
+  std::size_t slot_size;
+  // slots of the last chunk that were never handed out
+  char * chunk_pos;
+  char * chunk_end;
+  // linked list of freed slots
+  void * free_list;
+  // number of allocations that were not freed yet
+  std::size_t num_live;
+  std::size_t num_bytes;
+  bool released;
+};
+
+/** An allocator that allocates from a LoggingTermPool,
+ *  to be used with std::allocate_shared
+ */
+template <class T>
+class LoggingTermAllocator
+{
+ public:
+  typedef T value_type;
+
+  LoggingTermAllocator(LoggingTermPool * pool) : pool(pool) {}
+
+  template <class U>
+  LoggingTermAllocator(const LoggingTermAllocator<U> & other)
+      : pool(other.pool)
+  {
+  }
+
+  T * allocate(std::size_t n)
+  {
+    return static_cast<T *>(pool->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T * p, std::size_t n) { pool->deallocate(p, n * sizeof(T)); }
+
+  template <class U>
+  bool operator==(const LoggingTermAllocator<U> & other) const
+  {
+    return pool == other.pool;
+  }
+
+  template <class U>
+  bool operator!=(const LoggingTermAllocator<U> & other) const
+  {
+    return pool != other.pool;
+  }
+
+  LoggingTermPool * pool;
+};
+
+/** \class LoggingChildren
+ *  The children of a LoggingTerm. Up to three children, which covers
+ *  almost all operators, are stored inline. Otherwise, they are stored
+ *  in a separate array.
+ */
+class LoggingChildren
+{
+ public:
+  LoggingChildren(const TermVec & c);
+  ~LoggingChildren();
+  LoggingChildren(const LoggingChildren &) = delete;
+  LoggingChildren & operator=(const LoggingChildren &) = delete;
+
+  std::size_t size() const { return size_; }
+  const Term & operator[](std::size_t i) const { return data()[i]; }
+  const Term * begin() const { return data(); }
+  const Term * end() const { return data() + size_; }
+
+ protected:
+  static const std::size_t INLINE_SIZE = 3;
+
+  const Term * data() const
+  {
+    return size_ <= INLINE_SIZE ? inline_children : heap_children;
+  }
+
+  union
+  {
+    Term inline_children[INLINE_SIZE];
+    Term * heap_children;
+  };
+  uint32_t size_;
+};
+
 class LoggingTerm : public AbsTerm
 {
  public:
@@ -56,14 +181,18 @@ class LoggingTerm : public AbsTerm
   std::size_t hash() const override;
   bool is_value() const override;
   uint64_t to_int() const override;
+  BVValue to_bv_value() override;
   std::string print_value_as(SortKind sk) override;
 
  protected:
+  // appends the smt2 representation to out
+  void write_string(std::string & out);
+
   Term wrapped_term;  ///< the term of the underlying solver
   Sort sort;          ///< a LoggingSort
   Op op;
-  TermVec children;
-  std::string repr;
+  LoggingChildren children;
+  std::unique_ptr<std::string> repr;  ///< only set for symbols
   bool is_sym;
   bool is_par;
   size_t id_;  ///< unique id for this term
@@ -75,7 +204,7 @@ class LoggingTerm : public AbsTerm
 class LoggingTermIter : public TermIterBase
 {
  public:
-  LoggingTermIter(TermVec::iterator i);
+  LoggingTermIter(const Term * i);
   LoggingTermIter(const LoggingTermIter & lit);
   ~LoggingTermIter();
   LoggingTermIter & operator=(const LoggingTermIter & lit);
@@ -87,7 +216,7 @@ class LoggingTermIter : public TermIterBase
 
  protected:
   bool equal(const TermIterBase & other) const override;
-  TermVec::iterator it;
+  const Term * it;
 };
 
 }  // namespace smt
@@ -0,0 +1,89 @@
+/*********************                                                        */
+/*! \file multi_term_translator.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Class for translating terms from one solver to several solvers
+**        at once.
+**
+** The source DAG is walked once and recorded in a solver-neutral TermDag.
+** Each target solver then rebuilds the recorded nodes on its own,
+** without touching the source solver, so the targets can be filled in
+** parallel.
+**
+**/
+
+#pragma once
+
+#include <vector>
+
+#include "smt_defs.h"
+#include "solver.h"
+#include "term.h"
+#include "term_dag.h"
+
+namespace smt {
+
+class MultiTermTranslator
+{
+ public:
+  /** @param solvers the solvers to translate terms to
+   *  as with TermTranslator, all the transferred terms must come from
+   *  the same solver, and generic solvers are not supported as targets
+   */
+  MultiTermTranslator(const std::vector<SmtSolver> & solvers);
+
+  /** @return the number of target solvers */
+  size_t get_num_targets() const { return targets.size(); };
+
+  /** Walks the terms in the source solver and records everything that
+   *  is needed to rebuild them. Terms that were already prepared are not
+   *  walked again. Not thread-safe, and must not run concurrently with
+   *  replay.
+   *  @param terms the terms to prepare
+   */
+  void prepare(const TermVec & terms);
+
+  /** Rebuilds all the prepared terms that target i does not have yet.
+   *  Does not use the source solver, so it can be called concurrently
+   *  for different targets.
+   *  @param i the index of the target solver
+   */
+  void replay(size_t i);
+
+  /** @param i the index of the target solver
+   *  @param term a prepared term, replayed in target i
+   *  @return the term in target i
+   */
+  Term get_term(size_t i, const Term & term) const;
+
+  /** Same as above, but casts the term to a SortKind
+   *  see TermTranslator::transfer_term(const Term &, const SortKind)
+   */
+  Term get_term(size_t i, const Term & term, const SortKind sk) const;
+
+  /** Prepares a term and replays it in all targets in parallel
+   *  @param term the term to transfer
+   *  @return the term in each of the target solvers, in order
+   */
+  TermVec transfer_term(const Term & term);
+
+  /** Same as above, but casts the term to a SortKind in each target
+   *  see TermTranslator::transfer_term(const Term &, const SortKind)
+   */
+  TermVec transfer_term(const Term & term, const SortKind sk);
+
+ protected:
+  // the recorded DAG, shared by all targets
+  TermDag dag;
+  // one builder per target solver
+  std::vector<TermDagBuilder> targets;
+};
+
+}  // namespace smt
@@ -9,48 +9,320 @@
 ** All rights reserved.  See the file LICENSE in the top-level source
 ** directory for licensing information.\endverbatim
 **
-** \brief Header for a portfolio solving function that takes a vector
-**        of solvers and a term, and returns check_sat from the first solver
-**        that finishes.
+** \brief A solver that races several solvers on every query, and answers
+**        with the first one that finishes.
+**
+** Terms are built by a source solver, which never solves. Assertions,
+** push and pop are recorded, and each member solver catches up on them
+** in its own thread at the next query, transferring only the new terms.
+** Models and unsat assumptions come from the member that won the last
+** query, translated back to the source solver. With a SolverSelector,
+** only the members that won most often on similar formulas are launched
+** (see set_selector).
+**
+** Example:
+**   SmtSolver p = std::make_shared<PortfolioSolver>(
+**       source, std::vector<SmtSolver>{ btor, yices });
+**   p->assert_formula(p->make_term(BVUlt, x, y));
+**   Result r = p->check_sat();
+**   Term v = p->get_value(x);
+**
 **/
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
+#include <exception>
+#include <memory>
 #include <mutex>
 #include <thread>
 
+#include "multi_term_translator.h"
 #include "smt.h"
+#include "solver_selector.h"
+#include "term_features.h"
 
 namespace smt {
 
-class PortfolioSolver
+class PortfolioSolver : public AbsSmtSolver
 {
  public:
+  /** @param source the solver used to build terms
+   *  @param members the solvers to race on every query
+   *  the members should be configured (e.g. incremental, produce-models)
+   *  through the portfolio, which forwards set_opt and set_logic to them
+   */
+  PortfolioSolver(const SmtSolver & source, std::vector<SmtSolver> members);
+
+  /** Portfolio without a source solver, for a single term
+   *  Only portfolio_solve and the solving interface can be used.
+   */
   PortfolioSolver(std::vector<SmtSolver> slvrs, Term trm);
 
+  /** Waits for the threads that are still running, see check_sat */
+  ~PortfolioSolver();
+
+  PortfolioSolver(const PortfolioSolver &) = delete;
+  PortfolioSolver & operator=(const PortfolioSolver &) = delete;
+
   /** Launch many solvers and return whether the term is satisfiable when one of
    *  them has finished.
-   *  @param solvers The solvers to run.
-   *  @param t The term to be checked.
+   *  The term given to the constructor is asserted on the first call.
    */
   smt::Result portfolio_solve();
 
+  /** @return the index of the member that answered the last query
+   *  throws an IncorrectUsageException if no member answered sat or unsat
+   */
+  size_t get_winner() const;
+
+  /** @return the wall-clock time of the last query, from its start until
+   *  the winner answered (or all the members stopped)
+   */
+  std::chrono::duration<double> get_solve_time() const;
+
+  /** @return the member solvers */
+  const std::vector<SmtSolver> & get_members() const { return solvers; };
+
+  /** Launch only some of the members on each query, chosen by a selector
+   *  from the features of the asserted formulas (see TermFeatures, the
+   *  assumptions of check_sat_assuming are not included). The members
+   *  are known to the selector by the names of their solver enums.
+   *  The features cover the formulas asserted since set_selector or the
+   *  last reset, including popped ones.
+   *  @param sel the performance table, updated after each query
+   *  @param k the number of members to launch, the best ones first
+   *  @param time_slice if positive, the k members run one after another
+   *         instead of in parallel, each for time_slice seconds, except
+   *         the last one, which runs until it answers. A slice can only
+   *         be ended by interrupting its member, so the members that do
+   *         not support interrupt (e.g. cvc5) run after all the others,
+   *         each until it answers. Whether a member supports it is
+   *         checked here, by calling interrupt while no query runs.
+   */
+  void set_selector(std::shared_ptr<SolverSelector> sel,
+                    size_t k,
+                    double time_slice = 0);
+
+  /** @return the CPU time used by the members in the queries so far
+   *  (of the threads running them, not counting threads that the
+   *  solvers start on their own)
+   */
+  std::chrono::duration<double> get_cpu_time() const;
+
+  // forwarded to all the members
+  void set_opt(const std::string option, const std::string value) override;
+  void set_logic(const std::string logic) override;
+  void assert_formula(const Term & t) override;
+  void push(uint64_t num = 1) override;
+  void pop(uint64_t num = 1) override;
+  uint64_t get_context_level() const override;
+  void reset() override;
+  void reset_assertions() override;
+  void interrupt() override;
+
+  /** Races the members. The first sat or unsat answer wins, and the other
+   *  members are interrupted (see AbsSmtSolver::interrupt) and their
+   *  threads joined. Members that do not support interrupting are left
+   *  running, and are waited for by the next query or the destructor.
+   *  If no member answers sat or unsat, returns unknown, or rethrows the
+   *  exception of the first member if all of them failed.
+   */
+  Result check_sat() override;
+  Result check_sat_assuming(const TermVec & assumptions) override;
+  Result check_sat_assuming_list(const TermList & assumptions) override;
+  Result check_sat_assuming_set(const UnorderedTermSet & assumptions) override;
+
+  // answered by the winner of the last query
+  Term get_value(const Term & t) const override;
+  UnorderedTermMap get_array_values(const Term & arr,
+                                    Term & out_const_base) const override;
+  void get_unsat_assumptions(UnorderedTermSet & out) override;
+
+  // dispatched to the source solver
+  Sort make_sort(const std::string name, uint64_t arity) const override;
+  Sort make_sort(const SortKind sk) const override;
+  Sort make_sort(const SortKind sk, uint64_t size) const override;
+  Sort make_sort(const SortKind sk, const Sort & sort1) const override;
+  Sort make_sort(const SortKind sk,
+                 const Sort & sort1,
+                 const Sort & sort2) const override;
+  Sort make_sort(const SortKind sk,
+                 const Sort & sort1,
+                 const Sort & sort2,
+                 const Sort & sort3) const override;
+  Sort make_sort(const SortKind sk, const SortVec & sorts) const override;
+  Sort make_sort(const Sort & sort_con, const SortVec & sorts) const override;
+  Sort make_sort(const DatatypeDecl & d) const override;
+
+  DatatypeDecl make_datatype_decl(const std::string & s) override;
+  DatatypeConstructorDecl make_datatype_constructor_decl(
+      const std::string s) override;
+  void add_constructor(DatatypeDecl & dt,
+                       const DatatypeConstructorDecl & con) const override;
+  void add_selector(DatatypeConstructorDecl & dt,
+                    const std::string & name,
+                    const Sort & s) const override;
+  void add_selector_self(DatatypeConstructorDecl & dt,
+                         const std::string & name) const override;
+  Term get_constructor(const Sort & s, std::string name) const override;
+  Term get_tester(const Sort & s, std::string name) const override;
+  Term get_selector(const Sort & s,
+                    std::string con,
+                    std::string name) const override;
+
+  Term make_term(bool b) const override;
+  Term make_term(int64_t i, const Sort & sort) const override;
+  Term make_term(const std::string & s,
+                 bool useEscSequences,
+                 const Sort & sort) const override;
+  Term make_term(const std::wstring & s, const Sort & sort) const override;
+  Term make_term(const std::string val,
+                 const Sort & sort,
+                 uint64_t base = 10) const override;
+  Term make_term(const BVValue & val, const Sort & sort) const override;
+  Term make_term(const Term & val, const Sort & sort) const override;
+  Term make_symbol(const std::string name, const Sort & sort) override;
+  Term get_symbol(const std::string & name) override;
+  Term make_param(const std::string name, const Sort & sort) override;
+  Term make_term(const Op op, const Term & t) const override;
+  Term make_term(const Op op, const Term & t0, const Term & t1) const override;
+  Term make_term(const Op op,
+                 const Term & t0,
+                 const Term & t1,
+                 const Term & t2) const override;
+  Term make_term(const Op op, const TermVec & terms) const override;
+  Term substitute(const Term term,
+                  const UnorderedTermMap & substitution_map) const override;
+  TermVec substitute_terms(
+      const TermVec & terms,
+      const UnorderedTermMap & substitution_map) const override;
+
  private:
+  // a recorded command, replayed in each member before its next query
+  enum PortfolioCommandKind
+  {
+    ASSERT_CMD,
+    PUSH_CMD,
+    POP_CMD,
+    RESET_ASSERTIONS_CMD
+  };
+  struct PortfolioCommand
+  {
+    PortfolioCommandKind kind;
+    Term term;     // for ASSERT_CMD
+    uint64_t num;  // for PUSH_CMD and POP_CMD
+  };
+
+  SmtSolver source;
   smt::Result result;
   std::vector<SmtSolver> solvers;
+  // for portfolio_solve
   Term portfolio_term;
-  // Once a solver is done, result has been set,
-  // and the main thread can terminate the others.
-  bool a_solver_is_done = false;
+  bool portfolio_term_asserted;
+  // walks each asserted term once, each member replays it on its own
+  // mutable because get_value transfers the queried term to the winner
+  mutable std::unique_ptr<MultiTermTranslator> translator;
+  // translators from each member back to the source solver
+  mutable std::vector<std::unique_ptr<TermTranslator>> back_translators;
+  // one thread per member, joined before the next query
+  std::vector<std::thread> threads;
+
+  // commands since the slowest member's last query
+  std::vector<PortfolioCommand> commands;
+  // for each member, the number of commands it already applied
+  std::vector<size_t> applied;
+  uint64_t context_level;
+
+  // the assumptions of the last query, in the source solver and in each
+  // member (empty for check_sat)
+  bool last_query_assuming;
+  TermVec assumptions;
+  std::vector<TermVec> member_assumptions;
+
+  // see set_selector
+  std::shared_ptr<SolverSelector> selector;
+  size_t num_launched;
+  double time_slice;
+  // whether each member supports interrupt, see set_selector
+  std::vector<bool> interruptible;
+  std::vector<std::string> member_names;
+  TermFeatures features;
+
+  // The fields below are protected by m.
+  // Index of the first member that answered sat or unsat,
+  // solvers.size() until then.
+  size_t winner;
+  // Number of threads of the current query that are not done.
+  size_t num_running;
+  // Whether each member caught up with the commands, and whether its
+  // thread is done. Once caught up, a member no longer reads the shared
+  // translator and commands.
+  std::vector<bool> synced;
+  std::vector<bool> done;
+  // The results and exceptions of the members that are done.
+  std::vector<smt::Result> results;
+  std::vector<std::exception_ptr> errors;
+  // wall-clock seconds of each member in the current query
+  std::vector<double> member_seconds;
+  std::chrono::steady_clock::time_point start_time;
+  std::chrono::steady_clock::duration solve_time;
+  std::chrono::duration<double> cpu_time;
 
   // Used for synchronization.
-  std::mutex m;
-  std::condition_variable cv;
+  mutable std::mutex m;
+  mutable std::condition_variable cv;
+
+  /** @return the source solver, throws if there is none */
+  const SmtSolver & get_source() const;
+
+  /** Replays the new terms and commands in member i */
+  void sync_member(size_t i);
+
+  /** Runs the query in member i, in its own thread. */
+  void run_solver(size_t i);
+
+  /** Races the members on the current commands
+   *  @param assuming whether to use check_sat_assuming
+   *  @param assumps the assumptions in the source solver
+   */
+  Result race(bool assuming, const TermVec & assumps);
+
+  // The outcome of a launch, copied while holding m. Members that cannot
+  // be interrupted may still be running after a launch, and writing the
+  // fields protected by m.
+  struct LaunchOutcome
+  {
+    size_t winner;
+    smt::Result result;
+    std::vector<smt::Result> results;
+    std::vector<std::exception_ptr> errors;
+    std::vector<double> member_seconds;
+  };
+
+  /** Runs some members until one of them answers sat or unsat
+   *  @param launched the indices of the members to run
+   *  @param timeout if positive, stop them after this many seconds
+   *  @param out updated with the winner and with the results of the
+   *         launched members
+   */
+  void launch(const std::vector<size_t> & launched,
+              double timeout,
+              LaunchOutcome & out);
+
+  /** Waits until no running member reads the translator or the commands,
+   *  before they are changed */
+  void wait_synced() const;
+
+  /** Join all the threads of the previous query */
+  void join_all();
+
+  /** @return the winner of the last query, throws if there is none */
+  const SmtSolver & get_winning_solver() const;
 
-  /** Translate the term t to the solver s, and check_sat.
-   *  @param s The solver to translate the term t to.
-   *  @param t The term being translated to solver s.
+  /** @return a term of the winner translated back to the source solver
+   *  @param sk the SortKind of the term in the source solver
    */
-  void run_solver(SmtSolver s);
+  Term to_source(const Term & t, SortKind sk) const;
 };
 }  // namespace smt
@@ -66,6 +66,8 @@ class PrintingSolver : public AbsSmtSolver
   Result get_interpolant(const Term & A,
                          const Term & B,
                          Term & out_I) const override;
+  // not printed, it does not correspond to a command
+  void interrupt() override;
 
   /* Operators that are not printed 
    * For example, creating terms is not printed, but the
@@ -103,6 +105,7 @@ class PrintingSolver : public AbsSmtSolver
   Term make_term(const std::string val,
                  const Sort & sort,
                  uint64_t base = 10) const override;
+  Term make_term(const BVValue & val, const Sort & sort) const override;
   Term make_term(const Term & val, const Sort & sort) const override;
   Term make_term(const Op op, const Term & t) const override;
   Term make_term(const Op op, const Term & t0, const Term & t1) const override;
@@ -28,6 +28,9 @@
 // Abstract sort interface.
 #include "sort.h"  // IWYU pragma: export
 
+// Solver-neutral bit-vector values.
+#include "bv_value.h"  // IWYU pragma: export
+
 // Abstract term interface.
 #include "term.h"  // IWYU pragma: export
 
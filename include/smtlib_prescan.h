@@ -0,0 +1,126 @@
+/*********************                                                        */
+/*! \file smtlib_prescan.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-independent pre-scanning of SMT-LIB text, used by
+**        SmtLibReader::parse_parallel to parse assertions on several
+**        threads.
+**
+** split_smtlib_commands finds the top-level commands of a text by
+** matching parentheses. An SmtLibTermDag parses the term of an assert
+** command into a DAG of names and literals, without looking anything up,
+** so it can run on any thread. Let-bound names are resolved while
+** parsing: their occurrences share the node of the bound term.
+**
+** Example:
+**   for (const SmtLibCommand & c : split_smtlib_commands(text))
+**   {
+**     SmtLibTermDag dag;
+**     if (c.keyword == "assert" && dag.parse(c.body))
+**       ...
+**   }
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace smt {
+
+/** A top-level command, the views are into the scanned text */
+struct SmtLibCommand
+{
+  std::string_view text;     ///< the whole command, with its parentheses
+  std::string_view keyword;  ///< e.g. assert, empty if not a command
+  std::string_view body;     ///< the text between the keyword and ')'
+  size_t line;               ///< the line the command starts on, from 1
+};
+
+/** Splits a text into its top-level commands. Text that is not a
+ *  well-formed command (e.g. unbalanced parentheses) is returned as a
+ *  command with an empty keyword, for the parser to report.
+ *  @param text SMT-LIB commands
+ *  @return the commands, in order
+ */
+std::vector<SmtLibCommand> split_smtlib_commands(std::string_view text);
+
+enum SmtLibTermKind : uint8_t
+{
+  SMTLIB_SYMBOL = 0,
+  SMTLIB_NUMERAL,
+  SMTLIB_DECIMAL,
+  SMTLIB_BINARY,      ///< text is the digits after #b
+  SMTLIB_HEX,         ///< text is the digits after #x
+  SMTLIB_BV_DECIMAL,  ///< (_ bvN w), text is N and idx0 is w
+  SMTLIB_APPLY,       ///< text is the function symbol
+  SMTLIB_INDEXED_APPLY  ///< text is the operator, with num_idx indices
+};
+
+struct SmtLibTermNode
+{
+  SmtLibTermKind kind;
+  uint8_t num_idx;
+  std::string_view text;  ///< a view into the parsed text
+  uint64_t idx0;
+  uint64_t idx1;
+  // children are node indices in children[first_child, +num_children)
+  uint32_t first_child;
+  uint32_t num_children;
+};
+
+/** A parsed term, with the nodes in topological order (children first) */
+class SmtLibTermDag
+{
+ public:
+  /** Parses a term
+   *  @param term the text of the term, must outlive the DAG
+   *  @return false if the term uses syntax that is not supported here:
+   *  quantifiers, annotations, string literals, qualified terms and
+   *  anything not well-formed. Those are left to the full parser.
+   */
+  bool parse(std::string_view term);
+
+  const std::vector<SmtLibTermNode> & get_nodes() const { return nodes; };
+  const std::vector<uint32_t> & get_children() const { return children; };
+  /** @return the node of the parsed term, the last one */
+  uint32_t get_root() const { return nodes.size() - 1; };
+
+  void clear();
+
+ protected:
+  /** Reads the s-expressions of the text into sexprs */
+  bool read_sexprs(std::string_view text);
+
+  /** Converts sexprs into nodes */
+  bool convert();
+
+  /** Adds the node of an atom
+   *  @return false if the atom is not supported
+   */
+  bool add_atom(std::string_view atom);
+
+  // s-expressions, in the order they are closed
+  struct SExpr
+  {
+    std::string_view atom;  ///< empty for lists
+    uint32_t first_child;   ///< into sexpr_children
+    uint32_t num_children;
+  };
+  std::vector<SExpr> sexprs;
+  std::vector<uint32_t> sexpr_children;
+
+  std::vector<SmtLibTermNode> nodes;
+  std::vector<uint32_t> children;
+};
+
+}  // namespace smt
@@ -17,11 +17,15 @@
 #pragma once
 
 #include "assert.h"
+#include <istream>
 #include <string>
 #include <unordered_map>
 
 #include "smt.h"
+#include "smtlib_prescan.h"
 #include "smtlibparser.h"
+#include "string_interner.h"
+#include "term_template.h"
 
 #define YY_DECL smtlib::parser::symbol_type yylex(smt::SmtLibReader & drv)
 YY_DECL;
@@ -48,6 +52,7 @@ enum Command
 
 /** Basic scoped symbol map
  *  Used for arguments and parameters that have limited scope
+ *  The symbols are interned (see SmtLibReader::intern)
  *  Does not support shadowing within the same mapping scope
  *    e.g. forall x . P(x) -> exists x. Q(x)
  *    is not supported
@@ -63,11 +68,11 @@ class UnorderedScopedSymbolMap
 
   size_t current_scope() { return symbols_.size() - 1; }
 
-  void add_mapping(const std::string & sym, const smt::Term & t)
+  void add_mapping(const InternedString & sym, const smt::Term & t)
   {
     if (symbol_map_.find(sym) != symbol_map_.end())
     {
-      throw SmtException("Repeated symbol: " + sym);
+      throw SmtException("Repeated symbol: " + sym.str());
     }
     symbol_map_[sym] = t;
     symbols_.back().insert(sym);
@@ -89,7 +94,7 @@ class UnorderedScopedSymbolMap
    *  @param sym the symbol to look up
    *  @return the associated term or null pointer if not in map
    */
-  smt::Term get_symbol(const std::string & sym)
+  smt::Term get_symbol(const InternedString & sym)
   {
     Term res;
     auto it = symbol_map_.find(sym);
@@ -101,8 +106,31 @@ class UnorderedScopedSymbolMap
   }
 
  private:
-  std::vector<std::unordered_set<std::string>> symbols_;
-  std::unordered_map<std::string, smt::Term> symbol_map_;
+  std::vector<std::unordered_set<InternedString>> symbols_;
+  std::unordered_map<InternedString, smt::Term> symbol_map_;
+};
+
+/** An application in a pre-parsed assertion, with its built arguments
+ *  (see SmtLibReader::build_parsed_term)
+ */
+struct ParsedApplication
+{
+  InternedString head;
+  uint8_t num_idx;
+  uint64_t idx0;
+  uint64_t idx1;
+  smt::TermVec args;
+
+  bool operator==(const ParsedApplication & other) const
+  {
+    return head == other.head && num_idx == other.num_idx
+           && idx0 == other.idx0 && idx1 == other.idx1 && args == other.args;
+  };
+};
+
+struct ParsedApplicationHash
+{
+  size_t operator()(const ParsedApplication & app) const;
 };
 
 class SmtLibReader
@@ -117,7 +145,48 @@ class SmtLibReader
    */
   SmtLibReader(smt::SmtSolver & solver, bool strict = false);
 
+  /** Parses and executes the commands of a file
+   *  @param f the file name, "-" or "" for stdin
+   *  @return 0 on success
+   */
   int parse(const std::string & f);
+
+  /** Parses and executes the commands of a stream, e.g. an
+   *  std::istringstream over a memory buffer, or a stream reading
+   *  from a pipe or socket
+   *  @param in the stream to read until its end (or an exit command)
+   *  @param interactive if true, reads one line at a time, and executes
+   *         the commands of a line as soon as it arrives. Otherwise reads
+   *         blocks, which is faster but can wait for more input than the
+   *         commands need.
+   *  @param name the name of the input in error locations
+   *  @return 0 on success
+   */
+  int parse(std::istream & in,
+            bool interactive = false,
+            const std::string & name = "<stream>");
+
+  /** Parses and executes the commands in a string
+   *  @param commands SMT-LIB commands
+   *  @return 0 on success
+   */
+  int parse_string(const std::string & commands);
+
+  /** Parses and executes the commands of a file like parse, but parses
+   *  the terms of the assert commands on several threads.
+   *  Commands are still executed in file order, so declarations, scopes
+   *  and push/pop behave as in parse. Identical applications of a
+   *  function to the same arguments are only built once.
+   *  Assertions with syntax that the threads do not handle (see
+   *  SmtLibTermDag::parse) and all other commands are parsed by the
+   *  sequential parser.
+   *  @param f the file name
+   *  @param num_threads the number of parsing threads,
+   *         0 for the number of hardware threads
+   *  @return 0 on success
+   */
+  int parse_parallel(const std::string & f, size_t num_threads = 0);
+
   // The name of the file being parsed.
   std::string file;
 
@@ -184,12 +253,24 @@ class SmtLibReader
 
   /* Methods for use in flex/bison generated code */
 
+  /** @param str a string
+   *  @return the unique copy of str owned by this reader
+   *  Symbols and keywords are interned by the scanner, so that each
+   *  distinct name is allocated and hashed once, and the lookups below
+   *  hash names by address.
+   */
+  InternedString intern(std::string_view str) { return interner_.intern(str); }
+
   /** Look up a symbol by name
    *  Returns a null term if there is no known symbol
    *  with that name
    *  @return term
    */
-  smt::Term lookup_symbol(const std::string & sym);
+  smt::Term lookup_symbol(const InternedString & sym);
+  smt::Term lookup_symbol(const std::string & sym)
+  {
+    return lookup_symbol(intern(sym));
+  }
 
   /** Creates a new symbol
    *  This is a light wrapper around solver_->make_symbol
@@ -205,7 +286,11 @@ class SmtLibReader
    *  @return the associated PrimOp
    *  Returns NUM_OPS_AND_NULL if there's no match
    */
-  PrimOp lookup_primop(const std::string & str);
+  PrimOp lookup_primop(const InternedString & str);
+  PrimOp lookup_primop(const std::string & str)
+  {
+    return lookup_primop(intern(str));
+  }
 
   /** Look up a sort by string
    *  The available sorts are based on the logic
@@ -214,15 +299,19 @@ class SmtLibReader
    *  Returns NUM_SORT_KINDS (a null element) if there's
    *  no match
    */
-  smt::SortKind lookup_sortkind(const std::string & str);
+  smt::SortKind lookup_sortkind(const InternedString & str);
+  smt::SortKind lookup_sortkind(const std::string & str)
+  {
+    return lookup_sortkind(intern(str));
+  }
 
   /** Create a define-fun macro
    *  @param name the name of the define-fun
    *  @param the definition
    *  @param the arguments to the define-fun
-   *  stored in defs_ and def_args_
+   *  compiled into a TermTemplate stored in defs_
    */
-  void define_fun(const std::string & name,
+  void define_fun(const InternedString & name,
                   const smt::Term & def,
                   const smt::TermVec & args = {});
 
@@ -231,8 +320,10 @@ class SmtLibReader
    *  @param args the arguments to apply it to
    *         the parameter args from the define-fun
    *         declaration will be replaced by these arguments
+   *  Applications to the same arguments are only built once
    */
-  Term apply_define_fun(const std::string & defname, const smt::TermVec & args);
+  Term apply_define_fun(const InternedString & defname,
+                        const smt::TermVec & args);
 
   /** Helper function for define-fun - similar to new_symbol
    *  Associates an argument with a temporary symbol for
@@ -246,7 +337,7 @@ class SmtLibReader
    *  These aren't used except in the definition and will always
    *  be substituted for
    */
-  Term register_arg(const std::string & name, const smt::Sort & sort);
+  Term register_arg(const InternedString & name, const smt::Sort & sort);
 
   /** Create an alias for a sort
    *  define-sort in SMT-LIB can take arguments, but currently this
@@ -256,14 +347,17 @@ class SmtLibReader
    *  @param name the name of the defined sort
    *  @param sort the sort to associate name with
    */
-  void define_sort(const std::string & name,
-                   const smt::Sort & sort);
+  void define_sort(const InternedString & name, const smt::Sort & sort);
 
   /** Looks up a defined sort by name
    *  @param name the name to look up
    *  @return the sort
    */
-  smt::Sort lookup_sort(const std::string & name);
+  smt::Sort lookup_sort(const InternedString & name);
+  smt::Sort lookup_sort(const std::string & name)
+  {
+    return lookup_sort(intern(name));
+  }
 
   /** Creates a parameter and stores it in the scoped data-structure
    *  arg_param_map_
@@ -272,18 +366,50 @@ class SmtLibReader
    *  @param sort the sort of the parameter
    *  @return the parameter
    */
-  Term create_param(const std::string & name, const smt::Sort & sort);
+  Term create_param(const InternedString & name, const smt::Sort & sort);
 
   /** Declare a let binding mapping a symbol to a term
    *  for the current scope
    *  @param sym the symbol
    *  @param term the term
    */
-  void let_binding(const std::string & sym, const smt::Term & term);
+  void let_binding(const InternedString & sym, const smt::Term & term);
 
  protected:
+  /** Runs the parser on the input set up by parse
+   *  @param line the line number of the first line of the input
+   */
+  int run_parser(size_t line = 1);
+
+  /** Parses and executes the commands of a stream
+   *  see parse
+   *  @param line the line number of the first line of the stream
+   */
+  int parse_stream(std::istream & in,
+                   bool interactive,
+                   const std::string & name,
+                   size_t line);
+
+  /** Builds the term of an assertion pre-parsed by parse_parallel,
+   *  as the parser would
+   *  @param dag the pre-parsed assertion
+   *  @return the term
+   *  throws an SmtException if the term is not well-formed, e.g. it
+   *  uses an unknown symbol (the parser then reports the error)
+   */
+  smt::Term build_parsed_term(const SmtLibTermDag & dag);
+
+  /** Builds a pre-parsed application, see build_parsed_term */
+  smt::Term build_parsed_application(const ParsedApplication & app);
+
   smtlib::location location_;
 
+  std::istream * in_;  ///< the stream being parsed, or nullptr for a file
+
+  bool interactive_;  ///< whether in_ is read one line at a time
+
+  StringInterner interner_;  ///< owns the names of all the maps below
+
   smt::SmtSolver solver_;
 
   bool strict_;
@@ -295,18 +421,18 @@ class SmtLibReader
   bool allow_ufs_;  ///< set to true if declaring functions
                     ///< is supported in the set logic
 
-  std::unordered_map<std::string, smt::PrimOp>
+  std::unordered_map<InternedString, smt::PrimOp>
       primops_;  ///< available primops with set logic
 
-  std::unordered_map<std::string, smt::SortKind>
+  std::unordered_map<InternedString, smt::SortKind>
       sortkinds_;  ///< available sortkinds with set logic
 
-  std::unordered_map<std::string, smt::Term>
+  std::unordered_map<InternedString, smt::Term>
       all_symbols_;  ///< remembers all symbolic constants
                      ///< and functions
                      ///< even after context is popped
 
-  std::unordered_map<std::string, smt::Sort>
+  std::unordered_map<InternedString, smt::Sort>
     defined_sorts_; ///< mapping from symbol to defined sort
                     ///< currently only supports 0-arity defines
 
@@ -323,11 +449,9 @@ class SmtLibReader
                        ///< e.g. nested quantifiers
 
   // define-fun data structures
-  std::unordered_map<std::string, smt::Term>
+  std::unordered_map<InternedString, smt::TermTemplate>
       defs_;  ///< keeps track of define-funs
-  std::unordered_map<std::string, smt::TermVec>
-      def_args_;  ///< keeps track of define-fun
-                  ///< arguments
+              ///< with arguments
   std::unordered_map<smt::Sort, smt::TermVec>
       tmp_args_;  ///< temporary variables
                   ///< organized by sort
@@ -339,8 +463,16 @@ class SmtLibReader
                       ///<  tmp argument is needed)
                       ///< that is currently unused in this scope
 
+  std::unordered_map<ParsedApplication, smt::Term, ParsedApplicationHash>
+      parsed_applications_;  ///< applications built by build_parsed_term
+                             ///< cleared when a command could change
+                             ///< the meaning of a symbol, e.g. pop
+  ParsedApplication parsed_key_;  ///< scratch key for the lookups
+
   // useful constants
   std::string def_arg_prefix_;  ///< the prefix for renamed define-fun arguments
+  InternedString true_;   ///< "true"
+  InternedString false_;  ///< "false"
 };
 
 }  // namespace smt
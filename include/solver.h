@@ -245,6 +245,14 @@ class AbsSmtSolver
                          const Sort & sort,
                          uint64_t base = 10) const = 0;
 
+  /* Make a bit-vector value term from a solver-neutral value
+   * the default implementation goes through the base 2 string version
+   * @param val the value
+   * @param sort the sort to create, must have the same width as val
+   * @return a value term with Sort sort and value val
+   */
+  virtual Term make_term(const BVValue & val, const Sort & sort) const;
+
   /* Make a value of a particular sort, such as constant arrays
    * @param val the Term used to create the value (.e.g constant array with 0)
    * @param sort the sort of value to create
@@ -458,6 +466,19 @@ class AbsSmtSolver
   virtual Result get_sequence_interpolants(const TermVec & formulae,
                                            TermVec & out_I) const;
 
+  /** Asks a running check_sat (or check_sat_assuming) to stop
+   *  it then returns unknown as soon as the solver notices the request.
+   *  This is the only method that may be called from another thread
+   *  while the solver is in use. It has no effect when no query is
+   *  running, so a caller racing with the start of a query should call
+   *  it again until the query returns.
+   */
+  virtual void interrupt()
+  {
+    throw NotImplementedException(
+        "Interrupting queries is not supported by this solver.");
+  }
+
   SolverEnum get_solver_enum() { return solver_enum; };
 
  protected:
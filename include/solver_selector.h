@@ -0,0 +1,88 @@
+/*********************                                                        */
+/*! \file solver_selector.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A table of how solvers performed on buckets of formulas (see
+**        TermFeatures::get_bucket), used to choose which solvers to run.
+**
+** The table can be saved to and loaded from a text file, with one line
+** per bucket and solver:
+**   <bucket> TAB <solver> TAB <runs> TAB <wins> TAB <seconds>
+** where seconds is the total time of the wins.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace smt {
+
+struct SolverPerformance
+{
+  uint64_t runs = 0;        ///< queries the solver was launched on
+  uint64_t wins = 0;        ///< queries the solver answered first
+  double win_seconds = 0;   ///< total time of the wins
+};
+
+/** Thread-safe, so one table can be shared by several portfolios */
+class SolverSelector
+{
+ public:
+  SolverSelector() {};
+
+  /** Records the outcome of a query
+   *  @param bucket the bucket of the query
+   *  @param solver the name of the solver
+   *  @param won whether the solver answered first
+   *  @param seconds the time it took to answer, if it won
+   */
+  void record(const std::string & bucket,
+              const std::string & solver,
+              bool won,
+              double seconds);
+
+  /** @return the performance of a solver on a bucket (zero if unknown) */
+  SolverPerformance get_performance(const std::string & bucket,
+                                    const std::string & solver) const;
+
+  /** Orders solvers from the most to the least promising on a bucket.
+   *  Solvers are ranked by their estimated chance of winning,
+   *  (wins + 1) / (runs + 2), so that solvers with few runs are still
+   *  tried, and then by their average time to win.
+   *  @param bucket the bucket of the query
+   *  @param solvers the names of the candidate solvers
+   *  @return indices into solvers, best first
+   */
+  std::vector<size_t> rank(const std::string & bucket,
+                           const std::vector<std::string> & solvers) const;
+
+  /** Adds the entries of a saved table to this one
+   *  throws an IncorrectUsageException if the input is malformed
+   */
+  void load(std::istream & in);
+  void load_file(const std::string & filename);
+
+  void save(std::ostream & out) const;
+  void save_file(const std::string & filename) const;
+
+ protected:
+  // bucket -> solver -> performance
+  // ordered, so that saved tables are stable
+  std::map<std::string, std::map<std::string, SolverPerformance>> table;
+  mutable std::mutex m;
+};
+
+}  // namespace smt
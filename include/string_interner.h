@@ -0,0 +1,120 @@
+/*********************                                                        */
+/*! \file string_interner.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A table of unique strings, so that each distinct string is
+**        stored and hashed once, and then compared and hashed by address.
+**
+** Example:
+**   StringInterner interner;
+**   InternedString a = interner.intern("x");
+**   InternedString b = interner.intern(std::string("x"));
+**   assert(a == b && a.view().data() == b.view().data());
+**
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace smt {
+
+class StringInterner;
+
+/** A string owned by a StringInterner, valid as long as the interner.
+ *  Two interned strings of the same interner are equal iff they have
+ *  the same address, so comparing and hashing them is constant time.
+ */
+class InternedString
+{
+ public:
+  /** The null string, different from all interned strings */
+  InternedString() {}
+
+  std::string_view view() const { return view_; };
+  operator std::string_view() const { return view_; };
+  /** @return a copy of the string */
+  std::string str() const { return std::string(view_); };
+  /** @return the string, with a terminating null character */
+  const char * c_str() const { return view_.data(); };
+  size_t size() const { return view_.size(); };
+  bool is_null() const { return !view_.data(); };
+
+  bool operator==(const InternedString & other) const
+  {
+    return view_.data() == other.view_.data();
+  };
+  bool operator!=(const InternedString & other) const
+  {
+    return view_.data() != other.view_.data();
+  };
+
+ protected:
+  friend class StringInterner;
+  InternedString(std::string_view v) : view_(v) {}
+
+  std::string_view view_;
+};
+
+std::ostream & operator<<(std::ostream & output, const InternedString & s);
+
+std::string operator+(const std::string & a, const InternedString & b);
+std::string operator+(const InternedString & a, const std::string & b);
+
+class StringInterner
+{
+ public:
+  StringInterner() : block_used_(BLOCK_SIZE) {}
+
+  StringInterner(const StringInterner &) = delete;
+  StringInterner & operator=(const StringInterner &) = delete;
+
+  /** @param str a string
+   *  @return the unique interned copy of str (copied the first time
+   *  str is interned)
+   */
+  InternedString intern(std::string_view str);
+
+  /** @return the number of distinct strings */
+  size_t size() const { return table_.size(); };
+
+ protected:
+  // size of the blocks the strings are stored in
+  static const size_t BLOCK_SIZE = 1 << 16;
+
+  /** @return storage for n characters, which never moves */
+  char * allocate(size_t n);
+
+  std::unordered_set<std::string_view> table_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::vector<std::unique_ptr<char[]>> large_blocks_;
+  size_t block_used_;  ///< characters used in the last block
+};
+
+}  // namespace smt
+
+namespace std {
+// hashes the address, see InternedString
+template <>
+struct hash<smt::InternedString>
+{
+  size_t operator()(const smt::InternedString & s) const
+  {
+    return hash<const void *>()(s.view().data());
+  }
+};
+}  // namespace std
@@ -0,0 +1,76 @@
+/*********************                                                        */
+/*! \file substituter.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Substitution with a cache that persists across calls, e.g. to
+**        substitute the same next-state map into many related terms.
+**
+** Example:
+**   Substituter sub(solver, next_state_map);
+**   for (const Term & t : terms)
+**     sub.substitute(t);  // shared subterms are only rebuilt once
+**   sub.set_map(other_map);  // clears the cache
+**
+**/
+
+#pragma once
+
+#include "smt_defs.h"
+#include "solver.h"
+#include "term.h"
+
+namespace smt {
+
+class Substituter
+{
+ public:
+  /** @param solver the solver that owns the terms
+   *  @param substitution_map the map to apply
+   */
+  Substituter(const SmtSolver & solver,
+              const UnorderedTermMap & substitution_map = {});
+
+  /** Changes the map to apply, and clears the cache */
+  void set_map(const UnorderedTermMap & substitution_map);
+
+  const UnorderedTermMap & get_map() const { return map_; };
+
+  /** @param term the term to apply the map to
+   *  @return the term with the map applied (see AbsSmtSolver::substitute)
+   */
+  Term substitute(const Term & term);
+
+  TermVec substitute_terms(const TermVec & terms);
+
+  /** Clears the cache (but keeps the map), e.g. to free memory */
+  void clear_cache();
+
+  /** @return the number of cached terms, including the map */
+  size_t cache_size() const { return cache_.size(); };
+
+  /** Applies a substitution, with an explicit cache
+   *  The default AbsSmtSolver::substitute and substitute_terms use this.
+   *  @param solver the solver that owns the terms
+   *  @param term the term to apply the substitution to
+   *  @param cache maps terms to their substitutions, should start as the
+   *         substitution map. It is extended with the subterms of term.
+   *  @return the term with the substitution applied
+   */
+  static Term substitute(const AbsSmtSolver & solver,
+                         const Term & term,
+                         UnorderedTermMap & cache);
+
+ protected:
+  SmtSolver solver_;
+  UnorderedTermMap map_;
+  UnorderedTermMap cache_;
+};
+
+}  // namespace smt
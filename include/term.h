@@ -26,6 +26,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "bv_value.h"
 #include "ops.h"
 #include "smt_defs.h"
 #include "sort.h"
@@ -70,6 +71,12 @@ class AbsTerm
    *  otherwise, throws an IncorrectUsageException
    */
   virtual uint64_t to_int() const = 0;
+  /** converts a bit-vector value to a solver-neutral value
+   *  the default implementation parses to_string, which is linear in the
+   *  width when the solver prints values in binary or hexadecimal
+   *  throws an IncorrectUsageException if this is not a bit-vector value
+   */
+  virtual BVValue to_bv_value();
   /** begin iterator
    *  starts iteration through Term's children
    */
@@ -0,0 +1,267 @@
+/*********************                                                        */
+/*! \file term_dag.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-neutral representation of term DAGs, and a binary
+**        format to store them.
+**
+** A TermDag records terms as flat tables: sorts, nodes in topological
+** order (children first), child indices, strings (symbol names and
+** values) and bit-vector values. All the records have a fixed size and
+** refer to each other by index. A TermDagBuilder rebuilds the terms in
+** any solver in a single pass over the nodes.
+**
+** The binary format is a header followed by the tables as they are in
+** memory, each aligned to 8 bytes, so a file can be memory-mapped and
+** used in place. Integers are stored in the byte order of the machine
+** that wrote the file, and operators and sort kinds by their enum values,
+** so files are only meant to be read by the same version of smt-switch
+** on the same architecture (e.g. for caching and inter-process
+** communication). TERM_DAG_VERSION changes whenever the format changes.
+**
+** Example:
+**   TermDag dag;
+**   dag.write_file("query.dag", { assertion });
+**
+**   TermDagLoader loader(other_solver);
+**   TermVec terms = loader.load_file("query.dag");
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bv_value.h"
+#include "smt_defs.h"
+#include "solver.h"
+#include "sort.h"
+#include "term.h"
+#include "term_translator.h"
+
+namespace smt {
+
+const uint32_t TERM_DAG_VERSION = 1;
+
+enum TermDagNodeKind : uint8_t
+{
+  SYMBOL_NODE = 0,
+  PARAM_NODE,
+  BV_VALUE_NODE,
+  // other values, as printed by the source solver
+  VALUE_NODE,
+  CONST_ARRAY_NODE,
+  OP_NODE,
+  NUM_TERM_DAG_NODE_KINDS
+};
+
+// a sort, args are sort indices
+// (index and element sort for arrays, domain then codomain for functions)
+struct TermDagSort
+{
+  uint32_t kind;  // SortKind
+  uint32_t name;  // string index, for uninterpreted sorts
+  uint32_t first_arg;
+  uint32_t num_args;
+  uint64_t width;  // for bit-vectors
+};
+
+struct TermDagNode
+{
+  uint8_t kind;  // TermDagNodeKind
+  uint8_t num_idx;
+  uint16_t reserved;
+  uint32_t prim_op;  // for OP_NODE
+  uint32_t sort;
+  // index into strings (symbols, params and values) or bit-vector values
+  uint32_t data;
+  // children are node indices in children[first_child, +num_children)
+  uint32_t first_child;
+  uint32_t num_children;
+  uint64_t idx0;
+  uint64_t idx1;
+};
+
+struct TermDagBV
+{
+  uint64_t width;
+  uint64_t first_word;
+};
+
+/** Read-only view of the tables of a term DAG
+ *  either of a TermDag or of a loaded (memory-mapped) file
+ */
+struct TermDagView
+{
+  const TermDagSort * sorts;
+  size_t num_sorts;
+  const uint32_t * sort_args;
+  size_t num_sort_args;
+  const TermDagNode * nodes;
+  size_t num_nodes;
+  const uint32_t * children;
+  size_t num_children;
+  // string i is string_data[string_offsets[i], string_offsets[i+1])
+  const uint64_t * string_offsets;
+  size_t num_strings;
+  const char * string_data;
+  const TermDagBV * bvs;
+  size_t num_bvs;
+  const uint64_t * bv_words;
+  size_t num_bv_words;
+
+  std::string get_string(uint32_t i) const
+  {
+    return std::string(string_data + string_offsets[i],
+                       string_offsets[i + 1] - string_offsets[i]);
+  };
+
+  /** Checks that all the indices are in bounds, that sorts have the
+   *  arguments their kind needs, and that nodes only refer to earlier
+   *  nodes. Throws an IncorrectUsageException otherwise.
+   */
+  void check() const;
+};
+
+class TermDag
+{
+ public:
+  TermDag();
+
+  /** Records a term and all its subterms that were not recorded yet.
+   *  @param term the term to record
+   *  @return the index of the term's node
+   */
+  uint32_t add_term(const Term & term);
+
+  /** @return the number of recorded nodes */
+  size_t size() const { return nodes.size(); };
+
+  /** @param term a recorded term
+   *  @return the index of the term's node
+   *  throws an IncorrectUsageException if the term was not recorded
+   */
+  uint32_t get_index(const Term & term) const;
+
+  /** @return a view of the tables, valid until the next add_term */
+  TermDagView view() const;
+
+  /** Records the terms and writes the DAG in the binary format
+   *  @param out the stream to write to
+   *  @param roots the terms to write, returned in order by the loader
+   */
+  void write(std::ostream & out, const TermVec & roots);
+
+  /** Same as above, but writes to a file */
+  void write_file(const std::string & filename, const TermVec & roots);
+
+ protected:
+  // records a sort (and its argument sorts) and returns its index
+  uint32_t add_sort(const Sort & sort);
+
+  uint32_t add_string(const std::string & s);
+
+  std::vector<TermDagSort> sorts;
+  std::vector<uint32_t> sort_args;
+  std::vector<TermDagNode> nodes;
+  std::vector<uint32_t> children;
+  std::vector<uint64_t> string_offsets;
+  std::string string_data;
+  std::vector<TermDagBV> bvs;
+  std::vector<uint64_t> bv_words;
+
+  // source terms and sorts to their indices
+  std::unordered_map<Term, uint32_t> node_ids;
+  std::unordered_map<Sort, uint32_t> sort_ids;
+
+  // scratch buffer for add_term
+  std::vector<std::pair<Term, bool>> visit_stack;
+};
+
+/** Rebuilds the nodes of a term DAG in a solver
+ *  Only uses the target solver, never the solver the DAG was recorded from.
+ */
+class TermDagBuilder
+{
+ public:
+  TermDagBuilder(const SmtSolver & s);
+
+  /** Builds the nodes of the DAG that were not built yet
+   *  (i.e. the DAG may have grown since the last call)
+   *  @param dag the DAG, assumed to be well-formed (see TermDagView::check)
+   */
+  void build(const TermDagView & dag);
+
+  /** Forgets the built nodes, to build a different DAG
+   *  uninterpreted sorts are kept, so that they are the same across DAGs
+   */
+  void clear();
+
+  /** @return the number of built nodes */
+  size_t size() const { return terms.size(); };
+
+  /** @param i a built node index
+   *  @return its term in the target solver
+   */
+  const Term & get_term(uint32_t i) const { return terms.at(i); };
+
+  /** @param t a term of the target solver
+   *  @param sk the expected SortKind
+   *  @return the term casted to the SortKind
+   *  see TermTranslator::transfer_term(const Term &, const SortKind)
+   */
+  Term cast_sort_kind(const Term & t, const SortKind sk) const;
+
+  /** @return the target solver */
+  const SmtSolver & get_solver() const { return translator.solver; };
+
+ protected:
+  Sort build_sort(const TermDagView & dag, const TermDagSort & ds);
+
+  Term build_node(const TermDagView & dag, const TermDagNode & n);
+
+  // used for its helpers (casts, values, uninterpreted sorts)
+  TermTranslator translator;
+  // the built sorts and nodes, by index
+  SortVec sorts;
+  TermVec terms;
+};
+
+/** Loads terms written with TermDag::write into a solver
+ */
+class TermDagLoader
+{
+ public:
+  TermDagLoader(const SmtSolver & s);
+
+  /** Loads the roots of a DAG in the binary format
+   *  throws an IncorrectUsageException if the data is malformed
+   *  @param data the data, must be aligned to 8 bytes
+   *  @param size the size of the data in bytes
+   *  @return the roots, in the order they were written
+   */
+  TermVec load(const char * data, size_t size);
+
+  /** Same as above, but reads the data from a stream */
+  TermVec load(std::istream & in);
+
+  /** Same as above, but memory-maps a file */
+  TermVec load_file(const std::string & filename);
+
+ protected:
+  TermDagBuilder builder;
+};
+
+}  // namespace smt
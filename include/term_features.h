@@ -0,0 +1,102 @@
+/*********************                                                        */
+/*! \file term_features.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Syntactic features of formulas, used to predict which solver
+**        is fastest on them.
+**
+** Example:
+**   TermFeatures f;
+**   f.add_term(assertion);
+**   std::cout << f.get_num_nodes() << " " << f.get_bucket() << std::endl;
+**
+**/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "ops.h"
+#include "smt_defs.h"
+#include "term.h"
+
+namespace smt {
+
+class TermFeatures
+{
+ public:
+  TermFeatures();
+
+  /** Adds the subterms of a term that were not added yet
+   *  (shared subterms are counted once, as in a DAG)
+   *  @param term the term to add
+   */
+  void add_term(const Term & term);
+
+  /** Forgets all the added terms */
+  void clear();
+
+  /** @return the number of distinct subterms */
+  size_t get_num_nodes() const { return num_nodes; };
+
+  /** @return the number of distinct symbols (constants and functions) */
+  size_t get_num_symbols() const { return num_symbols; };
+
+  /** @return the number of distinct values */
+  size_t get_num_values() const { return num_values; };
+
+  /** @param po an operator
+   *  @return the number of distinct subterms with that operator
+   */
+  size_t get_op_count(PrimOp po) const { return op_counts[po]; };
+
+  /** @return the largest bit-vector width, 0 if there are none */
+  uint64_t get_max_bv_width() const { return max_bv_width; };
+
+  bool has_arrays() const { return arrays; };
+  bool has_quantifiers() const;
+  bool has_uf() const { return op_counts[Apply] > 0; };
+  bool has_ints() const { return ints; };
+  bool has_reals() const { return reals; };
+  bool has_strings() const { return strings; };
+
+  /** @return true iff there is a (bit-vector or arithmetic)
+   *  multiplication, division or remainder
+   */
+  bool has_nonlinear() const;
+
+  /** Summarizes the features in a short string, such that similar
+   *  formulas get the same string. It lists the theories (e.g.
+   *  "BV.A.UF"), whether there are nonlinear operators, and the
+   *  magnitudes (log2) of the number of nodes, symbols and of the
+   *  largest bit-vector width.
+   *  @return the bucket of the features
+   */
+  std::string get_bucket() const;
+
+ protected:
+  size_t num_nodes;
+  size_t num_symbols;
+  size_t num_values;
+  // number of nonlinear multiplications, divisions and remainders
+  size_t num_nonlinear;
+  std::array<size_t, NUM_OPS_AND_NULL> op_counts;
+  uint64_t max_bv_width;
+  bool arrays;
+  bool ints;
+  bool reals;
+  bool strings;
+
+  UnorderedTermSet visited;
+};
+
+}  // namespace smt
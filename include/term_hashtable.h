@@ -17,7 +17,7 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <vector>
 
 #include "smt_defs.h"
 #include "term.h"
@@ -25,8 +25,10 @@
 namespace smt {
 
 /** \class TermHashTable
- *  A very straightforward implementation of a Term hash table
- *  using a std::unordered_map and UnorderedTermSet
+ *  An open-addressing hash table of Terms with linear probing.
+ *  Each slot stores the hash of its term next to the term, so that
+ *  a probe only calls compare on terms with an equal hash, and every
+ *  operation hashes the term once.
  *  The primary use of this is for hash-consing in LoggingSolver
  */
 class TermHashTable
@@ -34,6 +36,9 @@ class TermHashTable
  public:
   TermHashTable();
   ~TermHashTable();
+  /** insert a term, unless an equal term is already in the table
+   *  @param t the term to insert
+   */
   void insert(const Term & t);
   /** check if a term is in the table
    *  @param the term to check
@@ -45,11 +50,60 @@ class TermHashTable
    *  @return true iff the term was found in the hash table
    */
   bool lookup(Term & t);
+  /** lookup a term and modify pointer in place, or insert it
+   *  if it is not in the table. Probes the table once.
+   *  @param t the term to look up and modify
+   *  @return true iff the term was found in the hash table
+   */
+  bool lookup_or_insert(Term & t);
   void erase(const Term & t);
   void clear();
+  /** make room for a number of terms, so that inserting them
+   *  does not resize the table
+   *  @param n the number of terms
+   */
+  void reserve(std::size_t n);
+  /** @return the number of terms in the table
+   */
+  std::size_t size() const;
+  /** @return the bytes allocated for the slots of the table,
+   *  not counting the terms themselves
+   */
+  std::size_t memory_usage() const;
+  /** removes the terms that are only referenced by the table,
+   *  which frees them. Shrinks the table if it became sparse.
+   *  @return the number of terms that were removed
+   */
+  std::size_t sweep();
 
  protected:
-  std::unordered_map<std::size_t, UnorderedTermSet> table;
+  struct Slot
+  {
+    std::size_t hash;
+    Term term;  ///< null for an empty slot
+  };
+
+  /** find the slot of a term
+   *  @param t the term
+   *  @param hashval the hash of t
+   *  @return the slot holding a term equal to t, or the empty slot
+   *  where t would be inserted. Assumes the table is not empty.
+   */
+  std::size_t find_slot(const Term & t, std::size_t hashval) const;
+
+  // the first slot probed for a hash value
+  std::size_t home_slot(std::size_t hashval) const;
+
+  // rehash into a table with num_slots slots (a power of two)
+  void rehash(std::size_t num_slots);
+
+  // grow the table if inserting one more term exceeds the load factor
+  void grow_if_needed();
+
+  std::vector<Slot> slots;
+  std::size_t num_terms;
+  // log2 of the number of slots
+  unsigned int log_slots;
 };
 
 }  // namespace smt
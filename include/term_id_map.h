@@ -0,0 +1,71 @@
+/*********************                                                        */
+/*! \file term_id_map.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A map from Terms to Terms indexed by term id -- used for the
+**        cache of IdentityWalker
+**
+**
+**/
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "smt_defs.h"
+#include "term.h"
+
+namespace smt {
+
+/** \class TermIdMap
+ *  A map from Terms to Terms that stores each entry in a vector, at the
+ *  index given by the id of its key. Most backends number their terms
+ *  densely, so a lookup is an index and a compare instead of a hash.
+ *
+ *  The map falls back to an UnorderedTermMap when the ids are too sparse
+ *  for the number of entries, or when two different keys have the same
+ *  id. It goes back to the vector when cleared.
+ */
+class TermIdMap
+{
+ public:
+  TermIdMap() : dense_(true) {}
+
+  /** @param key the term to look up
+   *  @return the value of key, or nullptr if key is not in the map.
+   *  Valid until the map is modified.
+   */
+  const Term * find(const Term & key) const;
+
+  /** Maps key to val, overwriting the value if key is already in the map
+   *  @param key the key term
+   *  @param val the value term
+   */
+  void set(const Term & key, const Term & val);
+
+  /** Removes all entries, in time proportional to their number */
+  void clear();
+
+  /** @return the number of entries */
+  size_t size() const;
+
+ protected:
+  /** Moves the entries of the vector to sparse_ */
+  void make_sparse();
+
+  bool dense_;  ///< true iff the entries are in slots_
+  // slot i holds the entry whose key has id i, or null terms
+  std::vector<std::pair<Term, Term>> slots_;
+  std::vector<size_t> used_;  ///< the ids of the non-empty slots
+  UnorderedTermMap sparse_;   ///< the entries when not dense_
+};
+
+}  // namespace smt
@@ -0,0 +1,83 @@
+/*********************                                                        */
+/*! \file term_template.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A term with parameters, compiled for repeated instantiation,
+**        e.g. the body of an SMT-LIB define-fun.
+**
+**        Instantiating substitutes the parameters like
+**        AbsSmtSolver::substitute, but only rebuilds the subterms that
+**        contain a parameter, without walking the whole term or
+**        allocating a cache, and instantiations are memoized on the
+**        arguments.
+**
+**/
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "smt_defs.h"
+#include "term.h"
+
+namespace smt {
+
+// hashes a vector of terms, e.g. the arguments of an instantiation
+struct TermVecHash
+{
+  size_t operator()(const TermVec & terms) const;
+};
+
+class TermTemplate
+{
+ public:
+  /** Compiles a template
+   *  @param body the term to instantiate
+   *  @param params the parameters of body, distinct symbols
+   */
+  TermTemplate(const Term & body, const TermVec & params);
+
+  /** @return the number of parameters */
+  size_t num_params() const { return num_params_; };
+
+  /** Instantiates the template
+   *  @param solver the solver that owns the body
+   *  @param args the terms to substitute for the parameters
+   *  @return body with params[i] replaced by args[i]
+   */
+  Term instantiate(const SmtSolver & solver, const TermVec & args);
+
+ protected:
+  // a subterm that contains a parameter, to be rebuilt
+  // the children are references (see ref)
+  struct Node
+  {
+    Op op;
+    std::vector<size_t> children;
+  };
+
+  /** A reference to a term of an instantiation:
+   *  parameter r, if r < num_params_,
+   *  else nodes_[r - num_params_], if r < num_params_ + nodes_.size(),
+   *  else constants_[r - num_params_ - nodes_.size()]
+   *  @return the referenced term
+   */
+  const Term & ref(size_t r, const TermVec & args, const TermVec & built) const;
+
+  size_t num_params_;
+  std::vector<Node> nodes_;  ///< in post-order
+  TermVec constants_;        ///< subterms that contain no parameter
+  size_t result_;            ///< reference to the body
+  std::unordered_map<TermVec, Term, TermVecHash>
+      instances_;  ///< memoized instantiations
+};
+
+}  // namespace smt
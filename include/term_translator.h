@@ -19,6 +19,8 @@
 #pragma once
 
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "smt_defs.h"
 #include "solver.h"
@@ -59,6 +61,8 @@ namespace smt {
  */
 class TermTranslator
 {
+  friend class TermDagBuilder;
+
  public:
   TermTranslator(const SmtSolver & s) : solver(s)
   {
@@ -90,6 +94,12 @@ class TermTranslator
    */
   Term transfer_term(const Term & term, const SortKind sk);
 
+  /** Reserves space in the cache for the given number of terms
+   *  avoids rehashing the cache while transferring a large DAG
+   *  @param num_terms the expected number of distinct terms to transfer
+   */
+  void reserve(size_t num_terms) { cache.reserve(num_terms); };
+
   /* Returns reference to cache -- can be used to populate with symbols */
   UnorderedTermMap & get_cache() { return cache; };
 
@@ -97,6 +107,17 @@ class TermTranslator
   const SmtSolver & get_solver() { return solver; };
 
  protected:
+  // tag for the constructor used by TermDagBuilder
+  struct UncheckedSolver
+  {
+  };
+
+  /** Does not reject generic solvers. Only for building terms from
+   *  solver-neutral data (see TermDagBuilder), never from terms of another
+   *  solver.
+   */
+  TermTranslator(const SmtSolver & s, UncheckedSolver) : solver(s) {}
+
   /** Creates a term value from a string of the given sort
    *  @param val the string representation of the value
    *  @param orig_sort the sort from the original solver (transfer_sort is
@@ -104,7 +125,26 @@ class TermTranslator
    *  @return a term with the given value
    */
   Term value_from_smt2(const std::string val, const Sort sort);
-  
+
+  /** Creates a term value from a string, with an already transferred sort
+   *  @param val the string representation of the value
+   *  @param sk the SortKind of the value in the original solver
+   *  @param sort the sort of the value in this solver
+   *  @return a term with the given value
+   */
+  Term value_from_smt2(const std::string val,
+                       const SortKind sk,
+                       const Sort sort) const;
+
+  /** Creates the value term for a value of the other solver
+   *  bit-vector values are converted through BVValue, integer values that
+   *  fit in a machine integer with to_int, and everything else goes through
+   *  value_from_smt2
+   *  @param val the value term from the other solver
+   *  @return the corresponding value term of this solver
+   */
+  Term transfer_value(const Term & val);
+
   /** translates an smtlib representation of a const rational "(/ a b)"
    *  into a infix-style representation of a const rational "a / b"
    * @param smtlib is the smtlib representation
@@ -148,6 +188,14 @@ class TermTranslator
    */
   Term cast_value(const Term & term, const Sort & sort) const;
 
+  /** casts a term of this solver to a SortKind, see
+   *  transfer_term(const Term &, const SortKind)
+   *  @param transferred_term the term to cast
+   *  @param sk the expected SortKind
+   *  @return the casted term
+   */
+  Term cast_sort_kind(const Term & transferred_term, const SortKind sk) const;
+
   // Note: const meaning the solver doesn't change to a different solver
   // it can still call non-const methods of the solver
   SmtSolver solver;  ///< solver to translate terms to
@@ -156,5 +204,11 @@ class TermTranslator
   // necessary because it needs to be the same exact uninterpreted sort
   // cannot recreate it with the same name and get the same object back
   std::unordered_map<std::string, Sort> uninterpreted_sorts;
+
+  // scratch buffers for transfer_term, kept between calls to avoid
+  // reallocating them for every transferred term
+  // each stack entry holds a term and whether its children were pushed
+  std::vector<std::pair<Term, bool>> visit_stack;
+  TermVec cached_children;
 };
 }  // namespace smt
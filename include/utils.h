@@ -54,6 +54,15 @@ inline void Log(std::string msg)
 
 namespace smt {
 
+/** Combines a hash value into seed, as boost::hash_combine does
+ *  @param seed the hash computed so far, updated in place
+ *  @param value the hash to combine into seed
+ */
+inline void hash_combine(std::size_t & seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 // term helper methods
 void op_partition(smt::PrimOp o, const smt::Term & term, smt::TermVec & out);
 
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -133,8 +134,12 @@ class MsatSolver : public AbsSmtSolver
   Term make_term(Op op, const TermVec & terms) const override;
   void reset() override;
   void reset_assertions() override;
+  void interrupt() override;
   Term substitute(const Term term,
                   const UnorderedTermMap & substitution_map) const override;
+  TermVec substitute_terms(
+      const TermVec & terms,
+      const UnorderedTermMap & substitution_map) const override;
 
   void dump_smt2(std::string filename) const override;
 
@@ -176,6 +181,11 @@ class MsatSolver : public AbsSmtSolver
                                ///< complain if not called after
                                ///< check-sat-assuming).
 
+  // set by interrupt, cleared at the start of each query
+  mutable std::atomic<bool> interrupted{ false };
+  // termination test for msat_set_termination_test
+  static int terminate(void * state);
+
   // clears assumption clauses
   // needed to simulate the same check_sat_assuming interface as other solvers
   // called before a check-sat or check-sat-assuming call
@@ -202,6 +212,7 @@ class MsatSolver : public AbsSmtSolver
     if (env_uninitialized)
     {
       env = msat_create_env(cfg);
+      msat_set_termination_test(env, terminate, &interrupted);
       env_uninitialized = false;
     }
   }
@@ -228,6 +239,7 @@ class MsatSolver : public AbsSmtSolver
 
     assert(lbls.size() == m_assumps.size());
 
+    interrupted = false;
     msat_result mres =
         msat_solve_with_assumptions(env, lbls.data(), lbls.size());
 
@@ -282,6 +294,7 @@ class MsatInterpolatingSolver : public MsatSolver
       // TODO: decide if we should add this
       // msat_set_option(cfg, "theory.eq_propagation", "false");
       env = msat_create_env(cfg);
+      msat_set_termination_test(env, terminate, &interrupted);
       env_uninitialized = false;
     }
   }
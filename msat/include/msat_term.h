@@ -76,6 +76,7 @@ class MsatTerm : public AbsTerm
   bool is_value() const override;
   virtual std::string to_string() override;
   uint64_t to_int() const override;
+  BVValue to_bv_value() override;
   /** Iterators for traversing the children
    */
   TermIter begin() override;
@@ -195,6 +195,7 @@ Result MsatSolver::check_sat()
   initialize_env();
   last_query_assuming = false;
   clear_assumption_clauses();
+  interrupted = false;
   msat_result mres = msat_solve(env);
 
   if (mres == MSAT_SAT)
@@ -1137,6 +1138,14 @@ void MsatSolver::reset()
 
   cfg = msat_create_config();
   env = msat_create_env(cfg);
+  msat_set_termination_test(env, terminate, &interrupted);
+}
+
+void MsatSolver::interrupt() { interrupted = true; }
+
+int MsatSolver::terminate(void * state)
+{
+  return static_cast<std::atomic<bool> *>(state)->load();
 }
 
 void MsatSolver::reset_assertions()
@@ -1148,19 +1157,26 @@ void MsatSolver::reset_assertions()
 
 Term MsatSolver::substitute(const Term term,
                             const UnorderedTermMap & substitution_map) const
+{
+  return substitute_terms({ term }, substitution_map)[0];
+}
+
+TermVec MsatSolver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
 {
   initialize_env();
-  shared_ptr<MsatTerm> mterm = static_pointer_cast<MsatTerm>(term);
 
   vector<msat_term> to_subst;
   vector<msat_term> values;
+  to_subst.reserve(substitution_map.size());
+  values.reserve(substitution_map.size());
 
   shared_ptr<MsatTerm> tmp_key;
   shared_ptr<MsatTerm> tmp_val;
   // TODO: Fallback to parent class implementation if there are uninterpreted
   // functions
   //       in the map
-  for (auto elem : substitution_map)
+  for (const auto & elem : substitution_map)
   {
     tmp_key = static_pointer_cast<MsatTerm>(elem.first);
     if (tmp_key->is_uf)
@@ -1178,12 +1194,17 @@ Term MsatSolver::substitute(const Term term,
     values.push_back(tmp_val->term);
   }
 
-  // TODO: add guarded assertion in debug mode about size of vectors
-
-  msat_term res = msat_apply_substitution(
-      env, mterm->term, to_subst.size(), &to_subst[0], &values[0]);
-
-  return Term(new MsatTerm(env, res));
+  // the arrays are converted once and reused for each term
+  TermVec res;
+  res.reserve(terms.size());
+  for (const Term & term : terms)
+  {
+    shared_ptr<MsatTerm> mterm = static_pointer_cast<MsatTerm>(term);
+    msat_term r = msat_apply_substitution(
+        env, mterm->term, to_subst.size(), to_subst.data(), values.data());
+    res.push_back(Term(new MsatTerm(env, r)));
+  }
+  return res;
 }
 
 void MsatSolver::dump_smt2(std::string filename) const
@@ -1287,6 +1308,7 @@ Result MsatInterpolatingSolver::get_interpolant(const Term & A,
   msat_set_itp_group(env, group_B);
   msat_assert_formula(env, mB);
 
+  interrupted = false;
   msat_result res = msat_solve(env);
 
   if (res == MSAT_UNSAT)
@@ -1330,6 +1352,7 @@ Result MsatInterpolatingSolver::get_sequence_interpolants(
                         static_pointer_cast<MsatTerm>(formulae.at(k))->term);
   }
 
+  interrupted = false;
   msat_result msat_res = msat_solve(env);
 
   if (msat_res == MSAT_SAT)
@@ -595,6 +595,37 @@ uint64_t MsatTerm::to_int() const
   }
 }
 
+BVValue MsatTerm::to_bv_value()
+{
+  size_t width;
+  if (!msat_term_is_number(env, term)
+      || !msat_is_bv_type(env, msat_term_get_type(term), &width))
+  {
+    std::string msg = to_string();
+    msg += " is not a bit-vector constant.";
+    throw IncorrectUsageException(msg.c_str());
+  }
+
+  mpq_t num;
+  mpq_init(num);
+  if (msat_term_to_number(env, term, num))
+  {
+    mpq_clear(num);
+    throw InternalSolverException("Failed to get the value of "
+                                  + to_string());
+  }
+
+  // bit-vector numbers are non-negative integers
+  BVValue res(width);
+  mpz_ptr z = mpq_numref(num);
+  for (size_t i = 0; i < width; ++i)
+  {
+    res.set_bit(i, mpz_tstbit(z, i));
+  }
+  mpq_clear(num);
+  return res;
+}
+
 TermIter MsatTerm::begin() { return TermIter(new MsatTermIter(env, term, 0)); }
 
 TermIter MsatTerm::end()
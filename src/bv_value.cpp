@@ -0,0 +1,268 @@
+/*********************                                                        */
+/*! \file bv_value.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-neutral representation of bit-vector values.
+**
+**/
+
+#include "bv_value.h"
+
+#include <algorithm>
+#include <ostream>
+
+#include "exceptions.h"
+
+using namespace std;
+
+namespace smt {
+
+// number of 64-bit words needed for the given width
+static inline size_t num_words(uint64_t width) { return (width + 63) / 64; }
+
+// value of a digit in base 2, 10 or 16, or -1 if it is not one
+static inline int digit_value(char c, uint64_t base)
+{
+  int d = -1;
+  if (c >= '0' && c <= '9')
+  {
+    d = c - '0';
+  }
+  else if (c >= 'a' && c <= 'f')
+  {
+    d = c - 'a' + 10;
+  }
+  else if (c >= 'A' && c <= 'F')
+  {
+    d = c - 'A' + 10;
+  }
+  return d < (int)base ? d : -1;
+}
+
+BVValue::BVValue(uint64_t width) : width(width), words(num_words(width), 0) {}
+
+BVValue::BVValue(uint64_t width, uint64_t val)
+    : width(width), words(num_words(width), 0)
+{
+  if (width)
+  {
+    words[0] = width < 64 ? val & ((1ull << width) - 1) : val;
+  }
+}
+
+BVValue::BVValue(const string & digits, uint64_t width, uint64_t base)
+    : width(width), words(num_words(width), 0)
+{
+  if (digits.empty())
+  {
+    throw IncorrectUsageException("Can't read an empty bit-vector value");
+  }
+
+  if (base == 2 || base == 16)
+  {
+    // each digit maps to a fixed group of bits -- linear in the width
+    uint64_t bits_per_digit = base == 2 ? 1 : 4;
+    uint64_t pos = 0;
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it)
+    {
+      int d = digit_value(*it, base);
+      if (d < 0)
+      {
+        throw IncorrectUsageException("Can't read " + digits + " in base "
+                                      + std::to_string(base));
+      }
+      for (uint64_t j = 0; j < bits_per_digit; ++j, ++pos)
+      {
+        if ((d >> j) & 1)
+        {
+          if (pos >= width)
+          {
+            throw IncorrectUsageException(digits + " does not fit in "
+                                          + std::to_string(width) + " bits");
+          }
+          words[pos / 64] |= 1ull << (pos % 64);
+        }
+      }
+    }
+  }
+  else if (base == 10)
+  {
+    // schoolbook: multiply by 10 and add the digit
+    for (char c : digits)
+    {
+      int d = digit_value(c, base);
+      if (d < 0)
+      {
+        throw IncorrectUsageException("Can't read " + digits + " in base 10");
+      }
+      unsigned __int128 carry = d;
+      for (uint64_t & w : words)
+      {
+        unsigned __int128 cur = (unsigned __int128)w * 10 + carry;
+        w = (uint64_t)cur;
+        carry = cur >> 64;
+      }
+      if (carry || (width % 64 && words.back() >> (width % 64)))
+      {
+        throw IncorrectUsageException(digits + " does not fit in "
+                                      + std::to_string(width) + " bits");
+      }
+    }
+  }
+  else
+  {
+    throw IncorrectUsageException("Unsupported base " + std::to_string(base));
+  }
+}
+
+BVValue BVValue::from_smt2(const string & repr, uint64_t width)
+{
+  string prefix = repr.substr(0, 2);
+  if (prefix == "#b" || prefix == "0b")
+  {
+    return BVValue(repr.substr(2), width, 2);
+  }
+  else if (prefix == "#x")
+  {
+    return BVValue(repr.substr(2), width, 16);
+  }
+  else if (repr.substr(0, 5) == "(_ bv")
+  {
+    size_t end = repr.find(' ', 5);
+    if (end == string::npos)
+    {
+      throw IncorrectUsageException("Can't read " + repr
+                                    + " as a bit-vector value");
+    }
+    return BVValue(repr.substr(5, end - 5), width, 10);
+  }
+  // some solvers print 1-bit values as booleans
+  else if (width == 1 && (repr == "true" || repr == "false"))
+  {
+    return BVValue(1, repr == "true");
+  }
+  throw IncorrectUsageException("Can't read " + repr
+                                + " as a bit-vector value");
+}
+
+BVValue BVValue::from_words(uint64_t width, const uint64_t * words)
+{
+  BVValue res(width);
+  copy(words, words + res.words.size(), res.words.begin());
+  if (width % 64)
+  {
+    res.words.back() &= (1ull << (width % 64)) - 1;
+  }
+  return res;
+}
+
+bool BVValue::get_bit(uint64_t i) const
+{
+  if (i >= width)
+  {
+    throw IncorrectUsageException("Bit index " + std::to_string(i)
+                                  + " out of range for width "
+                                  + std::to_string(width));
+  }
+  return (words[i / 64] >> (i % 64)) & 1;
+}
+
+void BVValue::set_bit(uint64_t i, bool b)
+{
+  if (i >= width)
+  {
+    throw IncorrectUsageException("Bit index " + std::to_string(i)
+                                  + " out of range for width "
+                                  + std::to_string(width));
+  }
+  if (b)
+  {
+    words[i / 64] |= 1ull << (i % 64);
+  }
+  else
+  {
+    words[i / 64] &= ~(1ull << (i % 64));
+  }
+}
+
+bool BVValue::fits_uint64() const
+{
+  return all_of(words.begin() + min<size_t>(words.size(), 1),
+                words.end(),
+                [](uint64_t w) { return w == 0; });
+}
+
+uint64_t BVValue::to_uint64() const
+{
+  if (!fits_uint64())
+  {
+    throw IncorrectUsageException(
+        "Can't represent a bit-vector of size " + std::to_string(width)
+        + " with value " + to_decimal_string() + " in a uint64_t");
+  }
+  return words.empty() ? 0 : words[0];
+}
+
+string BVValue::to_binary_string() const
+{
+  string res(width, '0');
+  for (uint64_t i = 0; i < width; ++i)
+  {
+    if ((words[i / 64] >> (i % 64)) & 1)
+    {
+      res[width - 1 - i] = '1';
+    }
+  }
+  return res;
+}
+
+string BVValue::to_decimal_string() const
+{
+  // repeated division by 10^19, the largest power of 10 in a uint64_t
+  const uint64_t chunk = 10000000000000000000ull;
+  vector<uint64_t> n(words);
+  string res;
+  while (any_of(n.begin(), n.end(), [](uint64_t w) { return w != 0; }))
+  {
+    unsigned __int128 rem = 0;
+    for (auto it = n.rbegin(); it != n.rend(); ++it)
+    {
+      unsigned __int128 cur = (rem << 64) | *it;
+      *it = (uint64_t)(cur / chunk);
+      rem = cur % chunk;
+    }
+    uint64_t r = (uint64_t)rem;
+    bool last = none_of(n.begin(), n.end(), [](uint64_t w) { return w != 0; });
+    for (int i = 0; i < 19 && (!last || r); ++i)
+    {
+      res.push_back('0' + r % 10);
+      r /= 10;
+    }
+  }
+  if (res.empty())
+  {
+    res = "0";
+  }
+  reverse(res.begin(), res.end());
+  return res;
+}
+
+bool BVValue::operator==(const BVValue & other) const
+{
+  return width == other.width && words == other.words;
+}
+
+std::ostream & operator<<(std::ostream & output, const BVValue & v)
+{
+  output << "#b" << v.to_binary_string();
+  return output;
+}
+
+}  // namespace smt
@@ -0,0 +1,367 @@
+/*********************                                                        */
+/*! \file cube_and_conquer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Splits a problem into cubes and solves them in parallel.
+**
+**/
+
+#include "cube_and_conquer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+
+namespace smt {
+
+// how often workers that are not done yet are interrupted again
+// (an interrupt before a query starts has no effect)
+static const chrono::milliseconds INTERRUPT_PERIOD(10);
+
+CubeAndConquer::CubeAndConquer(const SmtSolver & src,
+                               vector<SmtSolver> wrkrs)
+    : source(src),
+      workers(std::move(wrkrs)),
+      num_transferred(workers.size(), 0),
+      split_symbols(workers.size()),
+      worker_literals(workers.size()),
+      next_cube(0),
+      num_cubes(0),
+      winner(workers.size()),
+      sat_cube(0),
+      num_refuted(0),
+      num_running(0)
+{
+  if (workers.empty())
+  {
+    throw IncorrectUsageException("CubeAndConquer needs at least one worker");
+  }
+  for (const SmtSolver & w : workers)
+  {
+    w->set_opt("incremental", "true");
+    translators.emplace_back(w);
+  }
+}
+
+void CubeAndConquer::assert_formula(const Term & t) { assertions.push_back(t); }
+
+TermVec CubeAndConquer::choose_split_literals(size_t k) const
+{
+  // number of distinct subterms each symbol is a child of,
+  // the symbols in the order they are found
+  unordered_map<Term, size_t> num_parents;
+  TermVec bool_symbols;
+  TermVec bv_symbols;
+
+  UnorderedTermSet visited;
+  TermVec to_visit = assertions;
+  while (to_visit.size())
+  {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(t).second)
+    {
+      continue;
+    }
+
+    for (const Term & c : t)
+    {
+      to_visit.push_back(c);
+      if (!c->is_symbol())
+      {
+        continue;
+      }
+      SortKind sk = c->get_sort()->get_sort_kind();
+      if (sk != BOOL && sk != BV)
+      {
+        continue;
+      }
+      auto it = num_parents.find(c);
+      if (it == num_parents.end())
+      {
+        num_parents[c] = 1;
+        (sk == BOOL ? bool_symbols : bv_symbols).push_back(c);
+      }
+      else
+      {
+        ++it->second;
+      }
+    }
+
+    // a symbol asserted on its own
+    if (t->is_symbol() && t->get_sort()->get_sort_kind() == BOOL
+        && num_parents.find(t) == num_parents.end())
+    {
+      num_parents[t] = 0;
+      bool_symbols.push_back(t);
+    }
+  }
+
+  auto by_parents = [&num_parents](const Term & a, const Term & b) {
+    return num_parents.at(a) > num_parents.at(b);
+  };
+  stable_sort(bool_symbols.begin(), bool_symbols.end(), by_parents);
+  stable_sort(bv_symbols.begin(), bv_symbols.end(), by_parents);
+
+  TermVec res;
+  for (const Term & b : bool_symbols)
+  {
+    if (res.size() == k)
+    {
+      return res;
+    }
+    res.push_back(b);
+  }
+
+  Term one = source->make_term(1, source->make_sort(BV, 1));
+  for (uint64_t offset = 0; res.size() < k; ++offset)
+  {
+    bool added = false;
+    for (const Term & v : bv_symbols)
+    {
+      uint64_t width = v->get_sort()->get_width();
+      if (offset >= width || res.size() == k)
+      {
+        continue;
+      }
+      uint64_t bit = width - 1 - offset;
+      Term ext = source->make_term(Op(Extract, bit, bit), v);
+      res.push_back(source->make_term(Equal, ext, one));
+      added = true;
+    }
+    if (!added)
+    {
+      break;
+    }
+  }
+  return res;
+}
+
+Result CubeAndConquer::check_sat_cubes(const TermVec & lits)
+{
+  // cube indices are bit masks
+  if (lits.size() >= 64)
+  {
+    throw IncorrectUsageException(
+        "CubeAndConquer supports at most 63 splitting literals");
+  }
+
+  literals = lits;
+  num_cubes = uint64_t(1) << literals.size();
+  next_cube = 0;
+  // the source terms are only read from this thread
+  for (size_t i = 0; i < workers.size(); ++i)
+  {
+    setup_worker(i);
+  }
+
+  size_t n = workers.size();
+  winner = n;
+  sat_cube = 0;
+  num_refuted = 0;
+  num_running = n;
+  errors.assign(n, nullptr);
+
+  vector<thread> threads;
+  for (size_t i = 0; i < n; ++i)
+  {
+    threads.emplace_back(&CubeAndConquer::run_worker, this, i);
+  }
+
+  unique_lock<mutex> lk(m);
+  cv.wait(lk, [this, n] { return winner != n || !num_running; });
+
+  // interrupt the other workers until they are done
+  // except the ones that cannot be interrupted
+  vector<bool> uninterruptible(n, false);
+  while (num_running)
+  {
+    lk.unlock();
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (i == winner || uninterruptible[i])
+      {
+        continue;
+      }
+      try
+      {
+        workers[i]->interrupt();
+      }
+      catch (NotImplementedException & e)
+      {
+        uninterruptible[i] = true;
+      }
+    }
+    lk.lock();
+    cv.wait_for(lk, INTERRUPT_PERIOD, [this] { return !num_running; });
+  }
+  lk.unlock();
+
+  for (thread & t : threads)
+  {
+    t.join();
+  }
+
+  if (winner != n)
+  {
+    return Result(SAT);
+  }
+  if (num_refuted == num_cubes)
+  {
+    return Result(UNSAT);
+  }
+  for (const exception_ptr & e : errors)
+  {
+    if (e)
+    {
+      rethrow_exception(e);
+    }
+  }
+  return Result(UNKNOWN, "Some cubes could not be solved.");
+}
+
+Result CubeAndConquer::check_sat(size_t k)
+{
+  return check_sat_cubes(choose_split_literals(k));
+}
+
+TermVec CubeAndConquer::get_sat_cube() const
+{
+  if (winner == workers.size())
+  {
+    throw IncorrectUsageException("The last cube and conquer check was not sat");
+  }
+  TermVec res;
+  for (size_t j = 0; j < literals.size(); ++j)
+  {
+    bool positive = (sat_cube >> j) & 1;
+    res.push_back(positive ? literals[j]
+                           : source->make_term(Not, literals[j]));
+  }
+  return res;
+}
+
+Term CubeAndConquer::get_value(const Term & t)
+{
+  if (winner == workers.size())
+  {
+    throw IncorrectUsageException("The last cube and conquer check was not sat");
+  }
+  Term val = workers[winner]->get_value(translators[winner].transfer_term(t));
+  TermTranslator to_source(source);
+  return to_source.transfer_term(val, t->get_sort()->get_sort_kind());
+}
+
+void CubeAndConquer::setup_worker(size_t i)
+{
+  const SmtSolver & w = workers[i];
+  TermTranslator & tt = translators[i];
+  for (size_t & j = num_transferred[i]; j < assertions.size(); ++j)
+  {
+    w->assert_formula(tt.transfer_term(assertions[j], BOOL));
+  }
+
+  // assumptions must be symbols in some solvers, so each literal gets a
+  // fresh symbol that is equal to it
+  UnorderedTermMap & syms = split_symbols[i];
+  TermVec & wlits = worker_literals[i];
+  wlits.clear();
+  for (const Term & l : literals)
+  {
+    auto it = syms.find(l);
+    if (it == syms.end())
+    {
+      Term sym = w->make_symbol("cube_split_" + std::to_string(syms.size()),
+                                w->make_sort(BOOL));
+      w->assert_formula(
+          w->make_term(Equal, sym, tt.transfer_term(l, BOOL)));
+      it = syms.emplace(l, sym).first;
+    }
+    wlits.push_back(it->second);
+  }
+}
+
+void CubeAndConquer::run_worker(size_t i)
+{
+  const SmtSolver & w = workers[i];
+  size_t n = workers.size();
+  while (true)
+  {
+    {
+      lock_guard<mutex> lk(m);
+      if (winner != n)
+      {
+        break;
+      }
+    }
+
+    uint64_t cube = next_cube++;
+    if (cube >= num_cubes)
+    {
+      break;
+    }
+
+    Result r;
+    exception_ptr error;
+    try
+    {
+      r = literals.empty() ? w->check_sat()
+                           : w->check_sat_assuming(cube_assumptions(i, cube));
+    }
+    catch (...)
+    {
+      error = current_exception();
+    }
+
+    lock_guard<mutex> lk(m);
+    if (error)
+    {
+      // the cube is not solved, stop using this worker
+      errors[i] = error;
+      break;
+    }
+    else if (r.is_sat())
+    {
+      if (winner == n)
+      {
+        winner = i;
+        sat_cube = cube;
+      }
+      break;
+    }
+    else if (r.is_unsat())
+    {
+      ++num_refuted;
+    }
+  }
+
+  lock_guard<mutex> lk(m);
+  --num_running;
+  cv.notify_all();
+}
+
+TermVec CubeAndConquer::cube_assumptions(size_t i, uint64_t cube) const
+{
+  const SmtSolver & w = workers[i];
+  const TermVec & wlits = worker_literals[i];
+  TermVec res;
+  res.reserve(wlits.size());
+  for (size_t j = 0; j < wlits.size(); ++j)
+  {
+    bool positive = (cube >> j) & 1;
+    res.push_back(positive ? wlits[j] : w->make_term(Not, wlits[j]));
+  }
+  return res;
+}
+
+}  // namespace smt
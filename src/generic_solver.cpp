@@ -23,7 +23,9 @@
 
 #include "generic_solver.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdio.h>
@@ -34,6 +36,8 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cctype>
+#include <functional>
 
 #include "assert.h"
 #include "smtlib_utils.h"
@@ -45,9 +49,111 @@ using namespace std;
 
 namespace smt {
 
+// when pipelining, the queue is flushed once it holds this many bytes
+const size_t PIPELINE_MAX_PENDING_BYTES = 1 << 20;
+
 // helper functions
 bool is_new_line(char c) { return (c == '\n' || c == '\r' || c == 0); }
 
+// splits an s-expression into its tokens: parentheses and atoms.
+// Quoted symbols and string literals are single atoms.
+// The tokens point into str, which must outlive them.
+vector<string_view> tokenize_sexpr(string_view str)
+{
+  vector<string_view> tokens;
+  size_t i = 0;
+  while (i < str.size())
+  {
+    char c = str[i];
+    if (isspace(c) || c == 0)
+    {
+      i++;
+      continue;
+    }
+    size_t begin = i;
+    if (c == '(' || c == ')')
+    {
+      i++;
+    }
+    else if (c == '|')
+    {
+      i = str.find('|', i + 1);
+      i = (i == string_view::npos) ? str.size() : i + 1;
+    }
+    else if (c == '"')
+    {
+      // "" is an escaped quote inside a string literal
+      i++;
+      while (i < str.size())
+      {
+        if (str[i] != '"')
+        {
+          i++;
+        }
+        else if (i + 1 < str.size() && str[i + 1] == '"')
+        {
+          i += 2;
+        }
+        else
+        {
+          i++;
+          break;
+        }
+      }
+    }
+    else
+    {
+      while (i < str.size() && !isspace(str[i]) && str[i] != '('
+             && str[i] != ')')
+      {
+        i++;
+      }
+    }
+    tokens.push_back(str.substr(begin, i - begin));
+  }
+  return tokens;
+}
+
+// returns the index right after the s-expression
+// that starts at tokens[begin]
+size_t skip_sexpr(const vector<string_view> & tokens, size_t begin)
+{
+  if (begin >= tokens.size() || tokens[begin] != "(")
+  {
+    return begin + 1;
+  }
+  int depth = 0;
+  size_t i = begin;
+  do
+  {
+    if (tokens[i] == "(")
+    {
+      depth++;
+    }
+    else if (tokens[i] == ")")
+    {
+      depth--;
+    }
+    i++;
+  } while (depth > 0 && i < tokens.size());
+  return i;
+}
+
+// prints tokens[begin..end) with single spaces between atoms
+string join_tokens(const vector<string_view> & tokens, size_t begin, size_t end)
+{
+  string result;
+  for (size_t i = begin; i < end && i < tokens.size(); i++)
+  {
+    if (!result.empty() && result.back() != '(' && tokens[i] != ")")
+    {
+      result += ' ';
+    }
+    result += tokens[i];
+  }
+  return result;
+}
+
 // from: https://stackoverflow.com/a/36000453/1364765
 std::string & trim(std::string & str)
 {
@@ -64,21 +170,55 @@ std::string & trim(std::string & str)
   return str;
 }
 
+size_t GenericTermKeyHash::operator()(const GenericTermKey & key) const
+{
+  size_t result = std::hash<PrimOp>()(key.op.prim_op);
+  hash_combine(result, key.op.num_idx);
+  if (key.op.num_idx > 0)
+  {
+    hash_combine(result, key.op.idx0);
+  }
+  if (key.op.num_idx > 1)
+  {
+    hash_combine(result, key.op.idx1);
+  }
+  for (size_t id : key.child_ids)
+  {
+    hash_combine(result, id);
+  }
+  return result;
+}
+
 // class methods implementation
 GenericSolver::GenericSolver(string path,
                              vector<string> cmd_line_args,
                              unsigned int write_buf_size,
-                             unsigned int read_buf_size)
+                             unsigned int read_buf_size,
+                             bool pipelined,
+                             bool restartable)
     : AbsSmtSolver(SolverEnum::GENERIC_SOLVER),
       path(path),
       cmd_line_args(cmd_line_args),
       write_buf_size(write_buf_size),
       read_buf_size(read_buf_size),
+      pipelined(pipelined),
+      restartable(restartable),
+      out_begin(0),
+      scan_pos(0),
+      scan_depth(0),
+      scan_quote(0),
+      scan_started(false),
+      scan_done(false),
+      async_query(0),
+      async_counter(0),
+      async_has_deadline(false),
       context_level_(0),
       name_sort_map(new unordered_map<string, Sort>()),
       sort_name_map(new unordered_map<Sort, string>()),
       name_term_map(new unordered_map<string, Term>()),
       term_name_map(new unordered_map<Term, string>()),
+      op_term_table(
+          new unordered_map<GenericTermKey, Term, GenericTermKeyHash>()),
       name_datatype_map(
           new unordered_map<string, std::shared_ptr<GenericDatatype>>()),
       datatype_name_map(
@@ -96,35 +236,24 @@ GenericSolver::GenericSolver(string path,
     throw IncorrectUsageException(msg);
   }
   term_counter = new unsigned int;
-  //allocate memory for the buffers
-  write_buf = new char[write_buf_size];
-  read_buf = new char[read_buf_size];
-
-  // sure allocation was successful
-  assert(write_buf != NULL);
-  assert(read_buf != NULL);
-  //initialize write_buf
-  for (int i=0; i < write_buf_size; i++) {
-    write_buf[i]=0;
-  }
-  //initialize read_buf
-  for (int i=0; i < read_buf_size; i++) {
-    read_buf[i]=0;
-  }
   // start the process with the solver binary
   start_solver();
 }
 
 GenericSolver::~GenericSolver() {
-  //deallocate the buffers memory
-  delete write_buf;
-  delete read_buf;
   delete term_counter;
   // close the solver process
   close_solver();
 }
 
-void GenericSolver::start_solver() {
+void GenericSolver::start_solver()
+{
+  launch_process();
+  set_opt("print-success", "true");
+}
+
+void GenericSolver::launch_process()
+{
   pid = 0;
 
   pipe(inpipefd);
@@ -164,115 +293,203 @@ void GenericSolver::start_solver() {
   // close unused pipe ends
   close(outpipefd[0]);
   close(inpipefd[1]);
-  set_opt("print-success", "true");
+}
+
+void GenericSolver::restart_solver()
+{
+  close_solver();
+  // drop everything that belongs to the old process
+  out_buf.clear();
+  out_begin = 0;
+  scan_pos = 0;
+  scan_depth = 0;
+  scan_quote = 0;
+  scan_started = false;
+  scan_done = false;
+  pending_cmds.clear();
+  pending_offsets.clear();
+  pending_global.clear();
+
+  launch_process();
+  // the commands are recorded again as they succeed.
+  // The first one sets print-success.
+  vector<string> cmds;
+  cmds.swap(replay_cmds);
+  for (const string & cmd : cmds)
+  {
+    pending_offsets.push_back(pending_cmds.size());
+    pending_global.push_back(false);
+    pending_cmds += cmd;
+  }
+  flush_pending_commands();
 }
 
 void GenericSolver::write_internal(string str) const
 {
   // track how many charas were written so far
-  unsigned int written_chars = 0;
+  size_t written_chars = 0;
   // continue writing  until entire str was written
   while (written_chars < str.size())
   {
-    // how many characters are there left to write
-    unsigned int remaining = str.size() - written_chars;
     // how many characters are we writing in this iteration
-    unsigned int substr_size;
-    if (remaining < write_buf_size)
-    {
-      substr_size = remaining;
-    }
-    else
+    size_t substr_size =
+        std::min<size_t>(str.size() - written_chars, write_buf_size);
+    // write
+    ssize_t just_written =
+        write(outpipefd[1], str.data() + written_chars, substr_size);
+    if (just_written < 0)
     {
-      substr_size = write_buf_size;
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw InternalSolverException("Failed writing to the solver process");
     }
-    // write
-    strcpy(write_buf, str.substr(written_chars, substr_size).c_str());
-    write(outpipefd[1], write_buf, substr_size);
-    written_chars += substr_size;
+    written_chars += just_written;
   }
 }
 
-bool GenericSolver::is_done(int just_read, std::string result) const
+bool GenericSolver::scan_response() const
 {
-  bool done = false;
-  int count = 0;
-  // if we didn't read anything now, the command is done executing
-  if (just_read == 0)
+  if (scan_done)
   {
-    done = true;
+    return true;
   }
-  else if (result[0] == '(')
+  while (scan_pos < out_buf.size())
   {
-    // if the output of the solver starts with '('
-    // we will be done only when we see the matching ')'
-    for (int i = 0; i < result.size(); i++)
+    char c = out_buf[scan_pos++];
+    if (scan_quote)
     {
-      if (result[i] == '(')
-      {
-        count++;
-      }
-      else if (result[i] == ')')
+      // parentheses and newlines inside quoted symbols and
+      // string literals do not count. An escaped "" in a string
+      // literal just closes and reopens it.
+      if (c == scan_quote)
       {
-        count--;
+        scan_quote = 0;
       }
     }
-    done = (count == 0) && is_new_line(result[result.size() - 1]);
-  }
-  else
-  {
-    // if the output of the solver does not start with '('
-    // we will be done when we reach a newline character
-    assert(just_read <= read_buf_size);
-    for (int i = 0; i < just_read; i++)
+    else if (!scan_started && isspace(c))
+    {
+      // skip whitespace left over from the previous response
+      out_begin = scan_pos;
+    }
+    else if (c == '|' || c == '"')
+    {
+      scan_started = true;
+      scan_quote = c;
+    }
+    else if (c == '(')
+    {
+      scan_started = true;
+      scan_depth++;
+    }
+    else if (c == ')')
+    {
+      scan_depth--;
+    }
+    else if (is_new_line(c))
     {
-      if (is_new_line(read_buf[i]))
+      // a response ends with a newline outside of any parentheses,
+      // e.g., `success` or `((x 1))` (possibly spanning several lines)
+      if (scan_depth <= 0)
       {
-        done = true;
+        scan_done = true;
+        return true;
       }
     }
+    else
+    {
+      scan_started = true;
+    }
   }
-  return done;
+  return false;
+}
+
+bool GenericSolver::read_chunk() const
+{
+  ssize_t just_read;
+  do
+  {
+    // read directly to the end of the buffer
+    size_t old_size = out_buf.size();
+    out_buf.resize(old_size + read_buf_size);
+    just_read = read(inpipefd[0], &out_buf[old_size], read_buf_size);
+    out_buf.resize(old_size + std::max<ssize_t>(just_read, 0));
+  } while (just_read < 0 && errno == EINTR);
+  return just_read > 0;
 }
 
 string GenericSolver::read_internal() const
 {
-  string result = "";
-  bool done = false;
-  // read to the buffer until no more output to read
-  while (!done)
+  // the output might already contain a complete response
+  // that was read together with a previous one
+  while (!scan_response())
   {
-    // read command, and how many chars were read.
-    int just_read = read(inpipefd[0], read_buf, read_buf_size);
-    // store the content and trim it
-    string read_buf_str(read_buf);
-    read_buf_str = read_buf_str.substr(0, read_buf_size);
-    result = result.append(read_buf_str);
-    done = is_done(just_read, result);
-    // clear buffer
-    for (int i = 0; i < read_buf_size; i++)
+    // if we didn't read anything now, the command is done executing
+    if (!read_chunk())
     {
-      read_buf[i] = 0;
+      scan_pos = out_buf.size();
+      break;
     }
   }
-  // normalize outout of solver:
-  // - no newlines in the middle of the content
-  // - no double spaces
-  while (result.find("\n") != string::npos)
+  return take_response();
+}
+
+string GenericSolver::take_response() const
+{
+  string result = out_buf.substr(out_begin, scan_pos - out_begin);
+
+  // start scanning the next response
+  out_begin = scan_pos;
+  scan_depth = 0;
+  scan_quote = 0;
+  scan_started = false;
+  scan_done = false;
+  // reclaim the consumed prefix of the buffer once it dominates,
+  // so that the cost is amortized over the consumed responses
+  if (out_begin == out_buf.size())
   {
-    result.replace(result.find("\n"), 1, " ");
+    out_buf.clear();
+    out_begin = 0;
+    scan_pos = 0;
   }
-  while (result.find("  ") != string::npos)
+  else if (out_begin > out_buf.size() / 2)
   {
-    result.replace(result.find("  "), 2, " ");
+    out_buf.erase(0, out_begin);
+    scan_pos -= out_begin;
+    out_begin = 0;
   }
   return result;
 }
 
 string GenericSolver::run_command(string cmd, bool verify_success_flag) const
 {
+  if (async_query)
+  {
+    throw IncorrectUsageException(
+        "A check-sat query is still running in the solver. Get its result "
+        "or cancel it first.");
+  }
   // adding a newline to simulate an "enter" hit.
   cmd = cmd + "\n";
+  // in pipelined mode, commands that only answer `success`
+  // are queued and verified together later
+  if (pipelined && verify_success_flag)
+  {
+    // the queue is flushed before it grows further, so that cmd
+    // is still queued when this returns
+    if (pending_cmds.size() >= PIPELINE_MAX_PENDING_BYTES)
+    {
+      flush_pending_commands();
+    }
+    pending_offsets.push_back(pending_cmds.size());
+    pending_global.push_back(false);
+    pending_cmds += cmd;
+    return "success";
+  }
+  // everything that was queued must be processed
+  // before a command that produces a result
+  flush_pending_commands();
   // writing the cmd string to the process
   write_internal(cmd);
   // reading the result
@@ -282,10 +499,151 @@ string GenericSolver::run_command(string cmd, bool verify_success_flag) const
   if (verify_success_flag)
   {
     verify_success(result);
+    if (restartable)
+    {
+      replay_cmds.push_back(std::move(cmd));
+    }
   }
   return result;
 }
 
+void GenericSolver::flush_pending_commands() const
+{
+  if (pending_offsets.empty())
+  {
+    return;
+  }
+
+  // the binary answers while we are still writing.
+  // To avoid a deadlock where both sides block on a full pipe,
+  // we only write when the binary can take more input and
+  // read its responses whenever they are available.
+  size_t written = 0;
+  size_t num_verified = 0;
+  string failure;
+  while (num_verified < pending_offsets.size())
+  {
+    struct pollfd fds[2];
+    fds[0].fd = inpipefd[0];
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = outpipefd[1];
+    fds[1].events = POLLOUT;
+    fds[1].revents = 0;
+    // only wait for the input pipe if there is something left to write
+    nfds_t nfds = (written < pending_cmds.size()) ? 2 : 1;
+    // responses that were already read together with previous ones
+    // do not show up in poll
+    bool buffered = scan_response();
+    if (poll(fds, nfds, buffered ? 0 : -1) < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      string msg = string("Failed polling the solver process: ")
+                   + strerror(errno);
+      pending_cmds.clear();
+      pending_offsets.clear();
+      pending_global.clear();
+      throw InternalSolverException(msg);
+    }
+
+    if (nfds == 2 && (fds[1].revents & POLLOUT))
+    {
+      // a write of at most PIPE_BUF bytes does not block
+      // once the pipe reports it is writable
+      size_t chunk = std::min<size_t>(PIPE_BUF, pending_cmds.size() - written);
+      ssize_t just_written =
+          write(outpipefd[1], pending_cmds.data() + written, chunk);
+      if (just_written > 0)
+      {
+        written += just_written;
+      }
+    }
+    else if (nfds == 2 && (fds[1].revents & (POLLERR | POLLHUP)))
+    {
+      failure = "the solver process closed its input";
+      break;
+    }
+
+    if (buffered || (fds[0].revents & (POLLIN | POLLHUP)))
+    {
+      // consume every response that is complete by now
+      bool terminated = false;
+      do
+      {
+        string result = read_internal();
+        result = trim(result);
+        size_t begin = pending_offsets[num_verified];
+        size_t end = (num_verified + 1 < pending_offsets.size())
+                         ? pending_offsets[num_verified + 1]
+                         : pending_cmds.size();
+        if (result == "success")
+        {
+          if (restartable)
+          {
+            replay_cmds.push_back(pending_cmds.substr(begin, end - begin));
+          }
+          if (pending_global[num_verified])
+          {
+            // without the newline added by run_command
+            global_cmds.push_back(
+                pending_cmds.substr(begin, end - begin - 1));
+          }
+        }
+        else if (failure.empty())
+        {
+          // remember the first failing command, but keep
+          // consuming responses to keep the pipe in sync
+          string cmd = pending_cmds.substr(begin, end - begin);
+          failure = "The command " + trim(cmd)
+                    + " did not end with a success message from the solver. "
+                      "The result was: "
+                    + result;
+        }
+        num_verified++;
+        if (result.empty())
+        {
+          // the binary terminated
+          if (failure.empty())
+          {
+            failure = "The solver process terminated before answering";
+          }
+          terminated = true;
+        }
+      } while (!terminated && num_verified < pending_offsets.size()
+               && scan_response());
+      if (terminated)
+      {
+        break;
+      }
+    }
+  }
+
+  pending_cmds.clear();
+  pending_offsets.clear();
+  pending_global.clear();
+  if (!failure.empty())
+  {
+    throw IncorrectUsageException(failure);
+  }
+}
+
+void GenericSolver::run_global_command(const string & cmd) const
+{
+  run_command(cmd);
+  if (pipelined)
+  {
+    // cmd is queued, and recorded when it is verified
+    pending_global.back() = true;
+  }
+  else
+  {
+    global_cmds.push_back(cmd);
+  }
+}
+
 void GenericSolver::verify_success(string result) const
 {
   if (result == "success")
@@ -304,6 +662,8 @@ void GenericSolver::verify_success(string result) const
 void GenericSolver::close_solver() {
   kill(pid, SIGKILL);
   waitpid(pid, &status, 0);
+  close(inpipefd[0]);
+  close(outpipefd[1]);
 }
 
 void GenericSolver::define_fun(std::string name,
@@ -321,75 +681,236 @@ void GenericSolver::define_fun(std::string name,
               + ")");
 }
 
+void GenericSolver::write_app(
+    const Term & term,
+    string & out,
+    const std::function<void(const Term &, string &)> & write_child) const
+{
+  shared_ptr<GenericTerm> gt = static_pointer_cast<GenericTerm>(term);
+  const Op & op = gt->op;
+  const TermVec & children = gt->children;
+  bool nullary_constructor = false;
+  if (op == Apply_Constructor)
+  {
+    shared_ptr<GenericDatatype> dt = static_pointer_cast<GenericDatatype>(
+        (gt->get_sort())->get_datatype());
+    nullary_constructor =
+        dt->get_num_selectors((*term_name_map)[children[0]]);
+    if (nullary_constructor)
+    {
+      out += "(";
+    }
+  }
+  else if (op == Apply_Tester)
+  {
+    out += "((_ is ";
+    write_child(children[0], out);
+    out += ") ";
+    write_child(children[1], out);
+    out += ")";
+    return;
+  }
+  else
+  {
+    out += "(";
+  }
+  // The Apply operator is ignored and the
+  // function being applied is used instead.
+  if (op.prim_op != Apply && op.prim_op != Apply_Constructor
+      && op.prim_op != Apply_Selector)
+  {
+    out += op.to_string();
+  }
+  // For quantifiers we separate the bound variables list
+  // and the formula body.
+  if (op.prim_op == Forall || op.prim_op == Exists)
+  {
+    out += " (";
+    for (size_t i = 0; i + 1 < children.size(); ++i)
+    {
+      out += "(" + (*term_name_map)[children[i]] + " "
+             + (*sort_name_map)[children[i]->get_sort()] + ")";
+    }
+    out += ") ";
+    write_child(children.back(), out);
+  }
+  else
+  {
+    // in the general case (other than quantifiers
+    // and Apply), we use ordinary
+    // s-expressions notation and write a
+    // space-separated list of arguments.
+    for (const Term & c : children)
+    {
+      out += " ";
+      write_child(c, out);
+    }
+  }
+  if (op != Apply_Constructor || nullary_constructor)
+  {
+    out += ")";
+  }
+}
+
 std::string GenericSolver::to_smtlib_def(Term term) const
 {
   // cast to generic term
   shared_ptr<GenericTerm> gt = static_pointer_cast<GenericTerm>(term);
-  bool nullary_constructor = false;
   // generic terms with no operators are represented by their
   // name.
   if (gt->get_op().is_null())
   {
     return gt->to_string();
   }
-  else
-  {
-    // generic terms with operators are written as s-expressions.
-    string result;
-    if (gt->get_op() == Apply_Constructor)
+  // generic terms with operators are written as s-expressions.
+  // Ground children and parameters are referred to by their names.
+  // The only ground terms with non-ground children are quantifiers,
+  // whose bodies are written with let bindings for shared subterms.
+  string result;
+  write_app(term, result, [this](const Term & c, string & out) {
+    shared_ptr<GenericTerm> gc = static_pointer_cast<GenericTerm>(c);
+    if (gc->is_ground() || gc->get_op().is_null())
+    {
+      out += (*term_name_map)[c];
+    }
+    else
     {
-      shared_ptr<GenericDatatype> dt = static_pointer_cast<GenericDatatype>(
-          (gt->get_sort())->get_datatype());
-      nullary_constructor =
-          dt->get_num_selectors((*term_name_map)[gt->get_children()[0]]);
-      result = nullary_constructor ? "(" : "";
+      out += to_smtlib_let_def(c);
     }
-    else if (gt->get_op() == Apply_Tester)
+  });
+  return result;
+}
+
+std::string GenericSolver::to_smtlib_let_def(const Term & term) const
+{
+  // nodes that are printed here: non-ground terms with an operator.
+  // Other terms are referred to by their names, and quantifiers
+  // are printed as a unit since their bodies are in a different scope.
+  auto is_inner = [](const Term & t) {
+    GenericTerm * gt = static_cast<GenericTerm *>(t.get());
+    return !gt->is_ground() && !gt->get_op().is_null();
+  };
+  auto is_quantifier = [](const Term & t) {
+    PrimOp po = t->get_op().prim_op;
+    return po == Forall || po == Exists;
+  };
+
+  // count the references to each node and compute a post-order
+  std::unordered_map<AbsTerm *, size_t> refs;
+  TermVec post_order;
+  TermVec to_visit({ term });
+  std::unordered_set<AbsTerm *> expanded;
+  std::unordered_set<AbsTerm *> done;
+  while (!to_visit.empty())
+  {
+    Term t = to_visit.back();
+    if (expanded.insert(t.get()).second)
     {
-      result = "((_ is ";
-      result += (*term_name_map)[gt->get_children()[0]];
-      result += ") ";
-      result += (*term_name_map)[gt->get_children()[1]];
-      result += ")";
-      return result;
+      if (!is_quantifier(t))
+      {
+        for (const Term & c : static_cast<GenericTerm *>(t.get())->children)
+        {
+          if (is_inner(c))
+          {
+            refs[c.get()]++;
+            if (expanded.find(c.get()) == expanded.end())
+            {
+              to_visit.push_back(c);
+            }
+          }
+        }
+      }
     }
     else
     {
-      result = "(";
+      to_visit.pop_back();
+      if (done.insert(t.get()).second)
+      {
+        post_order.push_back(t);
+      }
     }
-    // The Apply operator is ignored and the
-    // function being applied is used instead.
-    result += ((term->get_op().prim_op == Apply
-                || term->get_op().prim_op == Apply_Constructor
-                || term->get_op().prim_op == Apply_Selector
-                || term->get_op().prim_op == Apply_Tester)
-                   ? ""
-                   : term->get_op().to_string());
-    // For quantifiers we separate the bound variables list
-    // and the formula body.
-    if (term->get_op().prim_op == Forall || term->get_op().prim_op == Exists)
+  }
+
+  // shared nodes are bound with a let. Let bindings are parallel in
+  // SMT-LIB, so a binding is placed in the first let that comes after
+  // the bindings it depends on.
+  // depth[t] is the number of lets needed before t can be written.
+  std::unordered_map<AbsTerm *, size_t> depth;
+  std::unordered_map<AbsTerm *, string> let_names;
+  std::vector<std::vector<Term>> bindings;
+  for (const Term & t : post_order)
+  {
+    size_t d = 0;
+    if (!is_quantifier(t))
     {
-      result += " ((" + (*term_name_map)[gt->get_children()[0]] + " "
-                + (*sort_name_map)[gt->get_children()[0]->get_sort()] + ")) "
-                + (*term_name_map)[gt->get_children()[1]];
+      for (const Term & c : static_cast<GenericTerm *>(t.get())->children)
+      {
+        if (is_inner(c))
+        {
+          d = std::max(d, depth[c.get()]);
+        }
+      }
     }
-    else
+    if (t.get() != term.get() && refs[t.get()] > 1)
     {
-      // in the general case (other than quantifiers
-      // and Apply), we use ordinary
-      // s-expressions notation and write a
-      // space-separated list of arguments.
-      for (auto c : gt->get_children())
+      if (bindings.size() <= d)
       {
-        result += " " + (*term_name_map)[c];
+        bindings.resize(d + 1);
       }
+      bindings[d].push_back(t);
+      let_names[t.get()] = "_let_" + std::to_string(let_names.size());
+      d++;
+    }
+    depth[t.get()] = d;
+  }
+
+  // writes the definition of t. Bound children are referred to by
+  // their let name, other nodes are written in place since they are
+  // referenced only once.
+  std::function<void(const Term &, string &)> write_def;
+  std::function<void(const Term &, string &)> write_ref =
+      [&](const Term & c, string & out) {
+        if (!is_inner(c))
+        {
+          out += (*term_name_map)[c];
+          return;
+        }
+        auto it = let_names.find(c.get());
+        if (it != let_names.end())
+        {
+          out += it->second;
+        }
+        else
+        {
+          write_def(c, out);
+        }
+      };
+  write_def = [&](const Term & t, string & out) {
+    if (is_quantifier(t))
+    {
+      out += to_smtlib_def(t);
+    }
+    else
+    {
+      write_app(t, out, write_ref);
     }
-    if (gt->get_op() != Apply_Constructor || nullary_constructor)
+  };
+
+  string result;
+  for (const std::vector<Term> & level : bindings)
+  {
+    result += "(let (";
+    for (const Term & t : level)
     {
+      result += "(" + let_names[t.get()] + " ";
+      write_def(t, result);
       result += ")";
     }
-    return result;
+    result += ") ";
   }
+  write_def(term, result);
+  result.append(bindings.size(), ')');
+  return result;
 }
 
 Sort GenericSolver::make_sort(const Sort & sort_con, const SortVec & sorts) const {
@@ -408,8 +929,9 @@ Sort GenericSolver::make_sort(const std::string name, uint64_t arity) const {
     (*name_sort_map)[name] = sort;
     (*sort_name_map)[sort] = name;
     // declare the sort to the binary of the solver
-    run_command("(" + DECLARE_SORT_STR + " " + name + " "
-                + std::to_string(arity) + ")");
+    string cmd = "(" + DECLARE_SORT_STR + " " + name + " "
+                 + std::to_string(arity) + ")";
+    run_global_command(cmd);
     return sort;
   }
   else
@@ -563,7 +1085,7 @@ Sort GenericSolver::make_sort(const DatatypeDecl & d) const
     assert(name_sort_map->find(dt_decl_name) == name_sort_map->end());
     (*name_sort_map)[dt_decl_name] = dt_sort;
     (*sort_name_map)[dt_sort] = dt_decl_name;
-    run_command(to_solver);
+    run_global_command(to_solver);
 
     return dt_sort;
   }
@@ -762,10 +1284,18 @@ Term GenericSolver::store_term(Term term) const
       name = get_name(gterm);
       define_fun(name, SortVec{}, gterm->get_sort(), gterm);
     }
-    else
+    else if (gterm->get_op().is_null())
     {
       name = to_smtlib_def(gterm);
     }
+    else
+    {
+      // the name of a non-ground term with an operator is only
+      // used internally. It is written as part of the quantifier
+      // that binds its variables (see to_smtlib_let_def), and
+      // is not part of the representation of any term (see make_term).
+      name = get_name(gterm);
+    }
     (*name_term_map)[name] = gterm;
     (*term_name_map)[gterm] = name;
   }
@@ -1002,16 +1532,57 @@ Term GenericSolver::make_term(const Op op,
 
 Term GenericSolver::make_term(const Op op, const TermVec & terms) const
 {
-  Sort sort = compute_sort(op, this, terms);
-  string repr = "(" + op.to_string();
-  for (int i = 0; i < terms.size(); i++)
+  // look up the stored version of the children.
+  // Structurally equal children map to the same stored term,
+  // so their ids identify them.
+  GenericTermKey key;
+  key.op = op;
+  key.child_ids.reserve(terms.size());
+  TermVec stored_children;
+  stored_children.reserve(terms.size());
+  for (const Term & t : terms)
+  {
+    auto it = term_name_map->find(t);
+    assert(it != term_name_map->end());
+    key.child_ids.push_back(it->first->get_id());
+    stored_children.push_back(it->first);
+  }
+
+  // return the existing term if it was already built
+  auto it = op_term_table->find(key);
+  if (it != op_term_table->end())
+  {
+    return it->second;
+  }
+
+  Sort sort = compute_sort(op, this, stored_children);
+  // non-ground children with an operator have internal names that are
+  // never sent to the binary (see store_term). A term with such children
+  // gets an empty representation, which GenericTerm::to_string computes
+  // from the children on demand.
+  bool named_children = true;
+  for (const Term & c : stored_children)
+  {
+    GenericTerm * gc = static_cast<GenericTerm *>(c.get());
+    if (!gc->is_ground() && !gc->get_op().is_null())
+    {
+      named_children = false;
+      break;
+    }
+  }
+  string repr;
+  if (named_children)
   {
-    assert((*term_name_map).find(terms[i]) != (*term_name_map).end());
-    repr += " " + (*term_name_map)[terms[i]];
+    repr = "(" + op.to_string();
+    for (const Term & c : stored_children)
+    {
+      repr += " " + (*term_name_map)[c];
+    }
+    repr += ")";
   }
-  repr += ")";
-  Term term = std::make_shared<GenericTerm>(sort, op, terms, repr);
+  Term term = std::make_shared<GenericTerm>(sort, op, stored_children, repr);
   Term stored_term = store_term(term);
+  op_term_table->emplace(std::move(key), stored_term);
   return stored_term;
 }
 
@@ -1033,7 +1604,7 @@ Term GenericSolver::get_value(const Term & t) const
   // check that there was no error
   check_no_error(result);
 
-  string value = strip_value_from_result(result);
+  string value = strip_value_from_result(tokenize_sexpr(result));
 
   // translate the string representation of the result into a term
   Term resulting_term;
@@ -1041,26 +1612,26 @@ Term GenericSolver::get_value(const Term & t) const
   // them. it can be either binary, hex, or decimal.
   if (sort->get_sort_kind() == BV)
   {
-    if (value.substr(0, 2) == "#b")
+    if (value.compare(0, 2, "#b") == 0)
     {
       // bianry representation
-      resulting_term = make_value(value.substr(2, value.size() - 2), sort, 2);
+      resulting_term = make_value(value.substr(2), sort, 2);
     }
-    else if (value.substr(0, 2) == "#x")
+    else if (value.compare(0, 2, "#x") == 0)
     {
       // hex representation
-      resulting_term = make_value(value.substr(2, value.size() - 2), sort, 16);
+      resulting_term = make_value(value.substr(2), sort, 16);
     }
     else
     {
       // decimal representation.
       // parse strings of the form (_ bv<decimal> <bitwidth>)
-      size_t index_of__ = value.find("_ ");
-      assert(index_of__ != string::npos);
-      int start_of_decimal = index_of__ + 4;
-      int end_of_decimal = value.find(' ', start_of_decimal);
+      const string prefix = "(_ bv";
+      assert(value.compare(0, prefix.size(), prefix) == 0);
+      size_t end_of_decimal = value.find(' ', prefix.size());
+      assert(end_of_decimal != string::npos);
       string decimal =
-          value.substr(start_of_decimal, end_of_decimal - start_of_decimal + 1);
+          value.substr(prefix.size(), end_of_decimal - prefix.size());
       resulting_term = make_value(decimal, sort, 10);
     }
   }
@@ -1077,43 +1648,25 @@ Term GenericSolver::get_value(const Term & t) const
   return resulting_term;
 }
 
-string GenericSolver::strip_value_from_result(string result) const
+string GenericSolver::strip_value_from_result(
+    const vector<string_view> & tokens) const
 {
-  // trim spaces
-  result = trim(result);
-
-  // value string ends at first ")" or end of string.
-  int end_of_value = result.size() - 1;
-  while (result.at(end_of_value) == ')' || result.at(end_of_value) == ' ')
+  // the response has the form ((<term> <value>))
+  if (tokens.size() < 6 || tokens[0] != "(" || tokens[1] != "(")
   {
-    end_of_value--;
+    throw InternalSolverException("Unexpected response to get-value: "
+                                  + join_tokens(tokens, 0, tokens.size()));
   }
-
-  // value string begins at the first non-space after '('
-  int start_of_value = end_of_value;
-  while (result.at(start_of_value) != '(')
+  size_t start_of_value = skip_sexpr(tokens, 2);
+  size_t end_of_value = skip_sexpr(tokens, start_of_value);
+  if (end_of_value > tokens.size() - 2)
   {
-    start_of_value--;
+    throw InternalSolverException("Unexpected response to get-value: "
+                                  + join_tokens(tokens, 0, tokens.size()));
   }
-  while (result.at(start_of_value) != ' ')
-  {
-    start_of_value++;
-  }
-  start_of_value++;
-
-  // special case for bit-vectors with smt-lib style
-  // (_ bv<value> <bitwidth>)
-  // in this case we only take <value>
-  if (result.find("bv", start_of_value) == start_of_value)
-  {
-    start_of_value -= 3;
-    end_of_value++;
-  }
-
-  // crop the relevant substring
-  string strip =
-      result.substr(start_of_value, end_of_value - start_of_value + 1);
-  return strip;
+  // values that are s-expressions themselves, e.g.,
+  // (_ bv<value> <bitwidth>) or (- 1) are kept as a whole
+  return join_tokens(tokens, start_of_value, end_of_value);
 }
 
 void GenericSolver::get_unsat_assumptions(UnorderedTermSet & out)
@@ -1125,7 +1678,8 @@ void GenericSolver::get_unsat_assumptions(UnorderedTermSet & out)
   check_no_error(result);
 
   // parse the result -- get the assumptions
-  UnorderedTermSet assumptions = get_assumptions_from_string(result);
+  UnorderedTermSet assumptions =
+      get_assumptions_from_string(tokenize_sexpr(result));
 
   // put the result in out
   out.insert(assumptions.begin(), assumptions.end());
@@ -1141,57 +1695,41 @@ void GenericSolver::check_no_error(string str) const
   }
 }
 
-UnorderedTermSet GenericSolver::get_assumptions_from_string(string result) const
+UnorderedTermSet GenericSolver::get_assumptions_from_string(
+    const vector<string_view> & tokens) const
 {
   // the result from the solver is a
-  // space-separated list of Boolean literals.
+  // parenthesized list of Boolean literals.
   UnorderedTermSet literals;
 
-  // trim the result from spaces
-  result = trim(result);
-
-  // unwrap parenthesis and trim spaces again
-  string strip = result.substr(1, result.size() - 2);
-  strip = trim(strip);
-
-  // position in the string
-  int index = 0;
-  // if true, current literal is positive.
-  // otherwise, it has the form (not <var>)
-  bool positive;
-
-  // iterate the string
-  while (index < strip.size())
+  if (tokens.size() < 2 || tokens.front() != "(" || tokens.back() != ")")
   {
-    // beginning and end of literal
-    int begin;
-    int end;
+    throw InternalSolverException(
+        "Unexpected response to get-unsat-assumptions: "
+        + join_tokens(tokens, 0, tokens.size()));
+  }
 
-    // negative literal
-    if (strip.substr(index, 5) == "(not ")
-    {
-      begin = index + 5;
-      end = strip.find(")", begin + 1) - 1;
-      assert(end != string::npos);
-      positive = false;
-    }
-    else
+  // position in the tokens, skipping the outer parenthesis
+  size_t index = 1;
+  while (index < tokens.size() - 1)
+  {
+    // if true, current literal is positive.
+    // otherwise, it has the form (not <var>)
+    bool positive = tokens[index] != "(";
+    if (!positive)
     {
-      // positive literal -- starts with the variable name
-      begin = index;
-      // end -- one character after the end of the substring
-      end = strip.find(" ", begin + 1);
-      if (end == string::npos)
+      if (index + 3 >= tokens.size() || tokens[index + 1] != "not"
+          || tokens[index + 3] != ")")
       {
-        end = strip.size();
+        throw InternalSolverException(
+            "Unexpected literal in response to get-unsat-assumptions: "
+            + join_tokens(tokens, 0, tokens.size()));
       }
-      // end -- the actual end of the substring
-      end--;
-      positive = true;
+      index += 2;
     }
 
     // retrieve the literal from the map
-    string str_atom = strip.substr(begin, end - begin + 1);
+    string str_atom(tokens[index]);
     auto it = name_term_map->find(str_atom);
     if (it == name_term_map->end())
     {
@@ -1205,24 +1743,17 @@ UnorderedTermSet GenericSolver::get_assumptions_from_string(string result) const
     if (positive)
     {
       literal = atom;
+      index++;
     }
     else
     {
       literal = make_term(Not, atom);
+      // skip the atom and the closing parenthesis
+      index += 2;
     }
 
     // add the literal to the result
     literals.insert(literal);
-    if (positive)
-    {
-      // next beginning is after a space
-      index = end + 2;
-    }
-    else
-    {
-      // next beginning is after a space and a ')'
-      index = end + 3;
-    }
   }
   return literals;
 }
@@ -1236,17 +1767,27 @@ UnorderedTermMap GenericSolver::get_array_values(const Term & arr,
 
 void GenericSolver::reset()
 {
+  // see push
+  flush_pending_commands();
   string result = run_command("(" + RESET_STR + ")");
+  flush_pending_commands();
+  // nothing before the reset is needed to restore the binary,
+  // except the first command, which sets print-success for restarts
+  replay_cmds.resize(std::min<size_t>(replay_cmds.size(), 1));
+  replay_scopes.clear();
+  context_level_ = 0;
 }
 
 void GenericSolver::set_opt(const std::string option, const std::string value)
 {
-  run_command("(" + SET_OPTION_STR + " :" + option + " " + value + ")");
+  string cmd = "(" + SET_OPTION_STR + " :" + option + " " + value + ")";
+  run_global_command(cmd);
 }
 
 void GenericSolver::set_logic(const std::string logic)
 {
-  run_command("(" + SET_LOGIC_STR + " " + logic + ")");
+  string cmd = "(" + SET_LOGIC_STR + " " + logic + ")";
+  run_global_command(cmd);
 }
 
 void GenericSolver::assert_formula(const Term & t)
@@ -1292,6 +1833,14 @@ Result GenericSolver::check_sat()
 }
 
 Result GenericSolver::check_sat_assuming(const TermVec & assumptions)
+{
+  // send command to the solver and parse it
+  string result = run_command(check_sat_assuming_cmd(assumptions), false);
+  Result r = str_to_result(result);
+  return r;
+}
+
+string GenericSolver::check_sat_assuming_cmd(const TermVec & assumptions) const
 {
   string names;
   for (Term t : assumptions)
@@ -1307,24 +1856,192 @@ Result GenericSolver::check_sat_assuming(const TermVec & assumptions)
     assert(term_name_map->find(t) != term_name_map->end());
     names += " " + (*term_name_map)[t];
   }
+  return "(" + CHECK_SAT_ASSUMING_STR + " (" + names + "))";
+}
 
-  // send command to the solver and parse it
-  string result =
-      run_command("(" + CHECK_SAT_ASSUMING_STR + " (" + names + "))", false);
-  Result r = str_to_result(result);
-  return r;
+GenericAsyncResult GenericSolver::check_sat_async(
+    std::chrono::milliseconds timeout)
+{
+  return start_async("(" + CHECK_SAT_STR + ")", timeout);
+}
+
+GenericAsyncResult GenericSolver::check_sat_assuming_async(
+    const TermVec & assumptions, std::chrono::milliseconds timeout)
+{
+  return start_async(check_sat_assuming_cmd(assumptions), timeout);
+}
+
+GenericAsyncResult GenericSolver::start_async(
+    string cmd, std::chrono::milliseconds timeout)
+{
+  if (!restartable)
+  {
+    throw IncorrectUsageException(
+        "Asynchronous queries need a generic solver that was created with "
+        "restartable = true");
+  }
+  if (async_query)
+  {
+    throw IncorrectUsageException(
+        "A check-sat query is still running in the solver. Get its result "
+        "or cancel it first.");
+  }
+  // the queued commands are part of the query
+  flush_pending_commands();
+  write_internal(cmd + "\n");
+
+  async_query = ++async_counter;
+  async_has_deadline = timeout > std::chrono::milliseconds::zero();
+  async_deadline = std::chrono::steady_clock::now() + timeout;
+  return GenericAsyncResult(this, async_query);
+}
+
+Result GenericSolver::async_result(uint64_t query_id, bool block)
+{
+  if (query_id != async_query)
+  {
+    throw IncorrectUsageException("The check-sat query is no longer running");
+  }
+
+  // the response might already be in the buffer
+  while (!scan_response())
+  {
+    int timeout_ms = block ? -1 : 0;
+    if (async_has_deadline)
+    {
+      auto now = std::chrono::steady_clock::now();
+      if (now >= async_deadline)
+      {
+        return cancel_async(query_id, "timeout");
+      }
+      if (block)
+      {
+        // round up, so that we do not wake up right before the deadline
+        timeout_ms = std::chrono::ceil<std::chrono::milliseconds>(
+                         async_deadline - now)
+                         .count();
+      }
+    }
+
+    struct pollfd fd;
+    fd.fd = inpipefd[0];
+    fd.events = POLLIN;
+    fd.revents = 0;
+    int ready = poll(&fd, 1, timeout_ms);
+    if (ready < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      throw InternalSolverException("Failed polling the solver process");
+    }
+    if (ready == 0)
+    {
+      if (!block)
+      {
+        return Result();
+      }
+      // the deadline is checked at the top of the loop
+      continue;
+    }
+    // a read after poll does not block
+    if (!read_chunk())
+    {
+      // the binary terminated, take what it wrote
+      scan_pos = out_buf.size();
+      break;
+    }
+  }
+
+  async_query = 0;
+  string result = take_response();
+  result = trim(result);
+  return str_to_result(result);
+}
+
+Result GenericSolver::cancel_async(uint64_t query_id, string reason)
+{
+  if (query_id != async_query)
+  {
+    throw IncorrectUsageException("The check-sat query is no longer running");
+  }
+  // not all solvers stop on an interrupt, so the binary is started over
+  async_query = 0;
+  restart_solver();
+  return Result(UNKNOWN, reason);
+}
+
+bool GenericAsyncResult::is_ready()
+{
+  if (result.is_null() && solver)
+  {
+    result = solver->async_result(query_id, false);
+  }
+  return !result.is_null();
+}
+
+Result GenericAsyncResult::get()
+{
+  if (result.is_null() && solver)
+  {
+    result = solver->async_result(query_id, true);
+  }
+  return result;
+}
+
+void GenericAsyncResult::cancel()
+{
+  if (result.is_null() && solver)
+  {
+    result = solver->cancel_async(query_id, "cancelled");
+  }
 }
 
 void GenericSolver::push(uint64_t num)
   {
+    // an earlier queued command that fails must throw before the push
+    // is sent, otherwise the scope would be opened but not recorded
+    flush_pending_commands();
     string result =
         run_command("(" + PUSH_STR + " " + std::to_string(num) + ")");
+    // the push command must be in replay_cmds to record its scopes
+    flush_pending_commands();
+    if (restartable)
+    {
+      replay_scopes.insert(replay_scopes.end(), num, replay_cmds.size() - 1);
+    }
     context_level_ += num;
   }
 
 void GenericSolver::pop(uint64_t num)
 {
+  // see push
+  flush_pending_commands();
   string result = run_command("(" + POP_STR + " " + std::to_string(num) + ")");
+  flush_pending_commands();
+  // replay_scopes is empty if the solver is not restartable
+  if (num > 0 && num <= replay_scopes.size())
+  {
+    // forget the commands of the popped scopes. They are not needed
+    // to restore the current state.
+    size_t push_idx = replay_scopes[replay_scopes.size() - num];
+    replay_scopes.resize(replay_scopes.size() - num);
+    replay_cmds.resize(push_idx);
+    // the push command that opened the popped scopes might
+    // have opened some of the remaining ones as well
+    size_t remaining = 0;
+    while (remaining < replay_scopes.size()
+           && replay_scopes[replay_scopes.size() - 1 - remaining] == push_idx)
+    {
+      remaining++;
+    }
+    if (remaining)
+    {
+      replay_cmds.push_back("(" + PUSH_STR + " " + std::to_string(remaining)
+                            + ")\n");
+    }
+  }
   context_level_ -= num;
 }
 
@@ -1332,7 +2049,29 @@ uint64_t GenericSolver::get_context_level() const { return context_level_; }
 
 void GenericSolver::reset_assertions()
   {
+    // see push
+    flush_pending_commands();
     string result = run_command("(" + RESET_ASSERTIONS_STR + ")");
+    flush_pending_commands();
+    // all the scopes are popped, and the assertions of the
+    // first level are removed from the replay log
+    if (!replay_scopes.empty())
+    {
+      replay_cmds.resize(replay_scopes[0]);
+    }
+    const string assert_prefix = "(" + ASSERT_STR + " ";
+    replay_cmds.erase(std::remove_if(replay_cmds.begin(),
+                                     replay_cmds.end(),
+                                     [&assert_prefix](const string & cmd) {
+                                       return cmd.compare(
+                                                  0,
+                                                  assert_prefix.size(),
+                                                  assert_prefix)
+                                              == 0;
+                                     }),
+                      replay_cmds.end());
+    replay_scopes.clear();
+    context_level_ = 0;
   }
 
 }  // namespace smt
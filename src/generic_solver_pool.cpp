@@ -0,0 +1,283 @@
+/*********************                                                        */
+/*! \file generic_solver_pool.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Yoni Zohar
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A pool of generic solver processes that answers independent
+**        queries in parallel.
+**
+**/
+
+// generic solvers are not supported on macos
+#ifndef __APPLE__
+
+#include "generic_solver_pool.h"
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "assert.h"
+#include "smtlib_utils.h"
+
+using namespace std;
+
+namespace smt {
+
+GenericSolverPool::GenericSolverPool(string path,
+                                     vector<string> cmd_line_args,
+                                     size_t num_workers,
+                                     unsigned int write_buf_size,
+                                     unsigned int read_buf_size)
+    : path(path),
+      cmd_line_args(cmd_line_args),
+      write_buf_size(write_buf_size),
+      read_buf_size(read_buf_size),
+      // its commands are only checked, so they are queued and
+      // sent in batches
+      solver(std::make_shared<GenericSolver>(
+          path, cmd_line_args, write_buf_size, read_buf_size, true)),
+      workers(num_workers)
+{
+  if (num_workers == 0)
+  {
+    throw IncorrectUsageException(
+        "A generic solver pool needs at least one worker");
+  }
+  for (size_t i = 0; i < num_workers; ++i)
+  {
+    start_worker(workers[i]);
+    idle_workers.push_back(i);
+  }
+}
+
+GenericSolverPool::~GenericSolverPool() {}
+
+SmtSolver GenericSolverPool::get_solver() const { return solver; }
+
+size_t GenericSolverPool::get_num_workers() const { return workers.size(); }
+
+void GenericSolverPool::assert_formula(const Term & t)
+{
+  lock_guard<mutex> lk(solver_mutex);
+  assertions.push_back(t);
+}
+
+void GenericSolverPool::start_worker(Worker & w)
+{
+  // the old process goes first, even if the new one fails to start
+  w.solver.reset();
+  // workers queue their commands until the query is sent
+  w.solver.reset(new GenericSolver(
+      path, cmd_line_args, write_buf_size, read_buf_size, true));
+  w.defined.clear();
+  w.num_global_cmds = 0;
+  w.num_assertions = 0;
+}
+
+size_t GenericSolverPool::acquire_worker()
+{
+  unique_lock<mutex> lk(idle_mutex);
+  idle_cv.wait(lk, [this] { return !idle_workers.empty(); });
+  size_t idx = idle_workers.back();
+  idle_workers.pop_back();
+  return idx;
+}
+
+void GenericSolverPool::release_worker(size_t idx)
+{
+  {
+    lock_guard<mutex> lk(idle_mutex);
+    idle_workers.push_back(idx);
+  }
+  idle_cv.notify_one();
+}
+
+void GenericSolverPool::sync_worker(Worker & w, const TermVec & terms)
+{
+  // queued global commands are recorded once they are verified
+  solver->flush_pending_commands();
+  // the global commands come first, since they declare
+  // the sorts that terms may use
+  const vector<string> & global_cmds = solver->global_cmds;
+  for (; w.num_global_cmds < global_cmds.size(); ++w.num_global_cmds)
+  {
+    w.solver->run_command(global_cmds[w.num_global_cmds]);
+  }
+
+  TermVec to_visit(terms);
+  to_visit.insert(
+      to_visit.end(), assertions.begin() + w.num_assertions, assertions.end());
+
+  // declare and define the terms the worker does not have yet, children
+  // before their parents. Subterms of quantifiers are traversed as well,
+  // since the let-based definition of a quantifier refers to the names of
+  // its ground subterms.
+  unordered_set<AbsTerm *> expanded;
+  unordered_set<AbsTerm *> done;
+  while (!to_visit.empty())
+  {
+    Term t = to_visit.back();
+    GenericTerm * gt = static_cast<GenericTerm *>(t.get());
+    auto name_it = solver->term_name_map->find(t);
+    assert(name_it != solver->term_name_map->end());
+    const string & name = name_it->second;
+    bool have = gt->is_ground() && w.defined.find(name) != w.defined.end();
+
+    if (!have && expanded.insert(gt).second)
+    {
+      for (const Term & c : gt->children)
+      {
+        if (expanded.find(c.get()) == expanded.end())
+        {
+          to_visit.push_back(c);
+        }
+      }
+      continue;
+    }
+
+    to_visit.pop_back();
+    if (have || !gt->is_ground() || !done.insert(gt).second)
+    {
+      // non-ground terms are written as part of their quantifier
+      continue;
+    }
+
+    SortKind sk = gt->get_sort()->get_sort_kind();
+    if (sk == CONSTRUCTOR || sk == SELECTOR || sk == TESTER)
+    {
+      // declared together with their datatype
+      continue;
+    }
+
+    const string & sort_name = solver->sort_name_map->at(gt->get_sort());
+    if (gt->is_symbol())
+    {
+      w.solver->run_command("(" + DECLARE_FUN_STR + " " + name
+                            + (sk == FUNCTION ? " " : " () ") + sort_name
+                            + ")");
+    }
+    else
+    {
+      w.solver->run_command("(" + DEFINE_FUN_STR + " " + name + " () "
+                            + sort_name + " " + solver->to_smtlib_def(t)
+                            + ")");
+    }
+    w.defined.insert(name);
+  }
+
+  for (; w.num_assertions < assertions.size(); ++w.num_assertions)
+  {
+    w.solver->run_command("(" + ASSERT_STR + " "
+                          + solver->term_name_map->at(
+                              assertions[w.num_assertions])
+                          + ")");
+  }
+}
+
+Result GenericSolverPool::check_sat_assuming(const TermVec & assumptions)
+{
+  for (const Term & t : assumptions)
+  {
+    // assumptions can only be Boolean literals
+    if (t->get_sort()->get_sort_kind() != BOOL)
+    {
+      throw IncorrectUsageException(
+          "Expecting boolean indicator literals but got: " + t->to_string());
+    }
+  }
+
+  WorkerLease lease(*this);
+  Worker & w = workers[lease.idx];
+  if (!w.solver)
+  {
+    // an earlier restart failed, try again
+    start_worker(w);
+  }
+  Result r;
+  try
+  {
+    string names;
+    {
+      lock_guard<mutex> lk(solver_mutex);
+      sync_worker(w, assumptions);
+      for (const Term & t : assumptions)
+      {
+        names += " " + solver->term_name_map->at(t);
+      }
+    }
+    // sends the queued definitions together with the query
+    string result = w.solver->run_command(
+        "(" + CHECK_SAT_ASSUMING_STR + " (" + names + "))", false);
+    r = w.solver->str_to_result(result);
+  }
+  catch (...)
+  {
+    // the state of the worker is unknown, start it over
+    try
+    {
+      start_worker(w);
+    }
+    catch (...)
+    {
+      // the worker has no process and is started again when it is
+      // acquired. The error of the query is the one to report.
+    }
+    throw;
+  }
+  return r;
+}
+
+vector<Result> GenericSolverPool::check_sat_assuming_all(
+    const vector<TermVec> & queries)
+{
+  vector<Result> results(queries.size());
+  atomic<size_t> next_query(0);
+  exception_ptr error;
+  mutex error_mutex;
+
+  auto run_queries = [&]() {
+    for (size_t i = next_query++; i < queries.size(); i = next_query++)
+    {
+      try
+      {
+        results[i] = check_sat_assuming(queries[i]);
+      }
+      catch (...)
+      {
+        lock_guard<mutex> lk(error_mutex);
+        if (!error)
+        {
+          error = current_exception();
+        }
+      }
+    }
+  };
+
+  vector<thread> threads;
+  size_t num_threads = min(workers.size(), queries.size());
+  for (size_t i = 0; i < num_threads; ++i)
+  {
+    threads.emplace_back(run_queries);
+  }
+  for (thread & t : threads)
+  {
+    t.join();
+  }
+
+  if (error)
+  {
+    rethrow_exception(error);
+  }
+  return results;
+}
+
+}  // namespace smt
+
+#endif  // __APPLE__
@@ -16,6 +16,11 @@
 
 #include "generic_term.h"
 
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "exceptions.h"
 #include "utils.h"
 
@@ -25,10 +30,19 @@ namespace smt {
 
 /* GenericTerm */
 
+std::atomic<std::size_t> GenericTerm::next_id(1);
+
 GenericTerm::GenericTerm(Sort s, Op o, TermVec c, string r)
-    : sort(s), op(o), children(c), repr(r), is_sym(false), is_par(false)
+    : sort(s),
+      op(o),
+      children(c),
+      repr(r),
+      is_sym(false),
+      is_par(false),
+      id_(next_id++)
 {
   ground = compute_ground();
+  hash_ = compute_hash();
 }
 
 GenericTerm::GenericTerm(Sort s, Op o, TermVec c, string r, bool is_sym)
@@ -38,32 +52,72 @@ GenericTerm::GenericTerm(Sort s, Op o, TermVec c, string r, bool is_sym)
       repr(r),
       is_sym(is_sym),
       is_par(!is_sym),
-      ground(true)
+      ground(true),
+      id_(next_id++)
 {
   ground = compute_ground();
+  hash_ = compute_hash();
 }
 
 bool GenericTerm::compute_ground()
 {
-  // parameters are not ground terms
+  // a parameter is its own free parameter
   if (is_param())
   {
+    free_params.push_back(this);
     return false;
   }
-  // if one of the children is not ground, then the term
-  // is not ground.
-  for (Term child : get_children())
+  // otherwise, the free parameters are those of the children.
+  // This is not a recursive call -- the children computed
+  // their free parameters upon their construction.
+  for (const Term & child : children)
   {
-    shared_ptr<GenericTerm> gc = static_pointer_cast<GenericTerm>(child);
-    // This is not a recursive call -- is_ground is
-    // just a getter. Their `ground` member
-    // was initialized upon their construction.
-    if (!gc->is_ground())
+    const GenericTerm * gc = static_cast<const GenericTerm *>(child.get());
+    free_params.insert(
+        free_params.end(), gc->free_params.begin(), gc->free_params.end());
+  }
+  // except for the ones a quantifier binds:
+  // all of its children but the last one
+  if (op.prim_op == Forall || op.prim_op == Exists)
+  {
+    for (size_t i = 0; i + 1 < children.size(); ++i)
     {
-      return false;
+      free_params.erase(
+          remove(free_params.begin(), free_params.end(), children[i].get()),
+          free_params.end());
     }
   }
-  return true;
+  std::sort(free_params.begin(), free_params.end());
+  free_params.erase(unique(free_params.begin(), free_params.end()),
+                    free_params.end());
+  free_params.shrink_to_fit();
+  return free_params.empty();
+}
+
+size_t GenericTerm::compute_hash() const
+{
+  if (op.is_null())
+  {
+    // values, symbols, parameters, and constant arrays
+    // are identified by their representation
+    return str_hash(compute_string());
+  }
+  size_t result = std::hash<PrimOp>()(op.prim_op);
+  hash_combine(result, op.num_idx);
+  if (op.num_idx > 0)
+  {
+    hash_combine(result, op.idx0);
+  }
+  if (op.num_idx > 1)
+  {
+    hash_combine(result, op.idx1);
+  }
+  for (const Term & c : children)
+  {
+    // children already cached their hash
+    hash_combine(result, c->hash());
+  }
+  return result;
 }
 
 GenericTerm::~GenericTerm() {}
@@ -74,22 +128,89 @@ TermVec GenericTerm::get_children() { return children; }
 
 Sort GenericTerm::get_sort() const { return sort; }
 
-std::size_t GenericTerm::get_id() const { return hash(); }
+std::size_t GenericTerm::get_id() const { return id_; }
+
+bool GenericTerm::shallow_compare(const GenericTerm * gt) const
+{
+  // the cached hashes rule out most mismatches in constant time
+  if (hash_ != gt->hash_ || op != gt->op
+      || children.size() != gt->children.size() || sort != gt->sort)
+  {
+    return false;
+  }
+  if (op.is_null())
+  {
+    // The comparison is based on a string comparison
+    return compute_string() == gt->compute_string();
+  }
+  return true;
+}
+
+struct GenericTermPairHash
+{
+  size_t operator()(
+      const pair<const GenericTerm *, const GenericTerm *> & p) const
+  {
+    size_t seed = hash<const void *>()(p.first);
+    hash_combine(seed, hash<const void *>()(p.second));
+    return seed;
+  }
+};
 
 bool GenericTerm::compare(const Term & t) const
 {
-  // TODO: not efficient. Should do similar to logging term.
-  // the difference is that there is no underlying solver,
-  // and that we need some string sometimes anyway to create a
-  // generic term.
   if (!t)
   {
     // The null term is different than any constructed term.
     return false;
   }
-  shared_ptr<GenericTerm> gt = static_pointer_cast<GenericTerm>(t);
-  // The comparison is based on a string comparison
-  return repr == gt->to_string();
+  const GenericTerm * gt = static_cast<GenericTerm *>(t.get());
+  if (gt == this)
+  {
+    return true;
+  }
+  if (!shallow_compare(gt))
+  {
+    return false;
+  }
+
+  // compare the children pairwise, iteratively.
+  // Each pair is compared once: two equal DAGs that share no nodes
+  // have as many pairs as nodes, but exponentially many paths.
+  typedef pair<const GenericTerm *, const GenericTerm *> TermPair;
+  vector<TermPair> to_visit;
+  unordered_set<TermPair, GenericTermPairHash> visited;
+  auto push_children = [&to_visit](const GenericTerm * a,
+                                   const GenericTerm * b) {
+    for (size_t i = 0; i < a->children.size(); ++i)
+    {
+      const GenericTerm * ca =
+          static_cast<const GenericTerm *>(a->children[i].get());
+      const GenericTerm * cb =
+          static_cast<const GenericTerm *>(b->children[i].get());
+      // shared children are typically the same object
+      if (ca != cb)
+      {
+        to_visit.emplace_back(ca, cb);
+      }
+    }
+  };
+  push_children(this, gt);
+  while (!to_visit.empty())
+  {
+    TermPair p = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(p).second)
+    {
+      continue;
+    }
+    if (!p.first->shallow_compare(p.second))
+    {
+      return false;
+    }
+    push_children(p.first, p.second);
+  }
+  return true;
 }
 
 string GenericTerm::compute_string() const
@@ -141,7 +262,7 @@ string GenericTerm::to_string()
   return repr;
 }
 
-size_t GenericTerm::hash() const { return str_hash(compute_string()); }
+size_t GenericTerm::hash() const { return hash_; }
 
 // check if op is null because a non-value
 // may have been simplified to a value by the underlying solver
@@ -41,56 +41,99 @@ Term IdentityWalker::visit(Term & term)
     return out;
   }
 
-  TermVec to_visit({term});
+  // moved out of the members so that a visit_term which calls visit
+  // again gets its own buffers, and moved back before returning
+  vector<VisitFrame> to_visit = std::move(visit_stack_);
+  // the children of the expanded terms on the stack, in stack order
+  TermVec children = std::move(children_buf_);
   // Note: visited is different than cache keys
   //       might want to visit without saving to the cache
   //       and if something is in the cache it wouldn't
   //       visit it again (e.g. in post-order traversal)
-  UnorderedTermSet visited;
+  TermIdMap visited = std::move(visited_);
+  to_visit.clear();
+  children.clear();
+  visited.clear();
 
+  to_visit.push_back({ term, 0, false });
   Term t;
-  WalkerStepResult res;
-  while(to_visit.size())
+  WalkerStepResult res = Walker_Continue;
+  while (to_visit.size())
   {
-    t = to_visit.back();
-    to_visit.pop_back();
-
-    if (in_cache(t))
+    VisitFrame & f = to_visit.back();
+    if (in_cache(f.term))
     {
       // cache hit
+      if (f.expanded)
+      {
+        children.resize(f.first_child);
+      }
+      to_visit.pop_back();
       continue;
     }
 
-    // in preorder if it has not been seen before
-    preorder_ = (visited.find(t) == visited.end());
-    // add to visited after determining whether we're in the pre-
-    // or post-order
-    visited.insert(t);
-    res = visit_term(t);
+    t = std::move(f.term);
+    bool expanded = f.expanded;
+    size_t first_child = f.first_child;
+    to_visit.pop_back();
 
-    if (res == Walker_Abort)
+    if (expanded)
     {
-      // visit_term requested an abort
-      // return the mapping if it has been cached already
-      Term out = term;
-      query_cache(term, out);
-      return out;
+      // all its children have been visited
+      preorder_ = false;
+      cur_term_ = t.get();
+      cur_children_ = children.data() + first_child;
+      cur_num_children_ = children.size() - first_child;
+      res = visit_term(t);
+      cur_term_ = nullptr;
+      children.resize(first_child);
     }
-
-    if (preorder_)
+    else
     {
-      if (res == Walker_Continue)
+      // in preorder if it has not been seen before
+      // (a term shared by several parents can be pushed more than once)
+      preorder_ = !visited.find(t);
+      // add to visited after determining whether we're in the pre-
+      // or post-order
+      visited.set(t, t);
+      res = visit_term(t);
+
+      if (preorder_ && res == Walker_Continue)
       {
-        to_visit.push_back(t);
-        for (auto tt : t)
+        // collect the children once, for both the stack and the
+        // post-order visit
+        first_child = children.size();
+        for (TermIter it = t->begin(), end = t->end(); it != end; ++it)
+        {
+          children.push_back(*it);
+        }
+        to_visit.push_back({ t, first_child, true });
+        for (size_t i = first_child; i < children.size(); ++i)
         {
-          to_visit.push_back(tt);
+          if (!in_cache(children[i]))
+          {
+            to_visit.push_back({ children[i], 0, false });
+          }
         }
       }
     }
+
+    if (res == Walker_Abort)
+    {
+      // visit_term requested an abort
+      break;
+    }
   }
 
-  // finished the traversal
+  t = nullptr;
+  to_visit.clear();
+  children.clear();
+  visited.clear();
+  visit_stack_ = std::move(to_visit);
+  children_buf_ = std::move(children);
+  visited_ = std::move(visited);
+
+  // finished the traversal (or aborted)
   // return the cached term if available
   // otherwise just returns the original term
   query_cache(term, out);
@@ -104,16 +147,35 @@ WalkerStepResult IdentityWalker::visit_term(Term & term)
     Op op = term->get_op();
     if (!op.is_null())
     {
-      TermVec cached_children;
+      cached_children_.clear();
+      bool changed = false;
       Term c;
-      for (auto t : term)
+      auto add_child = [&](const Term & child) {
+        c = child;
+        query_cache(child, c);
+        changed |= (c != child);
+        cached_children_.push_back(c);
+      };
+
+      if (term.get() == cur_term_)
+      {
+        // collected by visit
+        for (size_t i = 0; i < cur_num_children_; ++i)
+        {
+          add_child(cur_children_[i]);
+        }
+      }
+      else
       {
-        // TODO: see if we can pass the same term as both arguments
-        c = t;
-        query_cache(t, c);
-        cached_children.push_back(c);
+        for (auto t : term)
+        {
+          add_child(t);
+        }
       }
-      save_in_cache(term, solver_->make_term(op, cached_children));
+
+      // rebuild only if a child changed
+      save_in_cache(term,
+                    changed ? solver_->make_term(op, cached_children_) : term);
     }
     else
     {
@@ -133,7 +195,7 @@ bool IdentityWalker::in_cache(const Term & key) const
   }
   else
   {
-    return cache_.find(key) != cache_.end();
+    return cache_.find(key) != nullptr;
   }
 }
 
@@ -150,10 +212,10 @@ bool IdentityWalker::query_cache(const Term & key, Term & out) const
   }
   else
   {
-    auto it = cache_.find(key);
-    if (it != cache_.end())
+    const Term * val = cache_.find(key);
+    if (val)
     {
-      out = it->second;
+      out = *val;
       return true;
     }
   }
@@ -168,7 +230,7 @@ void IdentityWalker::save_in_cache(const Term & key, const Term & val)
   }
   else
   {
-    cache_[key] = val;
+    cache_.set(key, val);
   }
 }
 }
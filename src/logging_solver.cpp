@@ -45,11 +45,51 @@ LoggingSolver::LoggingSolver(SmtSolver s)
       wrapped_solver(s),
       hashtable(new TermHashTable()),
       assumption_cache(new UnorderedTermMap()),
-      next_term_id(0)
+      next_term_id(0),
+      term_pool(new LoggingTermPool()),
+      gc_interval(0),
+      gc_last_size(0),
+      num_collected(0)
 {
 }
 
-LoggingSolver::~LoggingSolver() {}
+LoggingSolver::~LoggingSolver() { term_pool->release(); }
+
+size_t LoggingSolver::collect_garbage() const
+{
+  size_t num_freed = hashtable->sweep();
+  num_collected += num_freed;
+  gc_last_size = hashtable->size();
+  return num_freed;
+}
+
+void LoggingSolver::set_gc_interval(size_t num_terms)
+{
+  gc_interval = num_terms;
+  gc_last_size = hashtable->size();
+}
+
+LoggingSolverStats LoggingSolver::get_stats() const
+{
+  LoggingSolverStats stats;
+  stats.num_terms = hashtable->size();
+  stats.num_created = next_term_id;
+  stats.num_collected = num_collected;
+  stats.table_bytes = hashtable->memory_usage();
+  stats.pool_bytes = term_pool->memory_usage();
+  return stats;
+}
+
+void LoggingSolver::term_added() const
+{
+  next_term_id++;
+  // the term that was just added is referenced by the caller,
+  // so it survives the collection
+  if (gc_interval && hashtable->size() >= gc_last_size + gc_interval)
+  {
+    collect_garbage();
+  }
+}
 
 Sort LoggingSolver::make_sort(const string name, uint64_t arity) const
 {
@@ -169,17 +209,17 @@ Term LoggingSolver::make_term(bool b) const
 {
   Term wrapped_res = wrapped_solver->make_term(b);
   Sort boolsort = make_logging_sort(BOOL, wrapped_res->get_sort());
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, boolsort, Op(), TermVec{}, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroys the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -189,17 +229,17 @@ Term LoggingSolver::make_term(int64_t i, const Sort & sort) const
 {
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_res = wrapped_solver->make_term(i, lsort->wrapped_sort);
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, sort, Op(), TermVec{}, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -209,17 +249,17 @@ Term LoggingSolver::make_term(const std::string& s, bool useEscSequences, const
 {
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_res = wrapped_solver->make_term(s, useEscSequences, lsort->wrapped_sort);
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, sort, Op(), TermVec{}, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -228,17 +268,17 @@ Term LoggingSolver::make_term(const std::string& s, bool useEscSequences, const
 Term LoggingSolver::make_term(const std::wstring& s, const Sort & sort) const{
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_res = wrapped_solver->make_term(s, lsort->wrapped_sort);
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, sort, Op(), TermVec{}, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -250,17 +290,37 @@ Term LoggingSolver::make_term(const string name,
 {
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_res = wrapped_solver->make_term(name, lsort->wrapped_sort, base);
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, sort, Op(), TermVec{}, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
+  }
+
+  return res;
+}
+
+Term LoggingSolver::make_term(const BVValue & val, const Sort & sort) const
+{
+  shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
+  Term wrapped_res = wrapped_solver->make_term(val, lsort->wrapped_sort);
+  Term res = make_logging_term(
+      wrapped_res, sort, Op(), TermVec{}, next_term_id);
+
+  // check hash table
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
+  {
+    // this is the first time this term was created
+    term_added();
   }
 
   return res;
@@ -281,17 +341,17 @@ Term LoggingSolver::make_term(const Term & val, const Sort & sort) const
         + sort->to_string());
   }
   // the constant value must be the child
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, sort, Op(), TermVec{ val }, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -302,17 +362,17 @@ Term LoggingSolver::make_symbol(const string name, const Sort & sort)
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_sym = wrapped_solver->make_symbol(name, lsort->wrapped_sort);
   // bool true means it's a symbol
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_sym, sort, Op(), TermVec{}, name, true, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   symbol_table[name] = res;
@@ -335,17 +395,17 @@ Term LoggingSolver::make_param(const string name, const Sort & sort)
   shared_ptr<LoggingSort> lsort = static_pointer_cast<LoggingSort>(sort);
   Term wrapped_param = wrapped_solver->make_param(name, lsort->wrapped_sort);
   // bool false means it's not a symbol
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_param, sort, Op(), TermVec{}, name, false, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -360,17 +420,17 @@ Term LoggingSolver::make_term(const Op op, const Term & t) const
   // check that child is already in hash table
   assert(hashtable->contains(t));
 
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, res_logging_sort, op, TermVec{ t }, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -391,16 +451,16 @@ Term LoggingSolver::make_term(const Op op,
   assert(hashtable->contains(t1));
   assert(hashtable->contains(t2));
 
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, res_logging_sort, op, TermVec({ t1, t2 }), next_term_id);
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -424,17 +484,17 @@ Term LoggingSolver::make_term(const Op op,
   assert(hashtable->contains(t2));
   assert(hashtable->contains(t3));
 
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, res_logging_sort, op, TermVec{ t1, t2, t3 }, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -455,17 +515,17 @@ Term LoggingSolver::make_term(const Op op, const TermVec & terms) const
   // Note: for convenience there's a version of compute_sort that takes terms
   // since these are already in a vector, just let it unpack the sorts
   Sort res_logging_sort = compute_sort(op, this, terms);
-  Term res = std::make_shared<LoggingTerm>(
+  Term res = make_logging_term(
       wrapped_res, res_logging_sort, op, terms, next_term_id);
 
   // check hash table
-  // lookup modifies term in place and returns true if it's a known term
-  // i.e. returns existing term and destroying the unnecessary new one
-  if (!hashtable->lookup(res))
+  // lookup_or_insert modifies term in place and returns true if it's a
+  // known term, i.e. returns existing term and destroys the unnecessary
+  // new one. Otherwise, it inserts the term.
+  if (!hashtable->lookup_or_insert(res))
   {
     // this is the first time this term was created
-    hashtable->insert(res);
-    next_term_id++;
+    term_added();
   }
 
   return res;
@@ -486,17 +546,17 @@ Term LoggingSolver::get_value(const Term & t) const
   if (t->get_sort()->get_sort_kind() != ARRAY)
   {
     Term wrapped_val = wrapped_solver->get_value(lt->wrapped_term);
-    res = std::make_shared<LoggingTerm>(
+    res = make_logging_term(
         wrapped_val, t->get_sort(), Op(), TermVec{}, next_term_id);
 
     // check hash table
-    // lookup modifies term in place and returns true if it's a known term
-    // i.e. returns existing term and destroying the unnecessary new one
-    if (!hashtable->lookup(res))
+    // lookup_or_insert modifies term in place and returns true if it's a
+    // known term, i.e. returns existing term and destroys the unnecessary
+    // new one. Otherwise, it inserts the term.
+    if (!hashtable->lookup_or_insert(res))
     {
       // this is the first time this term was created
-      hashtable->insert(res);
-      next_term_id++;
+      term_added();
     }
   }
   else
@@ -558,16 +618,16 @@ UnorderedTermMap LoggingSolver::get_array_values(const Term & arr,
           "const base for multidimensional array not implemented in "
           "LoggingSolver");
     }
-    out_const_base = std::make_shared<LoggingTerm>(
+    out_const_base = make_logging_term(
         wrapped_out_const_base, elemsort, Op(), TermVec{}, next_term_id);
     // check hash table
-    // lookup modifies term in place and returns true if it's a known term
-    // i.e. returns existing term and destroys the unnecessary new one
-    if (!hashtable->lookup(out_const_base))
+    // lookup_or_insert modifies term in place and returns true if it's a
+    // known term, i.e. returns existing term and destroys the unnecessary
+    // new one. Otherwise, it inserts the term.
+    if (!hashtable->lookup_or_insert(out_const_base))
     {
       // this is the first time this term was created
-      hashtable->insert(out_const_base);
-      next_term_id++;
+      term_added();
     }
   }
 
@@ -579,22 +639,20 @@ UnorderedTermMap LoggingSolver::get_array_values(const Term & arr,
     Assert(elem.first->is_value());
     Assert(elem.second->is_value());
 
-    idx = std::make_shared<LoggingTerm>(
+    idx = make_logging_term(
         elem.first, idxsort, Op(), TermVec{}, next_term_id);
-    if (!hashtable->lookup(idx))
+    if (!hashtable->lookup_or_insert(idx))
     {
       // this is the first time this term was created
-      hashtable->insert(idx);
-      next_term_id++;
+      term_added();
     }
 
-    val = std::make_shared<LoggingTerm>(
+    val = make_logging_term(
         elem.second, elemsort, Op(), TermVec{}, next_term_id);
-    if (!hashtable->lookup(val))
+    if (!hashtable->lookup_or_insert(val))
     {
       // this is the first time this term was created
-      hashtable->insert(val);
-      next_term_id++;
+      term_added();
     }
 
     assignments[idx] = val;
@@ -607,6 +665,7 @@ void LoggingSolver::reset()
 {
   wrapped_solver->reset();
   hashtable->clear();
+  gc_last_size = 0;
 }
 
 // dispatched to underlying solver
@@ -629,6 +688,8 @@ void LoggingSolver::assert_formula(const Term & t)
 
 Result LoggingSolver::check_sat() { return wrapped_solver->check_sat(); }
 
+void LoggingSolver::interrupt() { wrapped_solver->interrupt(); }
+
 Result LoggingSolver::check_sat_assuming(const TermVec & assumptions)
 {
   // only needs to remember the latest set of assumptions
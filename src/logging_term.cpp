@@ -16,6 +16,9 @@
 
 #include "logging_term.h"
 
+#include <new>
+#include <utility>
+
 #include "exceptions.h"
 #include "utils.h"
 
@@ -23,6 +26,153 @@ using namespace std;
 
 namespace smt {
 
+/* LoggingTermPool */
+
+// the number of slots of the first chunk of a pool. Each chunk
+// doubles the number of slots, up to the maximum.
+const size_t MIN_CHUNK_SLOTS = 64;
+const size_t MAX_CHUNK_SLOTS = 1 << 12;
+
+LoggingTermPool::LoggingTermPool()
+    : slot_size(0),
+      chunk_pos(nullptr),
+      chunk_end(nullptr),
+      free_list(nullptr),
+      num_live(0),
+      num_bytes(0),
+      released(false)
+{
+}
+
+LoggingTermPool::~LoggingTermPool()
+{
+  for (char * chunk : chunks)
+  {
+    ::operator delete(chunk);
+  }
+}
+
+void LoggingTermPool::release()
+{
+  bool unused;
+  {
+    lock_guard<mutex> lk(pool_mutex);
+    released = true;
+    unused = (num_live == 0);
+  }
+  if (unused)
+  {
+    delete this;
+  }
+}
+
+void * LoggingTermPool::allocate(size_t bytes, size_t align)
+{
+  lock_guard<mutex> lk(pool_mutex);
+  if (!slot_size && align <= alignof(std::max_align_t))
+  {
+    // slots must be able to hold a free list pointer
+    slot_size = std::max(bytes, sizeof(void *));
+    slot_size = (slot_size + align - 1) / align * align;
+  }
+  if (bytes != slot_size)
+  {
+    // not a LoggingTerm allocation
+    num_live++;
+    return ::operator new(bytes);
+  }
+
+  void * p;
+  if (free_list)
+  {
+    p = free_list;
+    free_list = *static_cast<void **>(p);
+  }
+  else
+  {
+    if (chunk_pos == chunk_end)
+    {
+      size_t num_slots =
+          chunks.empty() ? MIN_CHUNK_SLOTS
+                         : std::min(2 * (chunk_end - chunks.back()) / slot_size,
+                                    MAX_CHUNK_SLOTS);
+      // operator new returns memory aligned for any fundamental type
+      char * chunk = static_cast<char *>(::operator new(num_slots * slot_size));
+      chunks.push_back(chunk);
+      num_bytes += num_slots * slot_size;
+      chunk_pos = chunk;
+      chunk_end = chunk + num_slots * slot_size;
+    }
+    p = chunk_pos;
+    chunk_pos += slot_size;
+  }
+  num_live++;
+  return p;
+}
+
+void LoggingTermPool::deallocate(void * p, size_t bytes)
+{
+  bool unused;
+  {
+    lock_guard<mutex> lk(pool_mutex);
+    if (bytes == slot_size)
+    {
+      *static_cast<void **>(p) = free_list;
+      free_list = p;
+    }
+    else
+    {
+      ::operator delete(p);
+    }
+    num_live--;
+    unused = released && num_live == 0;
+  }
+  if (unused)
+  {
+    delete this;
+  }
+}
+
+size_t LoggingTermPool::memory_usage() const
+{
+  lock_guard<mutex> lk(pool_mutex);
+  return num_bytes;
+}
+
+/* LoggingChildren */
+
+LoggingChildren::LoggingChildren(const TermVec & c) : size_(c.size())
+{
+  Term * dest;
+  if (size_ <= INLINE_SIZE)
+  {
+    dest = inline_children;
+  }
+  else
+  {
+    heap_children =
+        static_cast<Term *>(::operator new(size_ * sizeof(Term)));
+    dest = heap_children;
+  }
+  for (size_t i = 0; i < size_; ++i)
+  {
+    new (dest + i) Term(c[i]);
+  }
+}
+
+LoggingChildren::~LoggingChildren()
+{
+  Term * elems = const_cast<Term *>(data());
+  for (size_t i = 0; i < size_; ++i)
+  {
+    elems[i].~Term();
+  }
+  if (size_ > INLINE_SIZE)
+  {
+    ::operator delete(heap_children);
+  }
+}
+
 /* LoggingTerm */
 
 LoggingTerm::LoggingTerm(Term t, Sort s, Op o, TermVec c, size_t id)
@@ -42,7 +192,7 @@ LoggingTerm::LoggingTerm(
       sort(s),
       op(o),
       children(c),
-      repr(r),
+      repr(new string(r)),
       is_sym(is_sym),
       is_par(!is_sym),
       id_(id)
@@ -135,9 +285,9 @@ Sort LoggingTerm::get_sort() const { return sort; }
 
 string LoggingTerm::to_string()
 {
-  if (!repr.empty())
+  if (repr)
   {
-    return repr;
+    return *repr;
   }
 
   // rely on underlying term for values
@@ -153,14 +303,40 @@ string LoggingTerm::to_string()
     // Op should not be null because handled values above
     //     and symbols already have the repr set
     Assert(!op.is_null());
-    repr = "(";
-    repr += op.to_string();
-    for (auto c : children)
+    // the representation is not stored, to keep terms small
+    string result;
+    write_string(result);
+    return result;
+  }
+}
+
+void LoggingTerm::write_string(string & out)
+{
+  // iterative, since terms can be very deep.
+  // Each entry is a term and the index of the next child to write.
+  vector<pair<LoggingTerm *, size_t>> to_visit{ { this, 0 } };
+  out += "(" + op.to_string();
+  while (!to_visit.empty())
+  {
+    LoggingTerm * t = to_visit.back().first;
+    size_t i = to_visit.back().second++;
+    if (i == t->children.size())
     {
-      repr += " " + c->to_string();
+      out += ")";
+      to_visit.pop_back();
+      continue;
+    }
+    LoggingTerm * c = static_cast<LoggingTerm *>(t->children[i].get());
+    out += " ";
+    if (c->repr || c->op.is_null())
+    {
+      out += c->to_string();
+    }
+    else
+    {
+      out += "(" + c->op.to_string();
+      to_visit.push_back({ c, 0 });
     }
-    repr += ")";
-    return repr;
   }
 }
 
@@ -202,6 +378,8 @@ bool LoggingTerm::is_value() const { return op.is_null() && wrapped_term->is_val
 
 uint64_t LoggingTerm::to_int() const { return wrapped_term->to_int(); }
 
+BVValue LoggingTerm::to_bv_value() { return wrapped_term->to_bv_value(); }
+
 std::string LoggingTerm::print_value_as(SortKind sk)
 {
   return wrapped_term->print_value_as(sk);
@@ -209,7 +387,7 @@ std::string LoggingTerm::print_value_as(SortKind sk)
 
 /* LoggingTermIter */
 
-LoggingTermIter::LoggingTermIter(TermVec::iterator i) : it(i) {}
+LoggingTermIter::LoggingTermIter(const Term * i) : it(i) {}
 
 LoggingTermIter::LoggingTermIter(const LoggingTermIter & lit) : it(lit.it) {}
 
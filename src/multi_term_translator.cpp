@@ -0,0 +1,118 @@
+/*********************                                                        */
+/*! \file multi_term_translator.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Class for translating terms from one solver to several solvers
+**        at once.
+**
+**/
+
+#include "multi_term_translator.h"
+
+#include <exception>
+#include <thread>
+
+using namespace std;
+
+namespace smt {
+
+MultiTermTranslator::MultiTermTranslator(const vector<SmtSolver> & solvers)
+{
+  targets.reserve(solvers.size());
+  for (const SmtSolver & s : solvers)
+  {
+    // same restriction as TermTranslator
+    if (s->get_solver_enum() == SolverEnum::GENERIC_SOLVER)
+    {
+      throw SmtException("Generic Solvers do not support term transfer");
+    }
+    targets.emplace_back(s);
+  }
+}
+
+void MultiTermTranslator::prepare(const TermVec & terms)
+{
+  for (const Term & t : terms)
+  {
+    dag.add_term(t);
+  }
+}
+
+void MultiTermTranslator::replay(size_t i) { targets.at(i).build(dag.view()); }
+
+Term MultiTermTranslator::get_term(size_t i, const Term & term) const
+{
+  const TermDagBuilder & target = targets.at(i);
+  uint32_t id = dag.get_index(term);
+  if (id >= target.size())
+  {
+    throw IncorrectUsageException("Term was not replayed in target "
+                                  + std::to_string(i));
+  }
+  return target.get_term(id);
+}
+
+Term MultiTermTranslator::get_term(size_t i,
+                                   const Term & term,
+                                   const SortKind sk) const
+{
+  return targets.at(i).cast_sort_kind(get_term(i, term), sk);
+}
+
+TermVec MultiTermTranslator::transfer_term(const Term & term)
+{
+  prepare({ term });
+
+  vector<exception_ptr> errors(targets.size());
+  vector<thread> threads;
+  threads.reserve(targets.size());
+  for (size_t i = 0; i < targets.size(); ++i)
+  {
+    threads.emplace_back([this, i, &errors]() {
+      try
+      {
+        replay(i);
+      }
+      catch (...)
+      {
+        errors[i] = current_exception();
+      }
+    });
+  }
+  for (thread & t : threads)
+  {
+    t.join();
+  }
+
+  TermVec res;
+  res.reserve(targets.size());
+  for (size_t i = 0; i < targets.size(); ++i)
+  {
+    if (errors[i])
+    {
+      rethrow_exception(errors[i]);
+    }
+    res.push_back(get_term(i, term));
+  }
+  return res;
+}
+
+TermVec MultiTermTranslator::transfer_term(const Term & term,
+                                           const SortKind sk)
+{
+  TermVec res = transfer_term(term);
+  for (size_t i = 0; i < res.size(); ++i)
+  {
+    res[i] = targets[i].cast_sort_kind(res[i], sk);
+  }
+  return res;
+}
+
+}  // namespace smt
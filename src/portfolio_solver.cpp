@@ -9,59 +9,881 @@
 ** All rights reserved.  See the file LICENSE in the top-level source
 ** directory for licensing information.\endverbatim
 **
-** \brief Implementation of a portfolio solving function that takes a vector
-**        of solvers and a term, and returns check_sat from the first solver
-**        that finishes.
+** \brief A solver that races several solvers on every query, and answers
+**        with the first one that finishes.
 **/
 
 #include "portfolio_solver.h"
 
-#include <unistd.h>
+#include <time.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "assert.h"
+
 namespace smt {
 
+// how often losers that are not done yet are interrupted again
+// (an interrupt before a query starts has no effect)
+static const std::chrono::milliseconds INTERRUPT_PERIOD(10);
+
+static SolverEnum first_solver_enum(const std::vector<SmtSolver> & slvrs)
+{
+  if (slvrs.empty())
+  {
+    throw IncorrectUsageException("PortfolioSolver needs at least one solver");
+  }
+  return slvrs[0]->get_solver_enum();
+}
+
+PortfolioSolver::PortfolioSolver(const SmtSolver & src,
+                                 std::vector<SmtSolver> members)
+    : AbsSmtSolver(src->get_solver_enum()),
+      source(src),
+      solvers(std::move(members)),
+      portfolio_term_asserted(false),
+      translator(new MultiTermTranslator(solvers)),
+      back_translators(solvers.size()),
+      applied(solvers.size(), 0),
+      context_level(0),
+      last_query_assuming(false),
+      member_assumptions(solvers.size()),
+      num_launched(solvers.size()),
+      time_slice(0),
+      interruptible(solvers.size(), true),
+      winner(solvers.size()),
+      num_running(0),
+      solve_time(0),
+      cpu_time(0)
+{
+  first_solver_enum(solvers);
+  for (const SmtSolver & s : solvers)
+  {
+    member_names.push_back(to_string(s->get_solver_enum()));
+  }
+}
+
 PortfolioSolver::PortfolioSolver(std::vector<SmtSolver> slvrs, Term trm)
-    : solvers(slvrs), portfolio_term(trm)
+    : AbsSmtSolver(first_solver_enum(slvrs)),
+      solvers(std::move(slvrs)),
+      portfolio_term(trm),
+      portfolio_term_asserted(false),
+      translator(new MultiTermTranslator(solvers)),
+      back_translators(solvers.size()),
+      applied(solvers.size(), 0),
+      context_level(0),
+      last_query_assuming(false),
+      member_assumptions(solvers.size()),
+      num_launched(solvers.size()),
+      time_slice(0),
+      interruptible(solvers.size(), true),
+      winner(solvers.size()),
+      num_running(0),
+      solve_time(0),
+      cpu_time(0)
 {
+  for (const SmtSolver & s : solvers)
+  {
+    member_names.push_back(to_string(s->get_solver_enum()));
+  }
 }
-/** Translate the term t to the solver s, and check_sat.
- *  @param s The solver to translate the term t to.
- *  @param t The term being translated to solver s.
- */
-void PortfolioSolver::run_solver(SmtSolver s)
+
+PortfolioSolver::~PortfolioSolver() { join_all(); }
+
+smt::Result PortfolioSolver::portfolio_solve()
+{
+  if (!portfolio_term_asserted)
+  {
+    assert_formula(portfolio_term);
+    portfolio_term_asserted = true;
+  }
+  return check_sat();
+}
+
+size_t PortfolioSolver::get_winner() const
+{
+  get_winning_solver();
+  return winner;
+}
+
+std::chrono::duration<double> PortfolioSolver::get_solve_time() const
 {
-  TermTranslator to_s(s);
-  Term a = to_s.transfer_term(portfolio_term, smt::BOOL);
-  s->assert_formula(a);
-  result = s->check_sat();
   std::lock_guard<std::mutex> lk(m);
-  a_solver_is_done = true;
+  return solve_time;
+}
 
-  cv.notify_all();
+void PortfolioSolver::set_selector(std::shared_ptr<SolverSelector> sel,
+                                   size_t k,
+                                   double slice)
+{
+  if (!k)
+  {
+    throw IncorrectUsageException(
+        "PortfolioSolver must launch at least one solver");
+  }
+  selector = sel;
+  num_launched = std::min(k, solvers.size());
+  time_slice = slice;
+
+  interruptible.assign(solvers.size(), true);
+  if (time_slice > 0)
+  {
+    join_all();
+    for (size_t i = 0; i < solvers.size(); ++i)
+    {
+      try
+      {
+        // no effect, no query is running
+        solvers[i]->interrupt();
+      }
+      catch (NotImplementedException & e)
+      {
+        interruptible[i] = false;
+      }
+    }
+  }
+}
+
+std::chrono::duration<double> PortfolioSolver::get_cpu_time() const
+{
+  std::lock_guard<std::mutex> lk(m);
+  return cpu_time;
+}
+
+/* forwarded to all the members */
+
+void PortfolioSolver::set_opt(const std::string option, const std::string value)
+{
+  join_all();
+  for (const SmtSolver & s : solvers)
+  {
+    s->set_opt(option, value);
+  }
+}
+
+void PortfolioSolver::set_logic(const std::string logic)
+{
+  join_all();
+  for (const SmtSolver & s : solvers)
+  {
+    s->set_logic(logic);
+  }
+}
+
+void PortfolioSolver::assert_formula(const Term & t)
+{
+  wait_synced();
+  translator->prepare({ t });
+  commands.push_back({ ASSERT_CMD, t, 0 });
+  if (selector)
+  {
+    features.add_term(t);
+  }
+}
+
+void PortfolioSolver::push(uint64_t num)
+{
+  wait_synced();
+  commands.push_back({ PUSH_CMD, Term(), num });
+  context_level += num;
+}
+
+void PortfolioSolver::pop(uint64_t num)
+{
+  if (num > context_level)
+  {
+    throw IncorrectUsageException("Cannot pop " + std::to_string(num)
+                                  + " contexts at context level "
+                                  + std::to_string(context_level));
+  }
+  wait_synced();
+  commands.push_back({ POP_CMD, Term(), num });
+  context_level -= num;
+}
+
+uint64_t PortfolioSolver::get_context_level() const { return context_level; }
+
+void PortfolioSolver::reset()
+{
+  join_all();
+  if (source)
+  {
+    source->reset();
+  }
+  for (const SmtSolver & s : solvers)
+  {
+    s->reset();
+  }
+  translator.reset(new MultiTermTranslator(solvers));
+  for (auto & bt : back_translators)
+  {
+    bt.reset();
+  }
+  commands.clear();
+  applied.assign(solvers.size(), 0);
+  context_level = 0;
+  last_query_assuming = false;
+  assumptions.clear();
+  features.clear();
+  portfolio_term_asserted = false;
+  winner = solvers.size();
+}
+
+void PortfolioSolver::reset_assertions()
+{
+  wait_synced();
+  commands.push_back({ RESET_ASSERTIONS_CMD, Term(), 0 });
+  context_level = 0;
+  features.clear();
+}
+
+void PortfolioSolver::interrupt()
+{
+  std::vector<size_t> running;
+  {
+    std::lock_guard<std::mutex> lk(m);
+    for (size_t i = 0; i < done.size(); ++i)
+    {
+      if (!done[i])
+      {
+        running.push_back(i);
+      }
+    }
+  }
+  for (size_t i : running)
+  {
+    try
+    {
+      solvers[i]->interrupt();
+    }
+    catch (NotImplementedException & e)
+    {
+      // it will finish on its own
+    }
+  }
+}
+
+/* solving */
+
+Result PortfolioSolver::check_sat() { return race(false, {}); }
+
+Result PortfolioSolver::check_sat_assuming(const TermVec & assumptions)
+{
+  return race(true, assumptions);
+}
+
+Result PortfolioSolver::check_sat_assuming_list(const TermList & assumptions)
+{
+  return race(true, TermVec(assumptions.begin(), assumptions.end()));
+}
+
+Result PortfolioSolver::check_sat_assuming_set(
+    const UnorderedTermSet & assumptions)
+{
+  return race(true, TermVec(assumptions.begin(), assumptions.end()));
+}
+
+void PortfolioSolver::sync_member(size_t i)
+{
+  translator->replay(i);
+  const SmtSolver & s = solvers[i];
+  for (size_t & k = applied[i]; k < commands.size(); ++k)
+  {
+    const PortfolioCommand & c = commands[k];
+    switch (c.kind)
+    {
+      case ASSERT_CMD:
+        s->assert_formula(translator->get_term(i, c.term, BOOL));
+        break;
+      case PUSH_CMD: s->push(c.num); break;
+      case POP_CMD: s->pop(c.num); break;
+      default:
+        assert(c.kind == RESET_ASSERTIONS_CMD);
+        s->reset_assertions();
+        break;
+    }
+  }
 }
 
-/** Launch many solvers and return whether the term is satisfiable when one of
- *  them has finished.
- *  @param solvers The solvers to run.
- *  @param t The term to be checked.
+// CPU time of the calling thread
+static std::chrono::duration<double> thread_cpu_time()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+/** Catch up with the commands in the solver with index i, and check_sat.
+ *  @param i The index of the solver.
  */
-smt::Result PortfolioSolver::portfolio_solve()
+void PortfolioSolver::run_solver(size_t i)
+{
+  auto wall_start = std::chrono::steady_clock::now();
+  auto cpu_start = thread_cpu_time();
+  smt::Result r;
+  std::exception_ptr error;
+  try
+  {
+    // only uses the solver i, the source DAG was walked by the main thread
+    sync_member(i);
+    TermVec & massumps = member_assumptions[i];
+    massumps.clear();
+    if (last_query_assuming)
+    {
+      for (const Term & a : assumptions)
+      {
+        massumps.push_back(translator->get_term(i, a, BOOL));
+      }
+    }
+
+    bool lost;
+    {
+      std::lock_guard<std::mutex> lk(m);
+      synced[i] = true;
+      lost = winner != solvers.size();
+    }
+    cv.notify_all();
+
+    const SmtSolver & s = solvers[i];
+    if (lost)
+    {
+      r = smt::Result(UNKNOWN, "Interrupted.");
+    }
+    else
+    {
+      r = last_query_assuming ? s->check_sat_assuming(massumps)
+                              : s->check_sat();
+    }
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  auto cpu = thread_cpu_time() - cpu_start;
+  std::lock_guard<std::mutex> lk(m);
+  results[i] = r;
+  errors[i] = error;
+  member_seconds[i] = std::chrono::duration<double>(now - wall_start).count();
+  cpu_time += cpu;
+  synced[i] = true;
+  done[i] = true;
+  --num_running;
+  if (winner == solvers.size() && (r.is_sat() || r.is_unsat()))
+  {
+    winner = i;
+    result = r;
+    solve_time = now - start_time;
+  }
+  cv.notify_all();
+}
+
+Result PortfolioSolver::race(bool assuming, const TermVec & assumps)
 {
-  // We must maintain a vector of pthreads in order to stop the threads that are
-  // still running once one of the solvers finish because pthreads is assumed to
-  // be the underlying implementation.
-  for (auto s : solvers)
+  // the members of a previous query must be done before reusing them
+  join_all();
+
+  // forget the commands that all the members applied
+  size_t num_applied = *std::min_element(applied.begin(), applied.end());
+  commands.erase(commands.begin(), commands.begin() + num_applied);
+  for (size_t & k : applied)
   {
-    // Start a thread, store its handle, and detach the thread because we are
-    // not interested in waiting for all of them to finish.
-    std::thread t1(&PortfolioSolver::run_solver, this, s);
-    t1.detach();
+    k -= num_applied;
+  }
+
+  last_query_assuming = assuming;
+  assumptions = assumps;
+  // walk the terms once, instead of once per thread
+  translator->prepare(assumptions);
+
+  size_t n = solvers.size();
+  {
+    std::lock_guard<std::mutex> lk(m);
+    winner = n;
+    results.assign(n, smt::Result());
+    errors.assign(n, nullptr);
+    member_seconds.assign(n, 0);
+    result = smt::Result();
+    start_time = std::chrono::steady_clock::now();
+  }
+
+  // the members to launch, best first
+  std::vector<size_t> order;
+  std::string bucket;
+  if (selector)
+  {
+    bucket = features.get_bucket();
+    order = selector->rank(bucket, member_names);
+    order.resize(num_launched);
+  }
+  else
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      order.push_back(i);
+    }
+  }
+
+  LaunchOutcome out;
+  out.winner = n;
+  out.results.assign(n, smt::Result());
+  out.errors.assign(n, nullptr);
+  out.member_seconds.assign(n, 0);
+
+  std::vector<size_t> launched;
+  if (time_slice > 0)
+  {
+    // a member that cannot be interrupted would outlive its slice
+    std::stable_partition(order.begin(), order.end(), [this](size_t i) {
+      return interruptible[i];
+    });
+    for (size_t j = 0; j < order.size() && out.winner == n; ++j)
+    {
+      bool last = j + 1 == order.size() || !interruptible[order[j]];
+      launched.push_back(order[j]);
+      launch({ order[j] }, last ? 0 : time_slice, out);
+    }
+  }
+  else
+  {
+    launched = order;
+    launch(launched, 0, out);
+  }
+
+  if (out.winner == n)
+  {
+    std::lock_guard<std::mutex> lk(m);
+    solve_time = std::chrono::steady_clock::now() - start_time;
+  }
+
+  if (selector)
+  {
+    for (size_t i : launched)
+    {
+      selector->record(
+          bucket, member_names[i], i == out.winner, out.member_seconds[i]);
+    }
+  }
+
+  if (out.winner != n)
+  {
+    return out.result;
+  }
+
+  // no definitive answer
+  for (size_t i : launched)
+  {
+    if (!out.errors[i])
+    {
+      return out.results[i];
+    }
+  }
+  std::rethrow_exception(out.errors[launched[0]]);
+}
+
+void PortfolioSolver::launch(const std::vector<size_t> & launched,
+                             double timeout,
+                             LaunchOutcome & out)
+{
+  join_all();
+
+  size_t n = solvers.size();
+  {
+    std::lock_guard<std::mutex> lk(m);
+    num_running = launched.size();
+    // the other members are not part of this launch
+    synced.assign(n, true);
+    done.assign(n, true);
+    for (size_t i : launched)
+    {
+      synced[i] = false;
+      done[i] = false;
+    }
+  }
+  threads.resize(n);
+  for (size_t i : launched)
+  {
+    threads[i] = std::thread(&PortfolioSolver::run_solver, this, i);
   }
 
-  // Wait until a solver is done to cancel the threads that are still running.
   std::unique_lock<std::mutex> lk(m);
-  while (!a_solver_is_done) cv.wait(lk);
+  auto finished = [this, n] { return winner != n || !num_running; };
+  if (timeout > 0)
+  {
+    cv.wait_for(lk, std::chrono::duration<double>(timeout), finished);
+  }
+  else
+  {
+    cv.wait(lk, finished);
+  }
 
-  return result;
+  // interrupt the losers until they are done
+  // except the ones that cannot be interrupted
+  std::vector<bool> uninterruptible(n, false);
+  while (true)
+  {
+    std::vector<size_t> to_interrupt;
+    for (size_t i : launched)
+    {
+      if (!done[i] && !uninterruptible[i])
+      {
+        to_interrupt.push_back(i);
+      }
+    }
+    if (to_interrupt.empty())
+    {
+      break;
+    }
+
+    lk.unlock();
+    for (size_t i : to_interrupt)
+    {
+      try
+      {
+        solvers[i]->interrupt();
+      }
+      catch (NotImplementedException & e)
+      {
+        uninterruptible[i] = true;
+      }
+    }
+    lk.lock();
+    cv.wait_for(lk, INTERRUPT_PERIOD, [this] { return !num_running; });
+  }
+
+  // still holding m
+  out.winner = winner;
+  out.result = result;
+  for (size_t i : launched)
+  {
+    out.results[i] = results[i];
+    out.errors[i] = errors[i];
+    out.member_seconds[i] = member_seconds[i];
+  }
+
+  for (size_t i : launched)
+  {
+    if (done[i])
+    {
+      threads[i].join();
+    }
+  }
+}
+
+void PortfolioSolver::wait_synced() const
+{
+  std::unique_lock<std::mutex> lk(m);
+  cv.wait(lk, [this] {
+    for (size_t i = 0; i < synced.size(); ++i)
+    {
+      if (!synced[i] && !done[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+void PortfolioSolver::join_all()
+{
+  for (std::thread & t : threads)
+  {
+    if (t.joinable())
+    {
+      t.join();
+    }
+  }
+}
+
+/* answered by the winner */
+
+const SmtSolver & PortfolioSolver::get_winning_solver() const
+{
+  if (winner >= solvers.size())
+  {
+    throw IncorrectUsageException(
+        "No member of the portfolio answered sat or unsat in the last query");
+  }
+  return solvers[winner];
+}
+
+Term PortfolioSolver::to_source(const Term & t, SortKind sk) const
+{
+  std::unique_ptr<TermTranslator> & bt = back_translators[winner];
+  if (!bt)
+  {
+    bt.reset(new TermTranslator(get_source()));
+  }
+  return bt->transfer_term(t, sk);
+}
+
+Term PortfolioSolver::get_value(const Term & t) const
+{
+  const SmtSolver & s = get_winning_solver();
+  // the winner is done, but t may be new
+  wait_synced();
+  translator->prepare({ t });
+  translator->replay(winner);
+  Term val = s->get_value(translator->get_term(winner, t));
+  return to_source(val, t->get_sort()->get_sort_kind());
+}
+
+UnorderedTermMap PortfolioSolver::get_array_values(const Term & arr,
+                                                   Term & out_const_base) const
+{
+  const SmtSolver & s = get_winning_solver();
+  wait_synced();
+  translator->prepare({ arr });
+  translator->replay(winner);
+
+  Term base;
+  UnorderedTermMap vals =
+      s->get_array_values(translator->get_term(winner, arr), base);
+
+  Sort arrsort = arr->get_sort();
+  SortKind idx_sk = arrsort->get_indexsort()->get_sort_kind();
+  SortKind elem_sk = arrsort->get_elemsort()->get_sort_kind();
+  UnorderedTermMap res;
+  for (const auto & elem : vals)
+  {
+    res[to_source(elem.first, idx_sk)] = to_source(elem.second, elem_sk);
+  }
+  if (base)
+  {
+    out_const_base = to_source(base, elem_sk);
+  }
+  return res;
+}
+
+void PortfolioSolver::get_unsat_assumptions(UnorderedTermSet & out)
+{
+  const SmtSolver & s = get_winning_solver();
+  if (!last_query_assuming)
+  {
+    throw IncorrectUsageException(
+        "get_unsat_assumptions must follow a call to check_sat_assuming");
+  }
+
+  UnorderedTermSet core;
+  s->get_unsat_assumptions(core);
+
+  // map back to the assumptions as given
+  const TermVec & massumps = member_assumptions[winner];
+  std::unordered_map<Term, size_t> index;
+  for (size_t i = 0; i < massumps.size(); ++i)
+  {
+    index.emplace(massumps[i], i);
+  }
+  for (const Term & c : core)
+  {
+    auto it = index.find(c);
+    out.insert(it != index.end() ? assumptions[it->second]
+                                 : to_source(c, BOOL));
+  }
+}
+
+/* dispatched to the source solver */
+
+const SmtSolver & PortfolioSolver::get_source() const
+{
+  if (!source)
+  {
+    throw IncorrectUsageException(
+        "This PortfolioSolver was created without a source solver");
+  }
+  return source;
+}
+
+Sort PortfolioSolver::make_sort(const std::string name, uint64_t arity) const
+{
+  return get_source()->make_sort(name, arity);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk) const
+{
+  return get_source()->make_sort(sk);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk, uint64_t size) const
+{
+  return get_source()->make_sort(sk, size);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk, const Sort & sort1) const
+{
+  return get_source()->make_sort(sk, sort1);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk,
+                                const Sort & sort1,
+                                const Sort & sort2) const
+{
+  return get_source()->make_sort(sk, sort1, sort2);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk,
+                                const Sort & sort1,
+                                const Sort & sort2,
+                                const Sort & sort3) const
+{
+  return get_source()->make_sort(sk, sort1, sort2, sort3);
+}
+
+Sort PortfolioSolver::make_sort(const SortKind sk, const SortVec & sorts) const
+{
+  return get_source()->make_sort(sk, sorts);
+}
+
+Sort PortfolioSolver::make_sort(const Sort & sort_con,
+                                const SortVec & sorts) const
+{
+  return get_source()->make_sort(sort_con, sorts);
+}
+
+Sort PortfolioSolver::make_sort(const DatatypeDecl & d) const
+{
+  return get_source()->make_sort(d);
+}
+
+DatatypeDecl PortfolioSolver::make_datatype_decl(const std::string & s)
+{
+  return get_source()->make_datatype_decl(s);
+}
+
+DatatypeConstructorDecl PortfolioSolver::make_datatype_constructor_decl(
+    const std::string s)
+{
+  return get_source()->make_datatype_constructor_decl(s);
+}
+
+void PortfolioSolver::add_constructor(DatatypeDecl & dt,
+                                      const DatatypeConstructorDecl & con) const
+{
+  get_source()->add_constructor(dt, con);
+}
+
+void PortfolioSolver::add_selector(DatatypeConstructorDecl & dt,
+                                   const std::string & name,
+                                   const Sort & s) const
+{
+  get_source()->add_selector(dt, name, s);
+}
+
+void PortfolioSolver::add_selector_self(DatatypeConstructorDecl & dt,
+                                        const std::string & name) const
+{
+  get_source()->add_selector_self(dt, name);
+}
+
+Term PortfolioSolver::get_constructor(const Sort & s, std::string name) const
+{
+  return get_source()->get_constructor(s, name);
+}
+
+Term PortfolioSolver::get_tester(const Sort & s, std::string name) const
+{
+  return get_source()->get_tester(s, name);
+}
+
+Term PortfolioSolver::get_selector(const Sort & s,
+                                   std::string con,
+                                   std::string name) const
+{
+  return get_source()->get_selector(s, con, name);
+}
+
+Term PortfolioSolver::make_term(bool b) const
+{
+  return get_source()->make_term(b);
+}
+
+Term PortfolioSolver::make_term(int64_t i, const Sort & sort) const
+{
+  return get_source()->make_term(i, sort);
+}
+
+Term PortfolioSolver::make_term(const std::string & s,
+                                bool useEscSequences,
+                                const Sort & sort) const
+{
+  return get_source()->make_term(s, useEscSequences, sort);
+}
+
+Term PortfolioSolver::make_term(const std::wstring & s, const Sort & sort) const
+{
+  return get_source()->make_term(s, sort);
+}
+
+Term PortfolioSolver::make_term(const std::string val,
+                                const Sort & sort,
+                                uint64_t base) const
+{
+  return get_source()->make_term(val, sort, base);
+}
+
+Term PortfolioSolver::make_term(const BVValue & val, const Sort & sort) const
+{
+  return get_source()->make_term(val, sort);
+}
+
+Term PortfolioSolver::make_term(const Term & val, const Sort & sort) const
+{
+  return get_source()->make_term(val, sort);
+}
+
+Term PortfolioSolver::make_symbol(const std::string name, const Sort & sort)
+{
+  return get_source()->make_symbol(name, sort);
+}
+
+Term PortfolioSolver::get_symbol(const std::string & name)
+{
+  return get_source()->get_symbol(name);
+}
+
+Term PortfolioSolver::make_param(const std::string name, const Sort & sort)
+{
+  return get_source()->make_param(name, sort);
+}
+
+Term PortfolioSolver::make_term(const Op op, const Term & t) const
+{
+  return get_source()->make_term(op, t);
+}
+
+Term PortfolioSolver::make_term(const Op op,
+                                const Term & t0,
+                                const Term & t1) const
+{
+  return get_source()->make_term(op, t0, t1);
+}
+
+Term PortfolioSolver::make_term(const Op op,
+                                const Term & t0,
+                                const Term & t1,
+                                const Term & t2) const
+{
+  return get_source()->make_term(op, t0, t1, t2);
+}
+
+Term PortfolioSolver::make_term(const Op op, const TermVec & terms) const
+{
+  return get_source()->make_term(op, terms);
+}
+
+Term PortfolioSolver::substitute(const Term term,
+                                 const UnorderedTermMap & substitution_map) const
+{
+  return get_source()->substitute(term, substitution_map);
+}
+
+TermVec PortfolioSolver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
+{
+  return get_source()->substitute_terms(terms, substitution_map);
 }
 
 }  // namespace smt
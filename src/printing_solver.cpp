@@ -146,6 +146,11 @@ Term PrintingSolver::make_term(const string name,
   return wrapped_solver->make_term(name, sort, base);
 }
 
+Term PrintingSolver::make_term(const BVValue & val, const Sort & sort) const
+{
+  return wrapped_solver->make_term(val, sort);
+}
+
 Term PrintingSolver::make_term(const Term & val, const Sort & sort) const
 {
   return wrapped_solver->make_term(val, sort);
@@ -280,6 +285,8 @@ void PrintingSolver::reset_assertions() {
   wrapped_solver->reset_assertions(); 
 }
 
+void PrintingSolver::interrupt() { wrapped_solver->interrupt(); }
+
 Result PrintingSolver::get_interpolant(const Term & A,
                                        const Term & B,
                                        Term & out_I) const
@@ -0,0 +1,553 @@
+/*********************                                                        */
+/*! \file smtlib_prescan.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-independent pre-scanning of SMT-LIB text, used by
+**        SmtLibReader::parse_parallel to parse assertions on several
+**        threads.
+**
+**/
+
+#include "smtlib_prescan.h"
+
+#include <unordered_map>
+
+using namespace std;
+
+namespace smt {
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool is_delimiter(char c)
+{
+  return is_space(c) || c == '(' || c == ')' || c == ';' || c == '"'
+         || c == '|';
+}
+
+static bool is_digits(string_view s)
+{
+  if (s.empty())
+  {
+    return false;
+  }
+  for (char c : s)
+  {
+    if (c < '0' || c > '9')
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// parses a numeral that fits in 60 bits, returns false otherwise
+static bool to_index(string_view s, uint64_t & res)
+{
+  if (!is_digits(s) || s.size() > 18)
+  {
+    return false;
+  }
+  res = 0;
+  for (char c : s)
+  {
+    res = 10 * res + (c - '0');
+  }
+  return true;
+}
+
+// removes the bars of a quoted symbol
+static string_view unquote(string_view s)
+{
+  if (s.size() >= 2 && s.front() == '|' && s.back() == '|')
+  {
+    return s.substr(1, s.size() - 2);
+  }
+  return s;
+}
+
+/** Skips whitespace and comments
+ *  @return the position of the next token, or text.size()
+ */
+static size_t skip_space(string_view text, size_t i, size_t & line)
+{
+  size_t n = text.size();
+  while (i < n)
+  {
+    if (text[i] == '\n')
+    {
+      ++line;
+    }
+    else if (text[i] == ';')
+    {
+      while (i < n && text[i] != '\n')
+      {
+        ++i;
+      }
+      continue;
+    }
+    else if (!is_space(text[i]))
+    {
+      break;
+    }
+    ++i;
+  }
+  return i;
+}
+
+/** Skips a quoted symbol or a string literal (same as the scanner)
+ *  @param i the position of the opening quote
+ *  @return the position after the closing quote, or text.size()
+ */
+static size_t skip_quoted(string_view text, size_t i, size_t & line)
+{
+  char quote = text[i++];
+  size_t n = text.size();
+  while (i < n && text[i] != quote)
+  {
+    if (text[i] == '\n')
+    {
+      ++line;
+    }
+    else if (text[i] == '\\' && quote == '"' && i + 1 < n)
+    {
+      ++i;
+      if (text[i] == '\n')
+      {
+        ++line;
+      }
+    }
+    ++i;
+  }
+  return i < n ? i + 1 : n;
+}
+
+/** Skips an atom
+ *  @return the position after it
+ */
+static size_t skip_atom(string_view text, size_t i, size_t & line)
+{
+  if (text[i] == '|' || text[i] == '"')
+  {
+    return skip_quoted(text, i, line);
+  }
+  size_t n = text.size();
+  while (i < n && !is_delimiter(text[i]))
+  {
+    ++i;
+  }
+  return i;
+}
+
+vector<SmtLibCommand> split_smtlib_commands(string_view text)
+{
+  vector<SmtLibCommand> res;
+  size_t n = text.size();
+  size_t line = 1;
+  size_t i = skip_space(text, 0, line);
+  while (i < n)
+  {
+    SmtLibCommand cmd;
+    cmd.line = line;
+    size_t start = i;
+    if (text[i] != '(')
+    {
+      // leave the rest to the parser
+      cmd.text = text.substr(start);
+      res.push_back(cmd);
+      break;
+    }
+
+    // the keyword
+    size_t kw_start = skip_space(text, i + 1, line);
+    size_t kw_end = kw_start;
+    if (kw_start < n && !is_delimiter(text[kw_start]))
+    {
+      kw_end = skip_atom(text, kw_start, line);
+    }
+    i = kw_end;
+
+    // the matching parenthesis
+    size_t depth = 1;
+    while (i < n && depth)
+    {
+      char c = text[i];
+      if (c == '(')
+      {
+        ++depth;
+        ++i;
+      }
+      else if (c == ')')
+      {
+        --depth;
+        ++i;
+      }
+      else if (c == '|' || c == '"')
+      {
+        i = skip_quoted(text, i, line);
+      }
+      else if (c == ';' || is_space(c))
+      {
+        i = skip_space(text, i, line);
+      }
+      else
+      {
+        ++i;
+      }
+    }
+
+    cmd.text = text.substr(start, i - start);
+    if (!depth)
+    {
+      cmd.keyword = text.substr(kw_start, kw_end - kw_start);
+      cmd.body = text.substr(kw_end, i - 1 - kw_end);
+    }
+    res.push_back(cmd);
+    i = skip_space(text, i, line);
+  }
+  return res;
+}
+
+void SmtLibTermDag::clear()
+{
+  sexprs.clear();
+  sexpr_children.clear();
+  nodes.clear();
+  children.clear();
+}
+
+bool SmtLibTermDag::parse(string_view term)
+{
+  clear();
+  bool res = read_sexprs(term) && convert();
+  // the s-expressions are not needed anymore
+  sexprs.clear();
+  sexpr_children.clear();
+  return res;
+}
+
+bool SmtLibTermDag::read_sexprs(string_view text)
+{
+  // the children read so far of the open lists, and where each list's
+  // children start
+  vector<uint32_t> pending;
+  vector<size_t> starts;
+  size_t line = 0;  // not used
+  size_t n = text.size();
+  size_t i = skip_space(text, 0, line);
+  while (i < n)
+  {
+    if (sexprs.size() && starts.empty())
+    {
+      // more than one term
+      return false;
+    }
+
+    char c = text[i];
+    if (c == '(')
+    {
+      starts.push_back(pending.size());
+      ++i;
+    }
+    else if (c == ')')
+    {
+      if (starts.empty())
+      {
+        return false;
+      }
+      size_t start = starts.back();
+      starts.pop_back();
+      SExpr e{ string_view(), (uint32_t)sexpr_children.size(),
+               (uint32_t)(pending.size() - start) };
+      sexpr_children.insert(
+          sexpr_children.end(), pending.begin() + start, pending.end());
+      pending.resize(start);
+      pending.push_back(sexprs.size());
+      sexprs.push_back(e);
+      ++i;
+    }
+    else if (c == '"')
+    {
+      // string literals are not supported
+      return false;
+    }
+    else
+    {
+      size_t end = skip_atom(text, i, line);
+      pending.push_back(sexprs.size());
+      sexprs.push_back({ text.substr(i, end - i), 0, 0 });
+      i = end;
+    }
+    i = skip_space(text, i, line);
+  }
+  return starts.empty() && sexprs.size();
+}
+
+bool SmtLibTermDag::add_atom(string_view atom)
+{
+  SmtLibTermNode node{ SMTLIB_SYMBOL, 0, atom, 0, 0, 0, 0 };
+  char c = atom[0];
+  if (c == '|')
+  {
+    if (atom.size() < 2 || atom.back() != '|')
+    {
+      return false;
+    }
+    node.text = unquote(atom);
+  }
+  else if (c >= '0' && c <= '9')
+  {
+    size_t dot = atom.find('.');
+    if (dot == string_view::npos && is_digits(atom))
+    {
+      node.kind = SMTLIB_NUMERAL;
+    }
+    else if (dot != string_view::npos && is_digits(atom.substr(0, dot))
+             && is_digits(atom.substr(dot + 1)))
+    {
+      node.kind = SMTLIB_DECIMAL;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  else if (c == '#')
+  {
+    if (atom.size() < 3)
+    {
+      return false;
+    }
+    node.text = atom.substr(2);
+    if (atom[1] == 'b'
+             && node.text.find_first_not_of("01") == string_view::npos)
+    {
+      node.kind = SMTLIB_BINARY;
+    }
+    else if (atom[1] == 'x'
+             && node.text.find_first_not_of("0123456789abcdefABCDEF")
+                    == string_view::npos)
+    {
+      node.kind = SMTLIB_HEX;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  else if (c == ':')
+  {
+    return false;
+  }
+  nodes.push_back(node);
+  return true;
+}
+
+bool SmtLibTermDag::convert()
+{
+  // stage 0 is before the children are converted
+  // for applications, stage 1 is after the arguments are converted
+  // for lets, stage j is after binding j - 1 is converted,
+  // and stage (number of bindings + 1) is after the body is converted
+  struct Task
+  {
+    uint32_t sexpr;
+    uint32_t stage;
+  };
+  vector<Task> tasks{ { (uint32_t)sexprs.size() - 1, 0 } };
+  // the nodes of the converted terms
+  vector<uint32_t> values;
+  // the let-bound names, to the nodes of their terms
+  unordered_map<string_view, uint32_t> bound;
+
+  auto child = [this](const SExpr & e, size_t i) -> const SExpr & {
+    return sexprs[sexpr_children[e.first_child + i]];
+  };
+  auto child_id = [this](const SExpr & e, size_t i) {
+    return sexpr_children[e.first_child + i];
+  };
+  auto is_atom = [](const SExpr & e) { return !e.atom.empty(); };
+
+  while (tasks.size())
+  {
+    Task t = tasks.back();
+    tasks.pop_back();
+    const SExpr & e = sexprs[t.sexpr];
+
+    if (is_atom(e))
+    {
+      auto it = bound.find(unquote(e.atom));
+      if (it != bound.end())
+      {
+        values.push_back(it->second);
+      }
+      else if (add_atom(e.atom))
+      {
+        values.push_back(nodes.size() - 1);
+      }
+      else
+      {
+        return false;
+      }
+      continue;
+    }
+
+    if (!e.num_children)
+    {
+      return false;
+    }
+    const SExpr & head = child(e, 0);
+
+    if (is_atom(head) && head.atom == "let")
+    {
+      if (e.num_children != 3 || is_atom(child(e, 1)))
+      {
+        return false;
+      }
+      const SExpr & bindings = child(e, 1);
+      size_t num_bindings = bindings.num_children;
+      if (!num_bindings)
+      {
+        return false;
+      }
+
+      if (t.stage == 0)
+      {
+        // check the bindings
+        for (size_t j = 0; j < num_bindings; ++j)
+        {
+          const SExpr & b = child(bindings, j);
+          if (is_atom(b) || b.num_children != 2 || !is_atom(child(b, 0)))
+          {
+            return false;
+          }
+        }
+      }
+      else if (t.stage <= num_bindings)
+      {
+        // bind the converted term, later bindings and the body see it
+        // (same as SmtLibReader::let_binding)
+        string_view name = unquote(child(child(bindings, t.stage - 1), 0).atom);
+        if (!bound.emplace(name, values.back()).second)
+        {
+          // shadowing, let the parser report it
+          return false;
+        }
+        values.pop_back();
+      }
+      else
+      {
+        // the body is converted, unbind
+        for (size_t j = 0; j < num_bindings; ++j)
+        {
+          bound.erase(unquote(child(child(bindings, j), 0).atom));
+        }
+        continue;
+      }
+
+      tasks.push_back({ t.sexpr, t.stage + 1 });
+      if (t.stage < num_bindings)
+      {
+        tasks.push_back({ child_id(child(bindings, t.stage), 1), 0 });
+      }
+      else
+      {
+        tasks.push_back({ child_id(e, 2), 0 });
+      }
+      continue;
+    }
+
+    if (is_atom(head) && head.atom == "_")
+    {
+      // (_ bvN w)
+      uint64_t width;
+      if (e.num_children != 3 || !is_atom(child(e, 1))
+          || !is_atom(child(e, 2)) || !to_index(child(e, 2).atom, width))
+      {
+        return false;
+      }
+      string_view bv = child(e, 1).atom;
+      if (bv.size() < 3 || bv.substr(0, 2) != "bv"
+          || !is_digits(bv.substr(2)))
+      {
+        return false;
+      }
+      nodes.push_back(
+          { SMTLIB_BV_DECIMAL, 0, bv.substr(2), width, 0, 0, 0 });
+      values.push_back(nodes.size() - 1);
+      continue;
+    }
+
+    SmtLibTermNode node{ SMTLIB_APPLY, 0, head.atom, 0, 0, 0, 0 };
+    if (is_atom(head))
+    {
+      char c = head.atom[0];
+      if (head.atom == "forall" || head.atom == "exists" || head.atom == "!"
+          || head.atom == "as" || head.atom == "match" || c == '"'
+          || c == ':' || c == '#' || (c >= '0' && c <= '9'))
+      {
+        return false;
+      }
+      node.text = unquote(head.atom);
+    }
+    else
+    {
+      // (_ op i) or (_ op i j)
+      if (head.num_children < 3 || head.num_children > 4
+          || !is_atom(child(head, 0)) || child(head, 0).atom != "_"
+          || !is_atom(child(head, 1)) || !is_atom(child(head, 2))
+          || !to_index(child(head, 2).atom, node.idx0)
+          || (head.num_children == 4
+              && (!is_atom(child(head, 3))
+                  || !to_index(child(head, 3).atom, node.idx1))))
+      {
+        return false;
+      }
+      node.kind = SMTLIB_INDEXED_APPLY;
+      node.text = child(head, 1).atom;
+      node.num_idx = head.num_children - 2;
+    }
+
+    if (t.stage == 0)
+    {
+      tasks.push_back({ t.sexpr, 1 });
+      for (size_t i = e.num_children - 1; i > 0; --i)
+      {
+        tasks.push_back({ child_id(e, i), 0 });
+      }
+      continue;
+    }
+
+    // the arguments are converted
+    size_t num_args = e.num_children - 1;
+    node.first_child = children.size();
+    node.num_children = num_args;
+    children.insert(children.end(), values.end() - num_args, values.end());
+    values.resize(values.size() - num_args);
+    nodes.push_back(node);
+    values.push_back(nodes.size() - 1);
+  }
+
+  // the root is the last node, unless it is a let-bound term
+  if (values.size() != 1)
+  {
+    return false;
+  }
+  if (values.back() != nodes.size() - 1)
+  {
+    // e.g. (let ((a (f x))) a), reference the root again
+    nodes.push_back(nodes[values.back()]);
+  }
+  return true;
+}
+
+}  // namespace smt
@@ -16,9 +16,19 @@
 
 #include "smtlib_reader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
 #include "assert.h"
 #include "smtlibparser.h"
 #include "smtlibparser_maps.h"
+#include "utils.h"
 
 using namespace std;
 
@@ -57,16 +67,24 @@ const unordered_map<string, vector<SortKind>> logic_sortkind_map(
       { "S", { STRING } } });
 
 SmtLibReader::SmtLibReader(smt::SmtSolver & solver, bool strict)
-    : solver_(solver),
+    : in_(nullptr),
+      interactive_(false),
+      solver_(solver),
       strict_(strict),
       logic_("UNSET"),
       allow_ufs_(false),
       def_arg_prefix_("__defvar_"),
-      // logic always includes core theory
-      primops_(strict_theory2opmap.at("Core")),
-      // always have sort Bool available
-      sortkinds_({ { "Bool", BOOL } })
+      true_(intern("true")),
+      false_(intern("false"))
 {
+  // logic always includes core theory
+  for (const auto & elem : strict_theory2opmap.at("Core"))
+  {
+    primops_[intern(elem.first)] = elem.second;
+  }
+  // always have sort Bool available
+  sortkinds_[intern("Bool")] = BOOL;
+
   // dedicated true/false symbols
   // done this way because true/false can be used in other places
   // for example, when setting options
@@ -76,7 +94,48 @@ SmtLibReader::SmtLibReader(smt::SmtSolver & solver, bool strict)
 int SmtLibReader::parse(const std::string & f)
 {
   file = f;
-  location_.initialize(&file);
+  in_ = nullptr;
+  return run_parser();
+}
+
+int SmtLibReader::parse(std::istream & in,
+                        bool interactive,
+                        const std::string & name)
+{
+  return parse_stream(in, interactive, name, 1);
+}
+
+int SmtLibReader::parse_stream(std::istream & in,
+                               bool interactive,
+                               const std::string & name,
+                               size_t line)
+{
+  file = name;
+  in_ = &in;
+  interactive_ = interactive;
+  int res;
+  try
+  {
+    res = run_parser(line);
+  }
+  catch (const SmtException & e)
+  {
+    in_ = nullptr;
+    throw;
+  }
+  in_ = nullptr;
+  return res;
+}
+
+int SmtLibReader::parse_string(const std::string & commands)
+{
+  istringstream in(commands);
+  return parse(in, false, "<string>");
+}
+
+int SmtLibReader::run_parser(size_t line)
+{
+  location_.initialize(&file, line);
   scan_begin();
   int res;
   try
@@ -96,6 +155,289 @@ int SmtLibReader::parse(const std::string & f)
   return res;
 }
 
+size_t ParsedApplicationHash::operator()(const ParsedApplication & app) const
+{
+  size_t result = hash<InternedString>()(app.head);
+  hash_combine(result, app.num_idx);
+  hash_combine(result, app.idx0);
+  hash_combine(result, app.idx1);
+  hash_combine(result, TermVecHash()(app.args));
+  return result;
+}
+
+// the commands after which the pre-parsed applications stay valid,
+// because they cannot change the meaning of a symbol
+static const unordered_set<string_view> keeps_parsed_applications(
+    { "assert",
+      "check-sat",
+      "check-sat-assuming",
+      "declare-const",
+      "declare-fun",
+      "declare-sort",
+      "echo",
+      "get-unsat-assumptions",
+      "get-value",
+      "push",
+      "set-info",
+      "set-option" });
+
+// number of assertions a parsing thread takes at a time
+static const size_t PARSE_CHUNK_SIZE = 256;
+
+int SmtLibReader::parse_parallel(const std::string & f, size_t num_threads)
+{
+  ifstream input(f, ios::binary);
+  if (!input)
+  {
+    throw SmtException("Cannot open " + f);
+  }
+  string text((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+  input.close();
+
+  vector<SmtLibCommand> commands = split_smtlib_commands(text);
+  vector<size_t> asserts;
+  for (size_t i = 0; i < commands.size(); ++i)
+  {
+    if (commands[i].keyword == "assert")
+    {
+      asserts.push_back(i);
+    }
+  }
+
+  // the threads parse the assertions chunk by chunk, in order
+  size_t num_chunks = (asserts.size() + PARSE_CHUNK_SIZE - 1) / PARSE_CHUNK_SIZE;
+  vector<SmtLibTermDag> dags(asserts.size());
+  vector<char> supported(asserts.size(), false);
+  vector<bool> chunk_done(num_chunks, false);
+  atomic<size_t> next_chunk(0);
+  atomic<bool> stop(false);
+  mutex m;
+  condition_variable cv;
+
+  auto parse_chunks = [&]() {
+    size_t c;
+    while (!stop && (c = next_chunk++) < num_chunks)
+    {
+      size_t end = min(asserts.size(), (c + 1) * PARSE_CHUNK_SIZE);
+      for (size_t k = c * PARSE_CHUNK_SIZE; k < end; ++k)
+      {
+        try
+        {
+          supported[k] = dags[k].parse(commands[asserts[k]].body);
+        }
+        catch (std::exception & e)
+        {
+          // left to the parser
+          supported[k] = false;
+        }
+      }
+      lock_guard<mutex> lk(m);
+      chunk_done[c] = true;
+      cv.notify_all();
+    }
+  };
+
+  if (!num_threads)
+  {
+    num_threads = max(thread::hardware_concurrency(), 1u);
+  }
+  vector<thread> threads;
+  for (size_t i = 0; i < min(num_threads, num_chunks); ++i)
+  {
+    threads.emplace_back(parse_chunks);
+  }
+  auto join = [&]() {
+    stop = true;
+    for (thread & t : threads)
+    {
+      t.join();
+    }
+    parsed_applications_.clear();
+  };
+
+  int res = 0;
+  try
+  {
+    size_t k = 0;  // the next assertion
+    size_t i = 0;
+    while (!res && i < commands.size())
+    {
+      if (commands[i].keyword == "assert")
+      {
+        {
+          unique_lock<mutex> lk(m);
+          cv.wait(lk, [&]() { return chunk_done[k / PARSE_CHUNK_SIZE]; });
+        }
+
+        Term assertion;
+        if (supported[k])
+        {
+          try
+          {
+            assertion = build_parsed_term(dags[k]);
+          }
+          catch (SmtException & e)
+          {
+            // the parser reports the error
+            assertion = nullptr;
+          }
+        }
+        dags[k] = SmtLibTermDag();
+
+        if (assertion)
+        {
+          assert_formula(assertion);
+        }
+        else
+        {
+          istringstream in(string(commands[i].text));
+          res = parse_stream(in, false, f, commands[i].line);
+        }
+        ++k;
+        ++i;
+        continue;
+      }
+
+      // parse the other commands until the next assertion at once
+      size_t j = i;
+      bool exit = false;
+      while (!exit && j < commands.size() && commands[j].keyword != "assert")
+      {
+        const string_view & keyword = commands[j].keyword;
+        if (keeps_parsed_applications.find(keyword)
+            == keeps_parsed_applications.end())
+        {
+          parsed_applications_.clear();
+        }
+        exit = keyword == "exit";
+        ++j;
+      }
+      const char * begin = commands[i].text.data();
+      const char * end = commands[j - 1].text.data() + commands[j - 1].text.size();
+      istringstream in(string(begin, end));
+      res = parse_stream(in, false, f, commands[i].line);
+      if (exit)
+      {
+        break;
+      }
+      i = j;
+    }
+  }
+  catch (...)
+  {
+    join();
+    throw;
+  }
+  join();
+  return res;
+}
+
+Term SmtLibReader::build_parsed_term(const SmtLibTermDag & dag)
+{
+  const vector<SmtLibTermNode> & nodes = dag.get_nodes();
+  const vector<uint32_t> & children = dag.get_children();
+  TermVec built;
+  built.reserve(nodes.size());
+  for (const SmtLibTermNode & n : nodes)
+  {
+    Term t;
+    switch (n.kind)
+    {
+      case SMTLIB_SYMBOL:
+        t = lookup_symbol(intern(n.text));
+        if (!t)
+        {
+          throw SmtException("Unrecognized symbol: " + string(n.text));
+        }
+        break;
+      case SMTLIB_NUMERAL:
+        t = solver_->make_term(string(n.text), solver_->make_sort(INT));
+        break;
+      case SMTLIB_DECIMAL:
+        t = solver_->make_term(string(n.text), solver_->make_sort(REAL));
+        break;
+      case SMTLIB_BINARY:
+        t = solver_->make_term(
+            string(n.text), solver_->make_sort(BV, n.text.size()), 2);
+        break;
+      case SMTLIB_HEX:
+        t = solver_->make_term(
+            string(n.text), solver_->make_sort(BV, 4 * n.text.size()), 16);
+        break;
+      case SMTLIB_BV_DECIMAL:
+        t = solver_->make_term(
+            string(n.text), solver_->make_sort(BV, n.idx0), 10);
+        break;
+      default:
+      {
+        assert(n.kind == SMTLIB_APPLY || n.kind == SMTLIB_INDEXED_APPLY);
+        ParsedApplication & key = parsed_key_;
+        key.head = intern(n.text);
+        key.num_idx = n.num_idx;
+        key.idx0 = n.idx0;
+        key.idx1 = n.idx1;
+        key.args.clear();
+        for (size_t i = 0; i < n.num_children; ++i)
+        {
+          key.args.push_back(built[children[n.first_child + i]]);
+        }
+
+        auto it = parsed_applications_.find(key);
+        if (it != parsed_applications_.end())
+        {
+          t = it->second;
+        }
+        else
+        {
+          t = build_parsed_application(key);
+          parsed_applications_.emplace(key, t);
+        }
+      }
+    }
+    built.push_back(t);
+  }
+  return built.at(dag.get_root());
+}
+
+Term SmtLibReader::build_parsed_application(const ParsedApplication & app)
+{
+  // same as the term_s_expr rules of the parser
+  PrimOp po = lookup_primop(app.head);
+  if (app.num_idx)
+  {
+    if (po == NUM_OPS_AND_NULL)
+    {
+      throw SmtException("Unexpected symbol in indexed operator: "
+                         + app.head);
+    }
+    Op op = app.num_idx == 1 ? Op(po, app.idx0) : Op(po, app.idx0, app.idx1);
+    return solver_->make_term(op, app.args);
+  }
+
+  if (po != NUM_OPS_AND_NULL)
+  {
+    if (po == Minus && app.args.size() == 1)
+    {
+      return solver_->make_term(Negate, app.args[0]);
+    }
+    return solver_->make_term(po, app.args);
+  }
+
+  Term uf = lookup_symbol(app.head);
+  if (uf)
+  {
+    TermVec vec({ uf });
+    vec.insert(vec.end(), app.args.begin(), app.args.end());
+    return solver_->make_term(Apply, vec);
+  }
+
+  if (app.args.empty())
+  {
+    throw SmtException("Unknown function: " + app.head);
+  }
+  return apply_define_fun(app.head, app.args);
+}
+
 void SmtLibReader::set_logic(const string & logic)
 {
   if (logic == "ALL")
@@ -132,7 +474,7 @@ void SmtLibReader::set_logic(const string & logic)
           theories.insert(theory);
           for (const auto & elem : strict_theory2opmap.at(theory))
           {
-            primops_.insert(elem);
+            primops_.insert({ intern(elem.first), elem.second });
           }
         }
 
@@ -153,7 +495,7 @@ void SmtLibReader::set_logic(const string & logic)
         {
           for (const SortKind sk : logic_sortkind_map.at(sub))
           {
-            sortkinds_[smt::to_string(sk)] = sk;
+            sortkinds_[intern(smt::to_string(sk))] = sk;
           }
         }
         break;
@@ -186,7 +528,7 @@ void SmtLibReader::set_logic(const string & logic)
     {
       for (const auto & elem : nonstrict_theory2opmap.at(comb))
       {
-        primops_.insert(elem);
+        primops_.insert({ intern(elem.first), elem.second });
       }
     }
   }
@@ -213,7 +555,7 @@ void SmtLibReader::set_logic_all()
   {
     for (const auto & elem : tmap.second)
     {
-      primops_.insert(elem);
+      primops_.insert({ intern(elem.first), elem.second });
     }
   }
 
@@ -222,7 +564,7 @@ void SmtLibReader::set_logic_all()
   {
     for (const SortKind & sk : elem.second)
     {
-      sortkinds_[smt::to_string(sk)] = sk;
+      sortkinds_[intern(smt::to_string(sk))] = sk;
     }
   }
 
@@ -233,7 +575,7 @@ void SmtLibReader::set_logic_all()
     {
       for (const auto & elem : tmap.second)
       {
-        primops_.insert(elem);
+        primops_.insert({ intern(elem.first), elem.second });
       }
     }
   }
@@ -305,16 +647,16 @@ void SmtLibReader::pop_scope()
   sort_arg_ids_.pop_back();
 }
 
-Term SmtLibReader::lookup_symbol(const string & sym)
+Term SmtLibReader::lookup_symbol(const InternedString & sym)
 {
   Term symbol_term;
   assert(!symbol_term);
 
-  if (sym == "true")
+  if (sym == true_)
   {
     return solver_->make_term(true);
   }
-  else if (sym == "false")
+  else if (sym == false_)
   {
     return solver_->make_term(false);
   }
@@ -335,8 +677,9 @@ Term SmtLibReader::lookup_symbol(const string & sym)
   return symbol_term;
 }
 
-void SmtLibReader::new_symbol(const std::string & name, const smt::Sort & sort)
+void SmtLibReader::new_symbol(const std::string & str, const smt::Sort & sort)
 {
+  InternedString name = intern(str);
   if (global_symbols_.get_symbol(name))
   {
     throw SmtException("Re-declaring symbol: " + name);
@@ -360,12 +703,12 @@ void SmtLibReader::new_symbol(const std::string & name, const smt::Sort & sort)
                                   + logic_ + " does not support UFs");
   }
 
-  Term fresh_symbol = solver_->make_symbol(name, sort);
+  Term fresh_symbol = solver_->make_symbol(str, sort);
   global_symbols_.add_mapping(name, fresh_symbol);
   all_symbols_[name] = fresh_symbol;
 }
 
-PrimOp SmtLibReader::lookup_primop(const std::string & str)
+PrimOp SmtLibReader::lookup_primop(const InternedString & str)
 {
   auto it = primops_.find(str);
   if (it != primops_.end())
@@ -380,7 +723,7 @@ PrimOp SmtLibReader::lookup_primop(const std::string & str)
   }
 }
 
-SortKind SmtLibReader::lookup_sortkind(const std::string & str)
+SortKind SmtLibReader::lookup_sortkind(const InternedString & str)
 {
   SortKind sk = NUM_SORT_KINDS;
   auto it = sortkinds_.find(str);
@@ -391,15 +734,15 @@ SortKind SmtLibReader::lookup_sortkind(const std::string & str)
   return sk;
 }
 
-void SmtLibReader::define_fun(const string & name,
+void SmtLibReader::define_fun(const InternedString & name,
                               const Term & def,
                               const TermVec & args)
 {
   if (args.size())
   {
     // this is a function
-    defs_[name] = def;
-    def_args_[name] = args;
+    defs_.erase(name);
+    defs_.emplace(name, TermTemplate(def, args));
   }
   else
   {
@@ -408,10 +751,9 @@ void SmtLibReader::define_fun(const string & name,
   }
 }
 
-Term SmtLibReader::apply_define_fun(const string & defname,
+Term SmtLibReader::apply_define_fun(const InternedString & defname,
                                     const TermVec & args)
 {
-  UnorderedTermMap subs_map;
   size_t num_args = args.size();
   assert(num_args); // apply_define_fun only for defines which take arguments
 
@@ -422,23 +764,18 @@ Term SmtLibReader::apply_define_fun(const string & defname,
     throw SmtException("Unknown function: " + defname);
   }
 
-  Term def = it->second;
+  TermTemplate & def = it->second;
 
-  if (num_args != def_args_.at(defname).size())
+  if (num_args != def.num_params())
   {
     throw SmtException(defname
                        + " not applied to correct number of arguments.");
   }
 
-  for (size_t i = 0; i < args.size(); ++i)
-  {
-    subs_map[def_args_.at(defname)[i]] = args[i];
-  }
-
-  return solver_->substitute(def, subs_map);
+  return def.instantiate(solver_, args);
 }
 
-Term SmtLibReader::register_arg(const string & name, const Sort & sort)
+Term SmtLibReader::register_arg(const InternedString & name, const Sort & sort)
 {
   assert(current_scope());
   // find the right id for this argument
@@ -473,7 +810,7 @@ Term SmtLibReader::register_arg(const string & name, const Sort & sort)
   return tmpvar;
 }
 
-void SmtLibReader::define_sort(const string & name, const Sort & sort)
+void SmtLibReader::define_sort(const InternedString & name, const Sort & sort)
 {
   if (sortkinds_.find(name) != sortkinds_.end())
   {
@@ -487,7 +824,7 @@ void SmtLibReader::define_sort(const string & name, const Sort & sort)
   defined_sorts_[name] = sort;
 }
 
-Sort SmtLibReader::lookup_sort(const string & name)
+Sort SmtLibReader::lookup_sort(const InternedString & name)
 {
   auto it = defined_sorts_.find(name);
   if (it == defined_sorts_.end())
@@ -497,7 +834,7 @@ Sort SmtLibReader::lookup_sort(const string & name)
   return it->second;
 }
 
-Term SmtLibReader::create_param(const string & name, const Sort & sort)
+Term SmtLibReader::create_param(const InternedString & name, const Sort & sort)
 {
   assert(current_scope());
   Term param;
@@ -525,7 +862,7 @@ Term SmtLibReader::create_param(const string & name, const Sort & sort)
   return param;
 }
 
-void SmtLibReader::let_binding(const string & sym, const Term & term)
+void SmtLibReader::let_binding(const InternedString & sym, const Term & term)
 {
   assert(current_scope());
   arg_param_map_.add_mapping(sym, term);
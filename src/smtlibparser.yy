@@ -49,6 +49,7 @@ using namespace std;
   #include <string>
   #include <utility>
   #include "smt.h"
+  #include "string_interner.h"
 
   namespace smt
   {
@@ -62,7 +63,7 @@ using namespace std;
 #include "smtlib_reader.h"
 }
 
-%token <std::string> SYMBOL
+%token <smt::InternedString> SYMBOL
 %token <std::string> NAT
 %token <std::string> FLOAT
 %token <std::string> BITSTR
@@ -74,8 +75,8 @@ using namespace std;
        CHECKSATASSUMING PUSH POP EXIT GETVALUE
        GETUNSATASSUMP ECHO
 %token ASCONST LET
-%token <std::string> KEYWORD
-%token <std::string> QUANTIFIER
+%token <smt::InternedString> KEYWORD
+%token <smt::InternedString> QUANTIFIER
 %token
 LP "("
 RP ")"
@@ -123,7 +124,7 @@ commands:
 command:
   LP SETLOGIC SYMBOL RP
   {
-    drv.set_logic($3);
+    drv.set_logic($3.str());
   }
   | LP SETOPT attribute RP
   {
@@ -137,7 +138,7 @@ command:
   }
   | LP DECLARECONST SYMBOL sort RP
   {
-    drv.new_symbol($3, $4);
+    drv.new_symbol($3.str(), $4);
   }
   | LP DECLAREFUN SYMBOL LP sort_list RP sort RP
   {
@@ -153,11 +154,11 @@ command:
       symsort = $7;
     }
     assert(symsort);
-    drv.new_symbol($3, symsort);
+    drv.new_symbol($3.str(), symsort);
   }
   | LP DECLARESORT SYMBOL NAT RP
   {
-    drv.define_sort($3, drv.solver()->make_sort($3, std::stoi($4)));
+    drv.define_sort($3, drv.solver()->make_sort($3.str(), std::stoi($4)));
   }
   | LP DEFINEFUN
      {
@@ -517,7 +518,7 @@ stringlit:
    }
    | SYMBOL
    {
-     $$ = $1;
+     $$ = $1.str();
    }
 ;
 
@@ -589,11 +590,11 @@ s_expr_list:
 attribute:
    KEYWORD
    {
-     $$ = {$1, ""};
+     $$ = {$1.str(), ""};
    }
    | KEYWORD s_expr
    {
-     $$ = {$1, $2};
+     $$ = {$1.str(), $2};
    }
 ;
 
@@ -18,6 +18,7 @@
 
 #include "assert.h"
 #include "exceptions.h"
+#include "substituter.h"
 
 namespace smt {
 
@@ -52,56 +53,35 @@ Sort AbsSmtSolver::make_datatype_sort(const DatatypeDecl & decl) const
   return datatype_sorts[0];
 }
 
+Term AbsSmtSolver::make_term(const BVValue & val, const Sort & sort) const
+{
+  if (sort->get_sort_kind() != BV || sort->get_width() != val.get_width())
+  {
+    throw IncorrectUsageException("Can't make a value of width "
+                                  + std::to_string(val.get_width())
+                                  + " with sort " + sort->to_string());
+  }
+  return make_term(val.to_binary_string(), sort, 2);
+}
+
 Term AbsSmtSolver::substitute(const Term term,
                               const UnorderedTermMap & substitution_map) const
 {
   // cache starts with the substitutions
   UnorderedTermMap cache(substitution_map);
-  TermVec to_visit{ term };
-  TermVec cached_children;
-  Term t;
-  while (to_visit.size())
-  {
-    t = to_visit.back();
-    to_visit.pop_back();
-    if (cache.find(t) == cache.end())
-    {
-      // doesn't get updated yet, just marking as visited
-      cache[t] = t;
-      to_visit.push_back(t);
-      for (auto c : t)
-      {
-        to_visit.push_back(c);
-      }
-    }
-    else
-    {
-      cached_children.clear();
-      for (auto c : t)
-      {
-        cached_children.push_back(cache.at(c));
-      }
-
-      // const arrays have children but don't need to be rebuilt
-      // (they're constructed in a particular way anyway)
-      if (cached_children.size() && !t->is_value())
-      {
-        cache[t] = make_term(t->get_op(), cached_children);
-      }
-    }
-  }
-
-  return cache.at(term);
+  return Substituter::substitute(*this, term, cache);
 }
 
 TermVec AbsSmtSolver::substitute_terms(
     const TermVec & terms, const UnorderedTermMap & substitution_map) const
 {
+  // one cache for all the terms, so shared subterms are rebuilt once
+  UnorderedTermMap cache(substitution_map);
   TermVec res;
   res.reserve(terms.size());
-  for (auto t : terms)
+  for (const Term & t : terms)
   {
-    res.push_back(substitute(t, substitution_map));
+    res.push_back(Substituter::substitute(*this, t, cache));
   }
   return res;
 }
@@ -0,0 +1,217 @@
+/*********************                                                        */
+/*! \file solver_selector.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A table of how solvers performed on buckets of formulas, used
+**        to choose which solvers to run.
+**
+**/
+
+#include "solver_selector.h"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+
+#include "exceptions.h"
+
+using namespace std;
+
+namespace smt {
+
+void SolverSelector::record(const string & bucket,
+                            const string & solver,
+                            bool won,
+                            double seconds)
+{
+  lock_guard<mutex> lk(m);
+  SolverPerformance & perf = table[bucket][solver];
+  ++perf.runs;
+  if (won)
+  {
+    ++perf.wins;
+    perf.win_seconds += seconds;
+  }
+}
+
+SolverPerformance SolverSelector::get_performance(const string & bucket,
+                                                  const string & solver) const
+{
+  lock_guard<mutex> lk(m);
+  auto bit = table.find(bucket);
+  if (bit == table.end())
+  {
+    return SolverPerformance();
+  }
+  auto sit = bit->second.find(solver);
+  if (sit == bit->second.end())
+  {
+    return SolverPerformance();
+  }
+  return sit->second;
+}
+
+vector<size_t> SolverSelector::rank(const string & bucket,
+                                    const vector<string> & solvers) const
+{
+  vector<double> win_rate;
+  vector<double> win_time;
+  win_rate.reserve(solvers.size());
+  win_time.reserve(solvers.size());
+  for (const string & s : solvers)
+  {
+    SolverPerformance perf = get_performance(bucket, s);
+    win_rate.push_back((perf.wins + 1.0) / (perf.runs + 2.0));
+    // solvers that never won go last among equal rates
+    win_time.push_back(perf.wins ? perf.win_seconds / perf.wins
+                                 : numeric_limits<double>::infinity());
+  }
+
+  vector<size_t> res(solvers.size());
+  for (size_t i = 0; i < res.size(); ++i)
+  {
+    res[i] = i;
+  }
+  stable_sort(res.begin(), res.end(), [&](size_t a, size_t b) {
+    if (win_rate[a] != win_rate[b])
+    {
+      return win_rate[a] > win_rate[b];
+    }
+    return win_time[a] < win_time[b];
+  });
+  return res;
+}
+
+// a count is a nonempty sequence of digits, stoull alone would accept
+// a sign or leading whitespace, and wrap negative numbers around
+static bool parse_count(const string & field, uint64_t & out)
+{
+  if (field.empty()
+      || !all_of(field.begin(), field.end(), [](char c) {
+           return c >= '0' && c <= '9';
+         }))
+  {
+    return false;
+  }
+  out = stoull(field);
+  return true;
+}
+
+void SolverSelector::load(istream & in)
+{
+  // parsed completely before merging, so that a malformed line leaves
+  // the table unchanged
+  map<string, map<string, SolverPerformance>> loaded;
+  string line;
+  size_t line_num = 0;
+  while (getline(in, line))
+  {
+    ++line_num;
+    if (line.empty())
+    {
+      continue;
+    }
+
+    vector<string> fields;
+    istringstream ss(line);
+    string field;
+    while (getline(ss, field, '\t'))
+    {
+      fields.push_back(field);
+    }
+
+    SolverPerformance perf;
+    bool ok = fields.size() == 5 && !fields[0].empty() && !fields[1].empty();
+    try
+    {
+      if (ok)
+      {
+        ok = parse_count(fields[2], perf.runs)
+             && parse_count(fields[3], perf.wins)
+             && !fields[4].empty() && fields[4][0] != '-';
+      }
+      if (ok)
+      {
+        perf.win_seconds = stod(fields[4]);
+        ok = perf.wins <= perf.runs && perf.win_seconds >= 0;
+      }
+    }
+    catch (std::exception & e)
+    {
+      ok = false;
+    }
+    if (!ok)
+    {
+      throw IncorrectUsageException(
+          "Malformed solver performance table at line "
+          + std::to_string(line_num));
+    }
+
+    SolverPerformance & entry = loaded[fields[0]][fields[1]];
+    entry.runs += perf.runs;
+    entry.wins += perf.wins;
+    entry.win_seconds += perf.win_seconds;
+  }
+
+  lock_guard<mutex> lk(m);
+  for (const auto & bucket : loaded)
+  {
+    map<string, SolverPerformance> & solvers = table[bucket.first];
+    for (const auto & p : bucket.second)
+    {
+      SolverPerformance & entry = solvers[p.first];
+      entry.runs += p.second.runs;
+      entry.wins += p.second.wins;
+      entry.win_seconds += p.second.win_seconds;
+    }
+  }
+}
+
+void SolverSelector::load_file(const string & filename)
+{
+  ifstream in(filename);
+  if (!in)
+  {
+    throw IncorrectUsageException("Could not open " + filename);
+  }
+  load(in);
+}
+
+void SolverSelector::save(ostream & out) const
+{
+  lock_guard<mutex> lk(m);
+  // round trip the times exactly
+  auto old_precision = out.precision(numeric_limits<double>::max_digits10);
+  for (const auto & bucket : table)
+  {
+    for (const auto & entry : bucket.second)
+    {
+      const SolverPerformance & perf = entry.second;
+      out << bucket.first << '\t' << entry.first << '\t' << perf.runs << '\t'
+          << perf.wins << '\t' << perf.win_seconds << '\n';
+    }
+  }
+  out.precision(old_precision);
+}
+
+void SolverSelector::save_file(const string & filename) const
+{
+  ofstream out(filename);
+  if (!out)
+  {
+    throw IncorrectUsageException("Could not open " + filename);
+  }
+  save(out);
+}
+
+}  // namespace smt
@@ -0,0 +1,82 @@
+/*********************                                                        */
+/*! \file string_interner.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A table of unique strings, so that each distinct string is
+**        stored and hashed once, and then compared and hashed by address.
+**
+**/
+
+#include "string_interner.h"
+
+#include <cstring>
+#include <ostream>
+
+using namespace std;
+
+namespace smt {
+
+ostream & operator<<(ostream & output, const InternedString & s)
+{
+  output << s.view();
+  return output;
+}
+
+string operator+(const string & a, const InternedString & b)
+{
+  string res = a;
+  res += b.view();
+  return res;
+}
+
+string operator+(const InternedString & a, const string & b)
+{
+  string res = a.str();
+  res += b;
+  return res;
+}
+
+InternedString StringInterner::intern(string_view str)
+{
+  auto it = table_.find(str);
+  if (it != table_.end())
+  {
+    return InternedString(*it);
+  }
+
+  // null-terminated, which also gives the empty string its own address
+  char * data = allocate(str.size() + 1);
+  memcpy(data, str.data(), str.size());
+  data[str.size()] = '\0';
+  string_view res(data, str.size());
+  table_.insert(res);
+  return InternedString(res);
+}
+
+char * StringInterner::allocate(size_t n)
+{
+  if (n > BLOCK_SIZE / 4)
+  {
+    // large strings get their own block
+    large_blocks_.emplace_back(new char[n]);
+    return large_blocks_.back().get();
+  }
+
+  if (block_used_ + n > BLOCK_SIZE)
+  {
+    blocks_.emplace_back(new char[BLOCK_SIZE]);
+    block_used_ = 0;
+  }
+  char * res = blocks_.back().get() + block_used_;
+  block_used_ += n;
+  return res;
+}
+
+}  // namespace smt
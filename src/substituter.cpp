@@ -0,0 +1,110 @@
+/*********************                                                        */
+/*! \file substituter.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Substitution with a cache that persists across calls.
+**
+**/
+
+#include "substituter.h"
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace smt {
+
+Substituter::Substituter(const SmtSolver & solver,
+                         const UnorderedTermMap & substitution_map)
+    : solver_(solver), map_(substitution_map), cache_(substitution_map)
+{
+}
+
+void Substituter::set_map(const UnorderedTermMap & substitution_map)
+{
+  map_ = substitution_map;
+  clear_cache();
+}
+
+Term Substituter::substitute(const Term & term)
+{
+  return substitute(*solver_, term, cache_);
+}
+
+TermVec Substituter::substitute_terms(const TermVec & terms)
+{
+  TermVec res;
+  res.reserve(terms.size());
+  for (const Term & t : terms)
+  {
+    res.push_back(substitute(*solver_, t, cache_));
+  }
+  return res;
+}
+
+void Substituter::clear_cache() { cache_ = map_; }
+
+Term Substituter::substitute(const AbsSmtSolver & solver,
+                             const Term & term,
+                             UnorderedTermMap & cache)
+{
+  // terms paired with whether their children were pushed already
+  vector<pair<Term, bool>> to_visit{ { term, false } };
+  TermVec cached_children;
+  while (to_visit.size())
+  {
+    Term t = to_visit.back().first;
+    bool children_visited = to_visit.back().second;
+    to_visit.pop_back();
+    if (cache.find(t) != cache.end())
+    {
+      continue;
+    }
+
+    if (!children_visited)
+    {
+      to_visit.push_back({ t, true });
+      for (const Term & c : t)
+      {
+        if (cache.find(c) == cache.end())
+        {
+          to_visit.push_back({ c, false });
+        }
+      }
+      continue;
+    }
+
+    // only rebuild terms with a substituted child
+    bool changed = false;
+    cached_children.clear();
+    for (const Term & c : t)
+    {
+      const Term & cc = cache.at(c);
+      changed |= cc != c;
+      cached_children.push_back(cc);
+    }
+
+    // const arrays have children but don't need to be rebuilt
+    // (they're constructed in a particular way anyway)
+    if (changed && !t->is_value())
+    {
+      cache[t] = solver.make_term(t->get_op(), cached_children);
+    }
+    else
+    {
+      cache[t] = t;
+    }
+  }
+
+  return cache.at(term);
+}
+
+}  // namespace smt
@@ -24,6 +24,19 @@ std::ostream & operator<<(std::ostream & output, const Term t)
   return output;
 }
 
+/* AbsTerm implementation */
+BVValue AbsTerm::to_bv_value()
+{
+  Sort sort = get_sort();
+  if (!is_value() || sort->get_sort_kind() != BV)
+  {
+    throw IncorrectUsageException("Expecting a bit-vector value but got "
+                                  + to_string());
+  }
+  return BVValue::from_smt2(print_value_as(BV), sort->get_width());
+}
+/* end AbsTerm implementation */
+
 /* TermIterBase implementation */
 const Term TermIterBase::operator*()
 {
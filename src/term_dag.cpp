@@ -0,0 +1,741 @@
+/*********************                                                        */
+/*! \file term_dag.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver-neutral representation of term DAGs, and a binary
+**        format to store them.
+**
+**/
+
+#include "term_dag.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
+
+#include "assert.h"
+#include "sort_inference.h"
+
+using namespace std;
+
+namespace smt {
+
+static_assert(sizeof(TermDagSort) == 24, "unexpected padding in TermDagSort");
+static_assert(sizeof(TermDagNode) == 40, "unexpected padding in TermDagNode");
+static_assert(sizeof(TermDagBV) == 16, "unexpected padding in TermDagBV");
+
+// the header of the binary format, followed by the tables in this order:
+// sorts, sort_args, nodes, children, roots, string_offsets (num_strings + 1),
+// string_data, bvs, bv_words -- each one padded to 8 bytes
+struct TermDagHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t num_sorts;
+  uint32_t num_sort_args;
+  uint32_t num_nodes;
+  uint32_t num_children;
+  uint32_t num_roots;
+  uint32_t num_strings;
+  uint32_t num_bvs;
+  uint64_t num_string_bytes;
+  uint64_t num_bv_words;
+};
+
+static const char TERM_DAG_MAGIC[8] = { 'S', 'M', 'T', 'S', 'W', 'D', 'A', 'G' };
+
+// size of a table padded to 8 bytes
+static inline uint64_t padded(uint64_t bytes) { return (bytes + 7) & ~7ull; }
+
+static inline uint64_t num_words(uint64_t width) { return (width + 63) / 64; }
+
+static void malformed(const string & msg)
+{
+  throw IncorrectUsageException("Malformed term DAG: " + msg);
+}
+
+/* TermDagView */
+
+void TermDagView::check() const
+{
+  if (string_offsets[0] != 0)
+  {
+    malformed("first string offset is not zero");
+  }
+  for (size_t i = 0; i < num_strings; ++i)
+  {
+    if (string_offsets[i + 1] < string_offsets[i])
+    {
+      malformed("string offsets are not increasing");
+    }
+  }
+
+  for (size_t i = 0; i < num_sorts; ++i)
+  {
+    const TermDagSort & ds = sorts[i];
+    if (ds.kind >= NUM_SORT_KINDS
+        || (uint64_t)ds.first_arg + ds.num_args > num_sort_args)
+    {
+      malformed("sort " + std::to_string(i));
+    }
+    if (ds.kind == UNINTERPRETED && ds.name >= num_strings)
+    {
+      malformed("name of sort " + std::to_string(i));
+    }
+    // the number of arguments each kind is recorded with
+    bool arity_ok;
+    switch (ds.kind)
+    {
+      case BV: arity_ok = ds.num_args == 0 && ds.width > 0; break;
+      case ARRAY: arity_ok = ds.num_args == 2; break;
+      // at least one domain sort and the codomain
+      case FUNCTION: arity_ok = ds.num_args >= 2; break;
+      case BOOL:
+      case INT:
+      case REAL:
+      case STRING:
+      case UNINTERPRETED: arity_ok = ds.num_args == 0; break;
+      default: arity_ok = false;
+    }
+    if (!arity_ok)
+    {
+      malformed("arguments of sort " + std::to_string(i));
+    }
+    for (uint32_t j = 0; j < ds.num_args; ++j)
+    {
+      // arguments are recorded before the sorts using them
+      if (sort_args[ds.first_arg + j] >= i)
+      {
+        malformed("arguments of sort " + std::to_string(i));
+      }
+    }
+  }
+
+  for (size_t i = 0; i < num_bvs; ++i)
+  {
+    if (bvs[i].width == 0 || bvs[i].first_word > num_bv_words
+        || num_words(bvs[i].width) > num_bv_words - bvs[i].first_word)
+    {
+      malformed("bit-vector value " + std::to_string(i));
+    }
+  }
+
+  for (size_t i = 0; i < num_nodes; ++i)
+  {
+    const TermDagNode & n = nodes[i];
+    if (n.kind >= NUM_TERM_DAG_NODE_KINDS || n.sort >= num_sorts
+        || (uint64_t)n.first_child + n.num_children > num_children
+        || n.num_idx > 2)
+    {
+      malformed("node " + std::to_string(i));
+    }
+    for (uint32_t j = 0; j < n.num_children; ++j)
+    {
+      // nodes are in topological order
+      if (children[n.first_child + j] >= i)
+      {
+        malformed("children of node " + std::to_string(i));
+      }
+    }
+
+    bool ok = true;
+    switch (n.kind)
+    {
+      case SYMBOL_NODE:
+      case PARAM_NODE:
+      case VALUE_NODE: ok = n.data < num_strings; break;
+      case BV_VALUE_NODE:
+        ok = n.data < num_bvs && sorts[n.sort].kind == BV
+             && bvs[n.data].width == sorts[n.sort].width;
+        break;
+      case CONST_ARRAY_NODE:
+        ok = n.num_children == 1 && sorts[n.sort].kind == ARRAY;
+        break;
+      default:
+        ok = n.prim_op < NUM_OPS_AND_NULL && n.num_children > 0;
+        break;
+    }
+    if (!ok)
+    {
+      malformed("node " + std::to_string(i));
+    }
+  }
+}
+
+/* TermDag */
+
+TermDag::TermDag() : string_offsets({ 0 }) {}
+
+uint32_t TermDag::add_string(const string & s)
+{
+  string_data += s;
+  string_offsets.push_back(string_data.size());
+  return string_offsets.size() - 2;
+}
+
+uint32_t TermDag::add_sort(const Sort & sort)
+{
+  auto it = sort_ids.find(sort);
+  if (it != sort_ids.end())
+  {
+    return it->second;
+  }
+
+  TermDagSort ds;
+  ds.kind = sort->get_sort_kind();
+  ds.name = 0;
+  ds.width = 0;
+  // arguments first, the sort refers to them by index
+  vector<uint32_t> args;
+  if (ds.kind == BV)
+  {
+    ds.width = sort->get_width();
+  }
+  else if (ds.kind == ARRAY)
+  {
+    // recursive call, but it should be okay because we don't expect deep
+    // nesting of arrays
+    args.push_back(add_sort(sort->get_indexsort()));
+    args.push_back(add_sort(sort->get_elemsort()));
+  }
+  else if (ds.kind == FUNCTION)
+  {
+    for (const Sort & s : sort->get_domain_sorts())
+    {
+      args.push_back(add_sort(s));
+    }
+    args.push_back(add_sort(sort->get_codomain_sort()));
+  }
+  else if (ds.kind == UNINTERPRETED)
+  {
+    assert(sort->get_arity() == 0);
+    ds.name = add_string(sort->get_uninterpreted_name());
+  }
+  else if (ds.kind != INT && ds.kind != REAL && ds.kind != BOOL
+           && ds.kind != STRING)
+  {
+    throw SmtException("Failed to record sort: " + sort->to_string());
+  }
+
+  ds.first_arg = sort_args.size();
+  ds.num_args = args.size();
+  sort_args.insert(sort_args.end(), args.begin(), args.end());
+
+  uint32_t id = sorts.size();
+  sorts.push_back(ds);
+  sort_ids[sort] = id;
+  return id;
+}
+
+uint32_t TermDag::add_term(const Term & term)
+{
+  auto nit = node_ids.find(term);
+  if (nit != node_ids.end())
+  {
+    return nit->second;
+  }
+
+  // same traversal as TermTranslator::transfer_term, but records the
+  // nodes instead of building them
+  visit_stack.clear();
+  visit_stack.emplace_back(term, false);
+  while (visit_stack.size())
+  {
+    if (!visit_stack.back().second)
+    {
+      visit_stack.back().second = true;
+      // raw pointer because pushing children can reallocate the stack
+      AbsTerm * t = visit_stack.back().first.get();
+      if (node_ids.find(visit_stack.back().first) != node_ids.end())
+      {
+        visit_stack.pop_back();
+        continue;
+      }
+
+      // insert in reverse order
+      // helps symbols be declared in same order
+      size_t first_child = visit_stack.size();
+      for (TermIter it = t->begin(), end = t->end(); it != end; ++it)
+      {
+        Term c = *it;
+        if (node_ids.find(c) == node_ids.end())
+        {
+          visit_stack.emplace_back(std::move(c), false);
+        }
+      }
+      std::reverse(visit_stack.begin() + first_child, visit_stack.end());
+      continue;
+    }
+
+    Term t = std::move(visit_stack.back().first);
+    visit_stack.pop_back();
+    if (node_ids.find(t) != node_ids.end())
+    {
+      continue;
+    }
+
+    if (nodes.size() == UINT32_MAX)
+    {
+      throw SmtException("Term DAG has too many nodes");
+    }
+
+    TermDagNode n;
+    memset(&n, 0, sizeof(n));
+    n.sort = add_sort(t->get_sort());
+    n.first_child = children.size();
+    for (auto c : t)
+    {
+      children.push_back(node_ids.at(c));
+    }
+    n.num_children = children.size() - n.first_child;
+
+    SortKind sk = (SortKind)sorts[n.sort].kind;
+    if (t->is_symbol() || t->is_param())
+    {
+      // parameters are symbols as well
+      n.kind = t->is_param() ? PARAM_NODE : SYMBOL_NODE;
+      // record the name, not its quoted SMT-LIB form
+      string name = t->to_string();
+      if (name.size() >= 2 && name.front() == '|' && name.back() == '|')
+      {
+        name = name.substr(1, name.size() - 2);
+      }
+      n.data = add_string(name);
+    }
+    else if (t->is_value() && sk == ARRAY)
+    {
+      // special case for const-array
+      assert(n.num_children == 1);
+      n.kind = CONST_ARRAY_NODE;
+    }
+    else if (t->is_value() && sk == BV)
+    {
+      BVValue v = t->to_bv_value();
+      n.kind = BV_VALUE_NODE;
+      n.data = bvs.size();
+      bvs.push_back({ v.get_width(), bv_words.size() });
+      bv_words.insert(
+          bv_words.end(), v.get_words().begin(), v.get_words().end());
+    }
+    else if (t->is_value())
+    {
+      n.kind = VALUE_NODE;
+      n.data = add_string(t->print_value_as(sk));
+    }
+    else
+    {
+      Op op = t->get_op();
+      assert(!op.is_null());
+      assert(n.num_children);
+      n.kind = OP_NODE;
+      n.prim_op = op.prim_op;
+      n.num_idx = op.num_idx;
+      n.idx0 = op.num_idx > 0 ? op.idx0 : 0;
+      n.idx1 = op.num_idx > 1 ? op.idx1 : 0;
+    }
+
+    node_ids[t] = nodes.size();
+    nodes.push_back(n);
+  }
+
+  return node_ids.at(term);
+}
+
+uint32_t TermDag::get_index(const Term & term) const
+{
+  auto it = node_ids.find(term);
+  if (it == node_ids.end())
+  {
+    throw IncorrectUsageException("Term was not recorded in the DAG: "
+                                  + term->to_string());
+  }
+  return it->second;
+}
+
+TermDagView TermDag::view() const
+{
+  TermDagView v;
+  v.sorts = sorts.data();
+  v.num_sorts = sorts.size();
+  v.sort_args = sort_args.data();
+  v.num_sort_args = sort_args.size();
+  v.nodes = nodes.data();
+  v.num_nodes = nodes.size();
+  v.children = children.data();
+  v.num_children = children.size();
+  v.string_offsets = string_offsets.data();
+  v.num_strings = string_offsets.size() - 1;
+  v.string_data = string_data.data();
+  v.bvs = bvs.data();
+  v.num_bvs = bvs.size();
+  v.bv_words = bv_words.data();
+  v.num_bv_words = bv_words.size();
+  return v;
+}
+
+// writes a table followed by its padding
+static void write_table(ostream & out, const void * data, uint64_t bytes)
+{
+  static const char zeros[8] = { 0 };
+  out.write(static_cast<const char *>(data), bytes);
+  out.write(zeros, padded(bytes) - bytes);
+}
+
+void TermDag::write(ostream & out, const TermVec & roots)
+{
+  vector<uint32_t> root_ids;
+  root_ids.reserve(roots.size());
+  for (const Term & r : roots)
+  {
+    root_ids.push_back(add_term(r));
+  }
+
+  TermDagHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, TERM_DAG_MAGIC, sizeof(h.magic));
+  h.version = TERM_DAG_VERSION;
+  h.num_sorts = sorts.size();
+  h.num_sort_args = sort_args.size();
+  h.num_nodes = nodes.size();
+  h.num_children = children.size();
+  h.num_roots = root_ids.size();
+  h.num_strings = string_offsets.size() - 1;
+  h.num_bvs = bvs.size();
+  h.num_string_bytes = string_data.size();
+  h.num_bv_words = bv_words.size();
+
+  write_table(out, &h, sizeof(h));
+  write_table(out, sorts.data(), sorts.size() * sizeof(TermDagSort));
+  write_table(out, sort_args.data(), sort_args.size() * sizeof(uint32_t));
+  write_table(out, nodes.data(), nodes.size() * sizeof(TermDagNode));
+  write_table(out, children.data(), children.size() * sizeof(uint32_t));
+  write_table(out, root_ids.data(), root_ids.size() * sizeof(uint32_t));
+  write_table(out,
+              string_offsets.data(),
+              string_offsets.size() * sizeof(uint64_t));
+  write_table(out, string_data.data(), string_data.size());
+  write_table(out, bvs.data(), bvs.size() * sizeof(TermDagBV));
+  write_table(out, bv_words.data(), bv_words.size() * sizeof(uint64_t));
+
+  if (!out)
+  {
+    throw SmtException("Failed to write term DAG");
+  }
+}
+
+void TermDag::write_file(const string & filename, const TermVec & roots)
+{
+  ofstream out(filename, ios::binary);
+  if (!out)
+  {
+    throw IncorrectUsageException("Could not open " + filename);
+  }
+  write(out, roots);
+}
+
+/* TermDagBuilder */
+
+TermDagBuilder::TermDagBuilder(const SmtSolver & s)
+    : translator(s, TermTranslator::UncheckedSolver())
+{
+}
+
+void TermDagBuilder::clear()
+{
+  sorts.clear();
+  terms.clear();
+}
+
+Sort TermDagBuilder::build_sort(const TermDagView & dag, const TermDagSort & ds)
+{
+  const SmtSolver & solver = translator.solver;
+  SortKind sk = (SortKind)ds.kind;
+  if (sk == BV)
+  {
+    return solver->make_sort(BV, ds.width);
+  }
+  else if (sk == ARRAY)
+  {
+    if (ds.num_args != 2)
+    {
+      malformed("array sort without index and element sorts");
+    }
+    return solver->make_sort(ARRAY,
+                             sorts[dag.sort_args[ds.first_arg]],
+                             sorts[dag.sort_args[ds.first_arg + 1]]);
+  }
+  else if (sk == FUNCTION)
+  {
+    SortVec args;
+    args.reserve(ds.num_args);
+    for (uint32_t i = 0; i < ds.num_args; ++i)
+    {
+      args.push_back(sorts[dag.sort_args[ds.first_arg + i]]);
+    }
+    return solver->make_sort(FUNCTION, args);
+  }
+  else if (sk == UNINTERPRETED)
+  {
+    // needs to be the same exact uninterpreted sort every time
+    string name = dag.get_string(ds.name);
+    unordered_map<string, Sort> & usorts = translator.uninterpreted_sorts;
+    auto it = usorts.find(name);
+    if (it != usorts.end())
+    {
+      return it->second;
+    }
+    Sort s = solver->make_sort(name, 0);
+    usorts[name] = s;
+    return s;
+  }
+  return solver->make_sort(sk);
+}
+
+Term TermDagBuilder::build_node(const TermDagView & dag, const TermDagNode & n)
+{
+  const SmtSolver & solver = translator.solver;
+  const Sort & s = sorts[n.sort];
+  switch (n.kind)
+  {
+    case SYMBOL_NODE:
+    {
+      string name = dag.get_string(n.data);
+      try
+      {
+        return solver->get_symbol(name);
+      }
+      catch (IncorrectUsageException & e)
+      {
+        return solver->make_symbol(name, s);
+      }
+    }
+    case PARAM_NODE: return solver->make_param(dag.get_string(n.data), s);
+    case BV_VALUE_NODE:
+    {
+      const TermDagBV & bv = dag.bvs[n.data];
+      return solver->make_term(
+          BVValue::from_words(bv.width, dag.bv_words + bv.first_word), s);
+    }
+    case VALUE_NODE:
+      return translator.value_from_smt2(
+          dag.get_string(n.data), (SortKind)dag.sorts[n.sort].kind, s);
+    case CONST_ARRAY_NODE:
+    {
+      const Term & val = terms[dag.children[n.first_child]];
+      Sort valsort = val->get_sort();
+      if (s->get_elemsort() != valsort)
+      {
+        throw SmtException("Expecting element sort but got "
+                           + valsort->to_string() + " and " + s->to_string());
+      }
+      else if (valsort->get_sort_kind() == ARRAY)
+      {
+        throw NotImplementedException(
+            "Transferring terms with multi-dimensional constant arrays is "
+            "not yet supported. Please contact the developers.");
+      }
+      return solver->make_term(val, s);
+    }
+    default:
+    {
+      assert(n.kind == OP_NODE);
+      Op op((PrimOp)n.prim_op);
+      op.num_idx = n.num_idx;
+      op.idx0 = n.idx0;
+      op.idx1 = n.idx1;
+
+      TermVec & cached_children = translator.cached_children;
+      cached_children.clear();
+      for (uint32_t i = 0; i < n.num_children; ++i)
+      {
+        cached_children.push_back(terms[dag.children[n.first_child + i]]);
+      }
+      if (!check_sortedness(op, cached_children))
+      {
+        // see TermTranslator::transfer_term
+        return translator.cast_op(op, cached_children);
+      }
+      return solver->make_term(op, cached_children);
+    }
+  }
+}
+
+void TermDagBuilder::build(const TermDagView & dag)
+{
+  sorts.reserve(dag.num_sorts);
+  for (size_t i = sorts.size(); i < dag.num_sorts; ++i)
+  {
+    sorts.push_back(build_sort(dag, dag.sorts[i]));
+  }
+  terms.reserve(dag.num_nodes);
+  for (size_t i = terms.size(); i < dag.num_nodes; ++i)
+  {
+    terms.push_back(build_node(dag, dag.nodes[i]));
+  }
+  translator.cached_children.clear();
+}
+
+Term TermDagBuilder::cast_sort_kind(const Term & t, const SortKind sk) const
+{
+  return translator.cast_sort_kind(t, sk);
+}
+
+/* TermDagLoader */
+
+TermDagLoader::TermDagLoader(const SmtSolver & s) : builder(s) {}
+
+TermVec TermDagLoader::load(const char * data, size_t size)
+{
+  if (reinterpret_cast<uintptr_t>(data) % 8)
+  {
+    throw IncorrectUsageException("Term DAG data must be aligned to 8 bytes");
+  }
+
+  TermDagHeader h;
+  if (size < sizeof(h))
+  {
+    malformed("too short");
+  }
+  memcpy(&h, data, sizeof(h));
+  if (memcmp(h.magic, TERM_DAG_MAGIC, sizeof(h.magic)))
+  {
+    malformed("not a term DAG");
+  }
+  if (h.version != TERM_DAG_VERSION)
+  {
+    malformed("unsupported version (or byte order) "
+              + std::to_string(h.version));
+  }
+
+  // the counts are at most 2^32 or checked against the size before use,
+  // so the offsets cannot overflow
+  uint64_t offset = padded(sizeof(h));
+  auto table = [&](uint64_t count, uint64_t elem_size) {
+    if (count > size || count * elem_size > size - offset)
+    {
+      malformed("truncated");
+    }
+    const char * res = data + offset;
+    offset += padded(count * elem_size);
+    // the padding of the last table may be missing
+    offset = min<uint64_t>(offset, size);
+    return res;
+  };
+
+  TermDagView v;
+  v.num_sorts = h.num_sorts;
+  v.sorts = reinterpret_cast<const TermDagSort *>(
+      table(h.num_sorts, sizeof(TermDagSort)));
+  v.num_sort_args = h.num_sort_args;
+  v.sort_args =
+      reinterpret_cast<const uint32_t *>(table(h.num_sort_args, 4));
+  v.num_nodes = h.num_nodes;
+  v.nodes = reinterpret_cast<const TermDagNode *>(
+      table(h.num_nodes, sizeof(TermDagNode)));
+  v.num_children = h.num_children;
+  v.children = reinterpret_cast<const uint32_t *>(table(h.num_children, 4));
+  const uint32_t * roots =
+      reinterpret_cast<const uint32_t *>(table(h.num_roots, 4));
+  v.num_strings = h.num_strings;
+  v.string_offsets = reinterpret_cast<const uint64_t *>(
+      table((uint64_t)h.num_strings + 1, 8));
+  v.string_data = table(h.num_string_bytes, 1);
+  v.num_bvs = h.num_bvs;
+  v.bvs =
+      reinterpret_cast<const TermDagBV *>(table(h.num_bvs, sizeof(TermDagBV)));
+  v.num_bv_words = h.num_bv_words;
+  v.bv_words = reinterpret_cast<const uint64_t *>(table(h.num_bv_words, 8));
+
+  v.check();
+  if (v.string_offsets[v.num_strings] != h.num_string_bytes)
+  {
+    malformed("string offsets exceed the string data");
+  }
+  for (uint32_t i = 0; i < h.num_roots; ++i)
+  {
+    if (roots[i] >= v.num_nodes)
+    {
+      malformed("root " + std::to_string(i));
+    }
+  }
+
+  builder.clear();
+  builder.build(v);
+
+  TermVec res;
+  res.reserve(h.num_roots);
+  for (uint32_t i = 0; i < h.num_roots; ++i)
+  {
+    res.push_back(builder.get_term(roots[i]));
+  }
+  // don't keep the terms of this DAG alive
+  builder.clear();
+  return res;
+}
+
+TermVec TermDagLoader::load(istream & in)
+{
+  string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  // copy to 8-byte aligned memory
+  vector<uint64_t> buf((bytes.size() + 7) / 8);
+  memcpy(buf.data(), bytes.data(), bytes.size());
+  return load(reinterpret_cast<const char *>(buf.data()), bytes.size());
+}
+
+TermVec TermDagLoader::load_file(const string & filename)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    throw IncorrectUsageException("Could not open " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    throw IncorrectUsageException("Could not read " + filename);
+  }
+  size_t size = st.st_size;
+  if (size == 0)
+  {
+    close(fd);
+    malformed("empty file " + filename);
+  }
+
+  void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    throw IncorrectUsageException("Could not map " + filename);
+  }
+
+  TermVec res;
+  try
+  {
+    res = load(static_cast<const char *>(data), size);
+  }
+  catch (...)
+  {
+    munmap(data, size);
+    throw;
+  }
+  munmap(data, size);
+  return res;
+}
+
+}  // namespace smt
@@ -0,0 +1,206 @@
+/*********************                                                        */
+/*! \file term_features.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Syntactic features of formulas, used to predict which solver
+**        is fastest on them.
+**
+**/
+
+#include "term_features.h"
+
+#include <algorithm>
+
+#include "sort.h"
+
+using namespace std;
+
+namespace smt {
+
+// number of bits needed for n, i.e. floor(log2(n)) + 1 (0 for 0)
+static unsigned int magnitude(uint64_t n)
+{
+  unsigned int res = 0;
+  while (n)
+  {
+    ++res;
+    n >>= 1;
+  }
+  return res;
+}
+
+// the operators that are nonlinear when some of their operands are not
+// values, see is_nonlinear
+static bool is_nonlinear_op(PrimOp po)
+{
+  switch (po)
+  {
+    case Mult:
+    case Div:
+    case Mod:
+    case Pow:
+    case IntDiv:
+    case BVMul:
+    case BVUdiv:
+    case BVSdiv:
+    case BVUrem:
+    case BVSrem:
+    case BVSmod: return true;
+    default: return false;
+  }
+}
+
+// t has a nonlinear operator (see is_nonlinear_op)
+static bool is_nonlinear(PrimOp po, Term t)
+{
+  size_t num_non_values = 0;
+  bool non_value_divisor = false;
+  size_t i = 0;
+  for (const Term & c : t)
+  {
+    bool non_value = !c->is_value();
+    num_non_values += non_value;
+    non_value_divisor |= (i > 0 && non_value);
+    ++i;
+  }
+
+  switch (po)
+  {
+    // multiplying by a constant is linear
+    case Mult:
+    case BVMul: return num_non_values > 1;
+    // a power is linear only between constants
+    case Pow: return num_non_values > 0;
+    // dividing by a constant is linear, dividing a constant is not
+    default: return non_value_divisor;
+  }
+}
+
+TermFeatures::TermFeatures() { clear(); }
+
+void TermFeatures::clear()
+{
+  num_nodes = 0;
+  num_symbols = 0;
+  num_values = 0;
+  num_nonlinear = 0;
+  op_counts.fill(0);
+  max_bv_width = 0;
+  arrays = false;
+  ints = false;
+  reals = false;
+  strings = false;
+  visited.clear();
+}
+
+void TermFeatures::add_term(const Term & term)
+{
+  TermVec to_visit({ term });
+  while (to_visit.size())
+  {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(t).second)
+    {
+      continue;
+    }
+
+    ++num_nodes;
+    Sort s = t->get_sort();
+    SortKind sk = s->get_sort_kind();
+    if (sk == BV)
+    {
+      max_bv_width = std::max<uint64_t>(max_bv_width, s->get_width());
+    }
+    else if (sk == ARRAY)
+    {
+      arrays = true;
+    }
+    else if (sk == INT)
+    {
+      ints = true;
+    }
+    else if (sk == REAL)
+    {
+      reals = true;
+    }
+    else if (sk == STRING)
+    {
+      strings = true;
+    }
+
+    Op op = t->get_op();
+    if (op.is_null())
+    {
+      if (t->is_symbol())
+      {
+        ++num_symbols;
+      }
+      else if (t->is_value())
+      {
+        ++num_values;
+      }
+    }
+    else
+    {
+      PrimOp po = op.prim_op;
+      ++op_counts[po];
+      if (is_nonlinear_op(po))
+      {
+        num_nonlinear += is_nonlinear(po, t);
+      }
+    }
+
+    for (const Term & c : t)
+    {
+      to_visit.push_back(c);
+    }
+  }
+}
+
+bool TermFeatures::has_quantifiers() const
+{
+  return op_counts[Forall] > 0 || op_counts[Exists] > 0;
+}
+
+bool TermFeatures::has_nonlinear() const { return num_nonlinear > 0; }
+
+string TermFeatures::get_bucket() const
+{
+  string res;
+  auto add_theory = [&res](bool present, const char * name) {
+    if (present)
+    {
+      res += res.empty() ? "" : ".";
+      res += name;
+    }
+  };
+  add_theory(max_bv_width > 0, "BV");
+  add_theory(ints, "I");
+  add_theory(reals, "R");
+  add_theory(strings, "S");
+  add_theory(arrays, "A");
+  add_theory(has_uf(), "UF");
+  add_theory(has_quantifiers(), "Q");
+  if (res.empty())
+  {
+    res = "B";
+  }
+  if (has_nonlinear())
+  {
+    res += ".NL";
+  }
+  res += " n" + std::to_string(magnitude(num_nodes));
+  res += " s" + std::to_string(magnitude(num_symbols));
+  res += " w" + std::to_string(magnitude(max_bv_width));
+  return res;
+}
+
+}  // namespace smt
@@ -17,48 +17,248 @@
 
 #include "term_hashtable.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace smt {
 
+// the table is resized when it is more than 3/4 full
+const size_t MAX_LOAD_NUM = 3;
+const size_t MAX_LOAD_DEN = 4;
+const unsigned int MIN_LOG_SLOTS = 4;
+
+// the smallest number of slots that holds n terms within the load factor
+size_t num_slots_for(size_t n)
+{
+  size_t num_slots = size_t(1) << MIN_LOG_SLOTS;
+  while (n * MAX_LOAD_DEN > num_slots * MAX_LOAD_NUM)
+  {
+    num_slots *= 2;
+  }
+  return num_slots;
+}
+
 /* TermHashTable */
 
-TermHashTable::TermHashTable() {}
+TermHashTable::TermHashTable() : num_terms(0), log_slots(0) {}
 
 TermHashTable::~TermHashTable() {}
 
-void TermHashTable::insert(const Term & t) { table[t->hash()].insert(t); }
+size_t TermHashTable::home_slot(size_t hashval) const
+{
+  // Fibonacci hashing: spreads hash values whose low bits are
+  // similar (e.g., ids or pointers) over the whole table
+  uint64_t h = static_cast<uint64_t>(hashval) * 0x9E3779B97F4A7C15ull;
+  return static_cast<size_t>(h >> (64 - log_slots));
+}
+
+size_t TermHashTable::find_slot(const Term & t, size_t hashval) const
+{
+  size_t mask = slots.size() - 1;
+  size_t i = home_slot(hashval);
+  while (slots[i].term
+         && (slots[i].hash != hashval || !slots[i].term->compare(t)))
+  {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
 
-bool TermHashTable::contains(const Term & t) const
+void TermHashTable::rehash(size_t num_slots)
+{
+  vector<Slot> old_slots(num_slots);
+  old_slots.swap(slots);
+  log_slots = 0;
+  while ((size_t(1) << log_slots) < num_slots)
+  {
+    log_slots++;
+  }
+
+  size_t mask = slots.size() - 1;
+  for (Slot & s : old_slots)
+  {
+    if (s.term)
+    {
+      // the terms are distinct, no need to compare them
+      size_t i = home_slot(s.hash);
+      while (slots[i].term)
+      {
+        i = (i + 1) & mask;
+      }
+      slots[i] = std::move(s);
+    }
+  }
+}
+
+void TermHashTable::grow_if_needed()
+{
+  if ((num_terms + 1) * MAX_LOAD_DEN > slots.size() * MAX_LOAD_NUM)
+  {
+    rehash(slots.empty() ? (size_t(1) << MIN_LOG_SLOTS) : 2 * slots.size());
+  }
+}
+
+void TermHashTable::insert(const Term & t)
 {
+  grow_if_needed();
   size_t hashval = t->hash();
-  return (table.find(hashval) != table.end()
-          && table.at(hashval).find(t) != table.at(hashval).end());
+  size_t i = find_slot(t, hashval);
+  if (!slots[i].term)
+  {
+    slots[i].hash = hashval;
+    slots[i].term = t;
+    num_terms++;
+  }
+}
+
+bool TermHashTable::contains(const Term & t) const
+{
+  if (!num_terms)
+  {
+    return false;
+  }
+  return slots[find_slot(t, t->hash())].term != nullptr;
 }
 
 bool TermHashTable::lookup(Term & t)
 {
-  if (contains(t))
+  if (!num_terms)
+  {
+    return false;
+  }
+  const Slot & s = slots[find_slot(t, t->hash())];
+  if (s.term)
   {
     // reassign t
     // should destroy the previous Term
     // when reference counter goes to zero
-    t = *(table[t->hash()].find(t));
+    t = s.term;
     return true;
   }
   return false;
 }
 
-void TermHashTable::erase(const Term & t)
+bool TermHashTable::lookup_or_insert(Term & t)
 {
+  grow_if_needed();
   size_t hashval = t->hash();
-  if (table.find(hashval) != table.end()
-      && table[hashval].find(t) != table[hashval].end())
+  Slot & s = slots[find_slot(t, hashval)];
+  if (s.term)
+  {
+    t = s.term;
+    return true;
+  }
+  s.hash = hashval;
+  s.term = t;
+  num_terms++;
+  return false;
+}
+
+void TermHashTable::erase(const Term & t)
+{
+  if (!num_terms)
+  {
+    return;
+  }
+  size_t i = find_slot(t, t->hash());
+  if (!slots[i].term)
+  {
+    return;
+  }
+  num_terms--;
+
+  // backward-shift deletion: move later terms of the probe sequence
+  // into the hole, so that lookups never need tombstones
+  size_t mask = slots.size() - 1;
+  size_t j = i;
+  while (true)
+  {
+    j = (j + 1) & mask;
+    if (!slots[j].term)
+    {
+      break;
+    }
+    size_t home = home_slot(slots[j].hash);
+    // the term at j can fill the hole at i iff i is on its
+    // probe sequence, i.e., between home and j (cyclically)
+    if (((j - home) & mask) >= ((j - i) & mask))
+    {
+      slots[i] = std::move(slots[j]);
+      i = j;
+    }
+  }
+  slots[i].term = nullptr;
+}
+
+void TermHashTable::clear()
+{
+  slots.clear();
+  num_terms = 0;
+  log_slots = 0;
+}
+
+void TermHashTable::reserve(size_t n)
+{
+  size_t num_slots = num_slots_for(n);
+  if (num_slots > slots.size())
   {
-    table[hashval].erase(t);
+    rehash(num_slots);
   }
 }
 
-void TermHashTable::clear() { table.clear(); }
+size_t TermHashTable::size() const { return num_terms; }
+
+size_t TermHashTable::memory_usage() const
+{
+  return slots.capacity() * sizeof(Slot);
+}
+
+size_t TermHashTable::sweep()
+{
+  vector<Slot> live;
+  live.reserve(num_terms);
+  for (Slot & s : slots)
+  {
+    if (s.term)
+    {
+      live.push_back(std::move(s));
+    }
+  }
+
+  // a term is referenced by its parents, so it can only be freed after
+  // them. Parents are usually created after their children, i.e., have
+  // larger ids, so going from the largest id frees whole DAGs of
+  // unused terms in one pass. Otherwise, another pass is needed.
+  std::sort(live.begin(), live.end(), [](const Slot & a, const Slot & b) {
+    return a.term->get_id() > b.term->get_id();
+  });
+  size_t num_removed = 0;
+  bool removed = true;
+  while (removed)
+  {
+    removed = false;
+    for (Slot & s : live)
+    {
+      if (s.term && s.term.use_count() == 1)
+      {
+        // only releases this term: its children are still in the table
+        s.term.reset();
+        num_removed++;
+        removed = true;
+      }
+    }
+  }
+  live.erase(
+      std::remove_if(
+          live.begin(), live.end(), [](const Slot & s) { return !s.term; }),
+      live.end());
+
+  // rebuild the probe sequences of the remaining terms
+  num_terms = live.size();
+  slots = std::move(live);
+  rehash(num_slots_for(num_terms));
+  return num_removed;
+}
 
 }  // namespace smt
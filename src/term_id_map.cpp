@@ -0,0 +1,120 @@
+/*********************                                                        */
+/*! \file term_id_map.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A map from Terms to Terms indexed by term id -- used for the
+**        cache of IdentityWalker
+**
+**
+**/
+
+#include "term_id_map.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace smt {
+
+// the vector can grow to this many slots per entry,
+// so that its size stays proportional to the number of entries
+const size_t SLOTS_PER_ENTRY = 16;
+// but at least to this many
+const size_t MIN_DENSE_SLOTS = 64;
+
+const Term * TermIdMap::find(const Term & key) const
+{
+  if (!dense_)
+  {
+    auto it = sparse_.find(key);
+    return it == sparse_.end() ? nullptr : &it->second;
+  }
+
+  size_t id = key->get_id();
+  if (id >= slots_.size())
+  {
+    return nullptr;
+  }
+  const pair<Term, Term> & slot = slots_[id];
+  // the same pointer is the common case, compare is for backends that
+  // wrap the same solver term in several objects
+  if (slot.first && (slot.first.get() == key.get() || slot.first == key))
+  {
+    return &slot.second;
+  }
+  return nullptr;
+}
+
+void TermIdMap::set(const Term & key, const Term & val)
+{
+  if (dense_)
+  {
+    size_t id = key->get_id();
+    if (id >= slots_.size())
+    {
+      size_t max_slots =
+          max(MIN_DENSE_SLOTS, SLOTS_PER_ENTRY * (used_.size() + 1));
+      if (id < max_slots)
+      {
+        slots_.resize(min(max_slots, max(id + 1, 2 * slots_.size())));
+      }
+    }
+
+    if (id < slots_.size())
+    {
+      pair<Term, Term> & slot = slots_[id];
+      if (!slot.first)
+      {
+        slot.first = key;
+        slot.second = val;
+        used_.push_back(id);
+        return;
+      }
+      else if (slot.first == key)
+      {
+        slot.second = val;
+        return;
+      }
+    }
+    // too sparse, or two keys with the same id
+    make_sparse();
+  }
+  sparse_[key] = val;
+}
+
+void TermIdMap::clear()
+{
+  for (size_t id : used_)
+  {
+    slots_[id] = pair<Term, Term>();
+  }
+  used_.clear();
+  sparse_.clear();
+  dense_ = true;
+}
+
+size_t TermIdMap::size() const
+{
+  return dense_ ? used_.size() : sparse_.size();
+}
+
+void TermIdMap::make_sparse()
+{
+  sparse_.reserve(used_.size());
+  for (size_t id : used_)
+  {
+    sparse_.emplace(std::move(slots_[id].first), std::move(slots_[id].second));
+    slots_[id] = pair<Term, Term>();
+  }
+  used_.clear();
+  dense_ = false;
+}
+
+}  // namespace smt
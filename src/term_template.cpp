@@ -0,0 +1,182 @@
+/*********************                                                        */
+/*! \file term_template.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A term with parameters, compiled for repeated instantiation,
+**        e.g. the body of an SMT-LIB define-fun.
+**
+**/
+
+#include "term_template.h"
+
+#include "exceptions.h"
+#include "solver.h"
+#include "utils.h"
+
+using namespace std;
+
+namespace smt {
+
+size_t TermVecHash::operator()(const TermVec & terms) const
+{
+  size_t result = terms.size();
+  for (const Term & t : terms)
+  {
+    hash_combine(result, hash<Term>()(t));
+  }
+  return result;
+}
+
+TermTemplate::TermTemplate(const Term & body, const TermVec & params)
+    : num_params_(params.size())
+{
+  // whether each visited subterm contains a parameter
+  unordered_map<Term, bool> has_param;
+  for (const Term & p : params)
+  {
+    if (!has_param.emplace(p, true).second)
+    {
+      throw IncorrectUsageException("Repeated parameter in TermTemplate: "
+                                    + p->to_string());
+    }
+  }
+
+  // first collect the nodes in post-order and the constants
+  TermVec node_terms;
+  TermVec to_visit{ body };
+  Term t;
+  while (to_visit.size())
+  {
+    t = to_visit.back();
+    if (has_param.find(t) != has_param.end())
+    {
+      to_visit.pop_back();
+      continue;
+    }
+
+    // const arrays have children but are never rebuilt
+    // (same as AbsSmtSolver::substitute)
+    bool leaf = t->is_value() || t->begin() == t->end();
+    bool visited_children = true;
+    if (!leaf)
+    {
+      for (const Term & c : t)
+      {
+        if (has_param.find(c) == has_param.end())
+        {
+          to_visit.push_back(c);
+          visited_children = false;
+        }
+      }
+    }
+    if (!visited_children)
+    {
+      continue;
+    }
+    to_visit.pop_back();
+
+    bool rebuilt = false;
+    if (!leaf)
+    {
+      for (const Term & c : t)
+      {
+        rebuilt |= has_param.at(c);
+      }
+    }
+    has_param[t] = rebuilt;
+    if (rebuilt)
+    {
+      node_terms.push_back(t);
+    }
+  }
+
+  // then number the parameters, nodes and constants (see ref)
+  unordered_map<Term, size_t> refs;
+  for (size_t i = 0; i < num_params_; ++i)
+  {
+    refs[params[i]] = i;
+  }
+  for (size_t i = 0; i < node_terms.size(); ++i)
+  {
+    refs[node_terms[i]] = num_params_ + i;
+  }
+  auto get_ref = [this, &refs, &node_terms](const Term & t) {
+    auto it = refs.find(t);
+    if (it == refs.end())
+    {
+      it = refs.emplace(t, num_params_ + node_terms.size() + constants_.size())
+               .first;
+      constants_.push_back(t);
+    }
+    return it->second;
+  };
+
+  nodes_.reserve(node_terms.size());
+  for (Term n : node_terms)
+  {
+    nodes_.push_back({ n->get_op(), {} });
+    for (const Term & c : n)
+    {
+      nodes_.back().children.push_back(get_ref(c));
+    }
+  }
+  result_ = get_ref(body);
+}
+
+Term TermTemplate::instantiate(const SmtSolver & solver, const TermVec & args)
+{
+  if (args.size() != num_params_)
+  {
+    throw IncorrectUsageException(
+        "TermTemplate instantiated with " + std::to_string(args.size())
+        + " arguments but expected " + std::to_string(num_params_));
+  }
+
+  auto it = instances_.find(args);
+  if (it != instances_.end())
+  {
+    return it->second;
+  }
+
+  TermVec built;
+  built.reserve(nodes_.size());
+  TermVec children;
+  for (const Node & n : nodes_)
+  {
+    children.clear();
+    for (size_t r : n.children)
+    {
+      children.push_back(ref(r, args, built));
+    }
+    built.push_back(solver->make_term(n.op, children));
+  }
+
+  Term res = ref(result_, args, built);
+  instances_[args] = res;
+  return res;
+}
+
+const Term & TermTemplate::ref(size_t r,
+                               const TermVec & args,
+                               const TermVec & built) const
+{
+  if (r < num_params_)
+  {
+    return args[r];
+  }
+  r -= num_params_;
+  if (r < built.size())
+  {
+    return built[r];
+  }
+  return constants_[r - nodes_.size()];
+}
+
+}  // namespace smt
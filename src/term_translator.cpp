@@ -14,6 +14,8 @@
 **        symbols, which would throw an exception).
 **/
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <sstream>
 #include <unordered_map>
@@ -138,165 +140,144 @@ Sort TermTranslator::transfer_sort(const Sort & sort)
 
 Term TermTranslator::transfer_term(const Term & term)
 {
-  if (cache.find(term) != cache.end())
+  auto cit = cache.find(term);
+  if (cit != cache.end())
   {
-    return cache.at(term);
+    return cit->second;
   }
 
-  TermVec to_visit{ term };
-  // better to keep a separate set for visited
-  // then if something is in the cache, we can
-  // assume it's already been processed
-  // not just visited
-  UnorderedTermSet visited;
-  TermVec children;
-  TermVec cached_children;
-  Term t;
+  // explicit stack instead of a separate visited set
+  // the flag records whether the children have already been pushed
+  // then if a term is popped with the flag set, all its children
+  // are in the cache
+  visit_stack.clear();
+  visit_stack.emplace_back(term, false);
   Sort s;
-  while (to_visit.size())
+  while (visit_stack.size())
   {
-    t = to_visit.back();
-    to_visit.pop_back();
+    if (!visit_stack.back().second)
+    {
+      visit_stack.back().second = true;
+      // raw pointer because pushing children can reallocate the stack
+      // the term is kept alive by its (moved) entry
+      AbsTerm * t = visit_stack.back().first.get();
+      if (cache.find(visit_stack.back().first) != cache.end())
+      {
+        // cache hit
+        // it's already been processed
+        visit_stack.pop_back();
+        continue;
+      }
 
+      // insert in reverse order
+      // helps symbols be declared in same order
+      size_t first_child = visit_stack.size();
+      for (TermIter it = t->begin(), end = t->end(); it != end; ++it)
+      {
+        Term c = *it;
+        if (cache.find(c) == cache.end())
+        {
+          visit_stack.emplace_back(std::move(c), false);
+        }
+      }
+      std::reverse(visit_stack.begin() + first_child, visit_stack.end());
+      continue;
+    }
+
+    Term t = std::move(visit_stack.back().first);
+    visit_stack.pop_back();
     if (cache.find(t) != cache.end())
     {
-      // cache hit
-      // it's already been processed
+      // a term shared by several parents can be pushed more than once
+      // before it is processed
       continue;
     }
 
-    if (visited.find(t) == visited.end())
+    if (t->is_symbol())
     {
-      // doesn't get updated yet, just marking as visited
-      visited.insert(t);
-      // need to visit it again
-      to_visit.push_back(t);
-
-      // insert in reverse order
-      // helps symbols be declared in same order
-      children.clear();
-      children.insert(children.end(), t->begin(), t->end());
-      for (auto it = children.rbegin(); it != children.rend(); it++)
+      s = transfer_sort(t->get_sort());
+      string name = t->to_string();
+      try
+      {
+        Term sym = solver->get_symbol(name);
+        // the sort should already match the expected sort
+        // or be castable to the same sort
+        assert(
+            s == sym->get_sort() ||
+            // can't properly transfer uninterpreted sort, so ignore that case
+            // (no way to look up uninterpreted sort by name, so transfer_sort
+            //  would make a new sort with the same name)
+            // relying on short-circuit semantics so cast_term line not
+            // executed
+            uses_uninterp_sort(sym->get_sort())
+            || s == cast_term(sym, s)->get_sort());
+        cache.emplace(std::move(t), std::move(sym));
+      }
+      catch (IncorrectUsageException & e)
       {
-        to_visit.push_back(*it);
+        Term sym = solver->make_symbol(name, s);
+        cache.emplace(std::move(t), std::move(sym));
       }
     }
+    else if (t->is_param())
+    {
+      s = transfer_sort(t->get_sort());
+      Term param = solver->make_param(t->to_string(), s);
+      cache.emplace(std::move(t), std::move(param));
+    }
+    else if (t->is_value())
+    {
+      Term val = transfer_value(t);
+      cache.emplace(std::move(t), std::move(val));
+    }
     else
     {
-      if (t->is_symbol())
-      {
-        s = transfer_sort(t->get_sort());
-        string name = t->to_string();
-        try
-        {
-          Term sym = solver->get_symbol(name);
-          cache[t] = sym;
-          // the sort should already match the expected sort
-          // or be castable to the same sort
-          assert(
-              s == sym->get_sort() ||
-              // can't properly transfer uninterpreted sort, so ignore that case
-              // (no way to look up uninterpreted sort by name, so transfer_sort
-              //  would make a new sort with the same name)
-              // relying on short-circuit semantics so cast_term line not
-              // executed
-              uses_uninterp_sort(sym->get_sort())
-              || s == cast_term(sym, s)->get_sort());
-        }
-        catch (IncorrectUsageException & e)
-        {
-          cache[t] = solver->make_symbol(name, s);
-        }
-      }
-      else if (t->is_param())
+      assert(!t->get_op().is_null());
+
+      cached_children.clear();
+      for (auto c : t)
       {
-        s = transfer_sort(t->get_sort());
-        cache[t] = solver->make_param(t->to_string(), s);
+        cached_children.push_back(cache.at(c));
       }
-      else if (t->is_value())
+      assert(cached_children.size());
+
+      Op op = t->get_op();
+      Term res;
+      if (!check_sortedness(op, cached_children))
       {
-        s = transfer_sort(t->get_sort());
-        if (s->get_sort_kind() == ARRAY)
-        {
-          // special case for const-array
-          assert(t->begin() != t->end());
-          Term val = cache.at(*(t->begin()));
-          Sort valsort = val->get_sort();
-          if (s->get_sort_kind() != ARRAY)
-          {
-            throw SmtException("Expecting array sort but got: "
-                               + s->to_string());
-          }
-          else if (s->get_elemsort() != valsort)
-          {
-            throw SmtException("Expecting element sort but got "
-                               + val->get_sort()->to_string() + " and "
-                               + s->to_string());
-          }
-          else if (valsort->get_sort_kind() == ARRAY)
-          {
-            throw NotImplementedException(
-                "Transferring terms with multi-dimensional constant arrays is "
-                "not yet supported. Please contact the developers.");
-          }
-          cache[t] = solver->make_term(val, s);
-        }
-        else
-        {
-          // pass the original sort here
-          // allows us to transfer from a solver that doesn't alias sorts
-          // to one that does alias sorts
-          // the sort will be transferred again in value_from_smt2
-          cache[t] = value_from_smt2(
-              t->print_value_as(t->get_sort()->get_sort_kind()), t->get_sort());
-        }
+        /* NOTE: interesting behavior here
+           if transferring between two solvers that alias sorts
+           e.g. two different instances of BTOR
+           the sorted-ness check will still fail for something like
+           Ite(BV{1}, BV{8}, BV{8})
+           so we'll reach this point and cast
+           but the cast won't actually do anything for BTOR
+           in other words, check_sortedness is not guaranteed
+           to hold after casting */
+        res = cast_op(op, cached_children);
       }
       else
       {
-        assert(!t->is_symbol());
-        assert(!t->is_param());
-        assert(!t->is_value());
-        assert(!t->get_op().is_null());
-
-        cached_children.clear();
-        for (auto c : t)
-        {
-          cached_children.push_back(cache.at(c));
-        }
-        assert(cached_children.size());
-
-        Op op = t->get_op();
-        if (!check_sortedness(op, cached_children))
-        {
-          /* NOTE: interesting behavior here
-             if transferring between two solvers that alias sorts
-             e.g. two different instances of BTOR
-             the sorted-ness check will still fail for something like
-             Ite(BV{1}, BV{8}, BV{8})
-             so we'll reach this point and cast
-             but the cast won't actually do anything for BTOR
-             in other words, check_sortedness is not guaranteed
-             to hold after casting */
-          cache[t] = cast_op(op, cached_children);
-        }
-        else
-        {
-          cache[t] = solver->make_term(t->get_op(), cached_children);
-        }
+        res = solver->make_term(op, cached_children);
       }
+      cache.emplace(std::move(t), std::move(res));
     }
   }
+  // don't hold on to the children between calls
+  cached_children.clear();
 
   assert(cache.find(term) != cache.end());
-  // make sure the sort is as-expected and cast if not
-  // for dealing with solvers that alias sorts
-
   return cache.at(term);
 }
 
 Term TermTranslator::transfer_term(const Term & term, const SortKind sk)
 {
-  Term transferred_term = transfer_term(term);
+  return cast_sort_kind(transfer_term(term), sk);
+}
+
+Term TermTranslator::cast_sort_kind(const Term & transferred_term,
+                                    const SortKind sk) const
+{
   Sort transferred_sort = transferred_term->get_sort();
   SortKind transferred_sk = transferred_sort->get_sort_kind();
   if (transferred_sk == sk)
@@ -372,8 +353,14 @@ std::string TermTranslator::infixize_rational(const std::string smtlib) const {
 Term TermTranslator::value_from_smt2(const std::string val,
                                      const Sort orig_sort)
 {
-  SortKind sk = orig_sort->get_sort_kind();
-  Sort sort = transfer_sort(orig_sort);
+  return value_from_smt2(
+      val, orig_sort->get_sort_kind(), transfer_sort(orig_sort));
+}
+
+Term TermTranslator::value_from_smt2(const std::string val,
+                                     const SortKind sk,
+                                     const Sort sort) const
+{
   if (sk == BV)
   {
     // TODO: Only put checks in debug mode
@@ -458,6 +445,66 @@ Term TermTranslator::value_from_smt2(const std::string val,
   }
 }
 
+Term TermTranslator::transfer_value(const Term & val)
+{
+  Sort orig_sort = val->get_sort();
+  SortKind sk = orig_sort->get_sort_kind();
+  Sort s = transfer_sort(orig_sort);
+  if (sk == ARRAY)
+  {
+    // special case for const-array
+    assert(val->begin() != val->end());
+    Term elem = cache.at(*(val->begin()));
+    Sort elemsort = elem->get_sort();
+    if (s->get_elemsort() != elemsort)
+    {
+      throw SmtException("Expecting element sort but got "
+                         + elemsort->to_string() + " and " + s->to_string());
+    }
+    else if (elemsort->get_sort_kind() == ARRAY)
+    {
+      throw NotImplementedException(
+          "Transferring terms with multi-dimensional constant arrays is "
+          "not yet supported. Please contact the developers.");
+    }
+    return solver->make_term(elem, s);
+  }
+  else if (sk == BV)
+  {
+    // bit-vectors go through the solver-neutral representation
+    // linear in the width, unlike printing and parsing decimal values
+    return solver->make_term(val->to_bv_value(), s);
+  }
+  else if (sk == INT)
+  {
+    // avoid printing and parsing the value when it fits in a machine integer
+    // to_int throws if it does not, and some solvers return negative
+    // integers wrapped around, which are caught by the bound
+    // the bound is the smallest one accepted by all the make_term(int64_t)
+    // implementations (e.g. mathsat takes a 32-bit int)
+    uint64_t i;
+    try
+    {
+      i = val->to_int();
+    }
+    catch (IncorrectUsageException & e)
+    {
+      return value_from_smt2(val->print_value_as(sk), orig_sort);
+    }
+
+    if (i <= INT32_MAX)
+    {
+      return solver->make_term(static_cast<int64_t>(i), s);
+    }
+  }
+
+  // pass the original sort here
+  // allows us to transfer from a solver that doesn't alias sorts
+  // to one that does alias sorts
+  // the sort will be transferred again in value_from_smt2
+  return value_from_smt2(val->print_value_as(sk), orig_sort);
+}
+
 Term TermTranslator::cast_op(Op op, const TermVec & terms) const
 {
   assert(!check_sortedness(op, terms));
@@ -85,8 +85,15 @@ int main()
   PortfolioSolver p(solvers, test_term);
   smt::Result res = p.portfolio_solve();
   cout << "portfolio_solve " << res.is_sat() << endl;
+  cout << "winner " << p.get_winner() << " in "
+       << p.get_solve_time().count() << "s" << endl;
 
   assert(res.is_sat());
+  assert(p.get_winner() < solvers.size());
+
+  // the solvers were stopped and can be queried again
+  res = p.portfolio_solve();
+  assert(res.is_sat());
 
   SmtSolver s1_2 = MsatSolverFactory::create(false);
   SmtSolver s2_2 = MsatSolverFactory::create(false);
@@ -113,5 +120,58 @@ int main()
 
   assert(res2.is_sat());
 
+  // incremental portfolio, terms are built by s
+  vector<SmtSolver> members{ BoolectorSolverFactory::create(false),
+                             Yices2SolverFactory::create(false),
+                             Cvc5SolverFactory::create(false) };
+  SmtSolver ip = make_shared<PortfolioSolver>(s, members);
+  ip->set_opt("incremental", "true");
+  ip->set_opt("produce-models", "true");
+  Term x = nts[0];
+  Term y = nts[1];
+  ip->assert_formula(ip->make_term(BVUlt, x, y));
+  for (int k = 0; k < 3; ++k)
+  {
+    ip->push();
+    ip->assert_formula(ip->make_term(Equal, y, ip->make_term(k + 1, bvsort)));
+    smt::Result r = ip->check_sat();
+    assert(r.is_sat());
+    // the model comes from the winner, as terms of s
+    Term xv = ip->get_value(x);
+    assert(xv->to_int() <= k);
+    ip->pop();
+  }
+  Term b = ip->make_symbol("b", ip->make_sort(BOOL));
+  ip->assert_formula(ip->make_term(Implies, b, ip->make_term(Equal, x, y)));
+  smt::Result r = ip->check_sat_assuming({ b });
+  assert(r.is_unsat());
+  UnorderedTermSet core;
+  ip->get_unsat_assumptions(core);
+  assert(core.size() == 1 && *core.begin() == b);
+
+  // launch the k members that a selector ranks best
+  shared_ptr<SolverSelector> sel = make_shared<SolverSelector>();
+  for (size_t k = 1; k <= 2; ++k)
+  {
+    vector<SmtSolver> sel_members{ BoolectorSolverFactory::create(false),
+                                   Yices2SolverFactory::create(false) };
+    shared_ptr<PortfolioSolver> sp =
+        make_shared<PortfolioSolver>(s, sel_members);
+    sp->set_selector(sel, k);
+    sp->assert_formula(sp->make_term(BVUlt, x, y));
+    r = sp->check_sat();
+    assert(r.is_sat());
+    if (k == 1)
+    {
+      // nothing recorded yet, the first member is launched alone
+      assert(sp->get_winner() == 0);
+    }
+  }
+  // the first query ran one member, the second both of them
+  TermFeatures f;
+  f.add_term(s->make_term(BVUlt, x, y));
+  assert(sel->get_performance(f.get_bucket(), "BTOR").runs == 2);
+  assert(sel->get_performance(f.get_bucket(), "YICES2").runs == 1);
+
   return 0;
 }
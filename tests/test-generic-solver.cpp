@@ -18,6 +18,7 @@
 #ifndef __APPLE__
 
 #include <array>
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
@@ -34,6 +35,7 @@
 // it cannot be compiled outside of the build
 #include "cvc5_factory.h"
 #include "generic_solver.h"
+#include "generic_solver_pool.h"
 #include "smt.h"
 #include "test-utils.h"
 
@@ -193,6 +195,24 @@ void test_bv_2(SmtSolver gs)
   }
 }
 
+void test_hash_consing(SmtSolver gs)
+{
+  cout << "building the same terms twice" << endl;
+  Sort bvsort = gs->make_sort(BV, 8);
+  Term x = gs->make_symbol("x", bvsort);
+  Term one = gs->make_term(1, bvsort);
+  Term sum_1 = gs->make_term(BVAdd, x, one);
+  Term sum_2 = gs->make_term(BVAdd, x, gs->make_term(1, bvsort));
+  assert(sum_1.get() == sum_2.get());
+  Term ext_1 = gs->make_term(Op(Extract, 3, 0), sum_1);
+  Term ext_2 = gs->make_term(Op(Extract, 3, 0), sum_2);
+  Term ext_3 = gs->make_term(Op(Extract, 4, 0), sum_2);
+  assert(ext_1.get() == ext_2.get());
+  assert(ext_1 != ext_3);
+  gs->assert_formula(gs->make_term(Distinct, sum_1, sum_2));
+  assert(gs->check_sat().is_unsat());
+}
+
 void test_uf_2(SmtSolver gs)
 {
   Sort s = gs->make_sort("S", 0);
@@ -454,6 +474,8 @@ void test_quantifiers(SmtSolver gs)
   Term matrix1 = gs->make_term(Gt, par1, sum);
   Term exists1 = gs->make_term(Exists, par2, matrix1);
   Term forall1 = gs->make_term(Forall, par1, exists1);
+  // terms with bound variables are printed in full
+  assert(matrix1->to_string() == "(> par1 (+ par1 par2))");
   gs->assert_formula(forall1);
   Result result = gs->check_sat();
   assert(result.is_sat());
@@ -572,6 +594,27 @@ void test_unsat_assumptions(SmtSolver gs)
   gs->pop(1);
 }
 
+void test_check_sat_async(SmtSolver gs)
+{
+  cout << "checking satisfiability asynchronously" << endl;
+  shared_ptr<GenericSolver> gen = static_pointer_cast<GenericSolver>(gs);
+  Sort bvsort = gs->make_sort(BV, 4);
+  Term x = gs->make_symbol("x", bvsort);
+  gs->assert_formula(gs->make_term(BVUlt, x, gs->make_term(2, bvsort)));
+  gs->push();
+  gs->assert_formula(gs->make_term(BVUgt, x, gs->make_term(5, bvsort)));
+  GenericAsyncResult r = gen->check_sat_async(std::chrono::seconds(60));
+  assert(r.get().is_unsat());
+
+  // a cancelled query restarts the binary with the same assertion stack
+  r = gen->check_sat_async();
+  r.cancel();
+  assert(r.get().is_unknown());
+  assert(gs->check_sat().is_unsat());
+  gs->pop();
+  assert(gs->check_sat().is_sat());
+}
+
 void init_solver(SmtSolver gs)
 {
   gs->set_opt("produce-models", "true");
@@ -609,13 +652,17 @@ void new_yices2(SmtSolver & gs, int buffer_size)
   init_solver(gs);
 }
 
-void new_cvc5(SmtSolver & gs, int buffer_size)
+void new_cvc5(SmtSolver & gs,
+              int buffer_size,
+              bool pipelined = false,
+              bool restartable = false)
 {
   gs.reset();
   string path = (STRFY(CVC5_HOME));
   path += "/build/bin/cvc5";
   vector<string> args = { "--lang=smt2", "--incremental", "--dag-thresh=0" };
-  gs = std::make_shared<GenericSolver>(path, args, buffer_size, buffer_size);
+  gs = std::make_shared<GenericSolver>(
+      path, args, buffer_size, buffer_size, pipelined, restartable);
   init_solver(gs);
 }
 
@@ -763,6 +810,9 @@ void test_yices2(int buffer_size)
 void test_cvc5(int buffer_size)
 {
   SmtSolver gs;
+  new_cvc5(gs, buffer_size, false, true);
+  test_check_sat_async(gs);
+
   new_cvc5(gs, buffer_size);
   test_bad_term_1(gs);
 
@@ -793,6 +843,9 @@ void test_cvc5(int buffer_size)
   new_cvc5(gs, buffer_size);
   test_bv_1(gs);
 
+  new_cvc5(gs, buffer_size);
+  test_hash_consing(gs);
+
   new_cvc5(gs, buffer_size);
   test_bv_2(gs);
 
@@ -833,6 +886,84 @@ void test_cvc5(int buffer_size)
   test_unsat_assumptions(gs);
 }
 
+void test_pipelined_bad_cmd(SmtSolver gs)
+{
+  cout << "trying a bad command in pipelined mode:" << endl;
+  // the failure is only reported when the queue is flushed
+  gs->set_opt("iiiaaaaiiiiaaaa", "aaa");
+  try
+  {
+    gs->check_sat();
+    assert(false);
+  }
+  catch (IncorrectUsageException e)
+  {
+    cout << "caught the exception" << endl;
+  }
+  // the solver is still usable afterwards
+  Result r = gs->check_sat();
+  assert(r.is_sat());
+}
+
+void test_cvc5_pipelined(int buffer_size)
+{
+  SmtSolver gs;
+  new_cvc5(gs, buffer_size, true);
+  test_pipelined_bad_cmd(gs);
+
+  new_cvc5(gs, buffer_size, true, true);
+  test_check_sat_async(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_bool_2(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_bv_3(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_abv_1(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_bv_models(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_check_sat_assuming_2(gs);
+
+  new_cvc5(gs, buffer_size, true);
+  test_unsat_assumptions(gs);
+}
+
+void test_cvc5_pool(int buffer_size)
+{
+  string path = (STRFY(CVC5_HOME));
+  path += "/build/bin/cvc5";
+  vector<string> args = { "--lang=smt2", "--incremental", "--dag-thresh=0" };
+  GenericSolverPool pool(path, args, 3, buffer_size, buffer_size);
+  SmtSolver gs = pool.get_solver();
+  init_solver(gs);
+  Sort bvsort = gs->make_sort(BV, 4);
+  Term x = gs->make_symbol("x", bvsort);
+  pool.assert_formula(gs->make_term(BVUlt, x, gs->make_term(8, bvsort)));
+
+  // x = i is satisfiable exactly for i < 8
+  vector<TermVec> queries;
+  for (int i = 0; i < 16; ++i)
+  {
+    queries.push_back(
+        { gs->make_term(Equal, x, gs->make_term(i, bvsort)) });
+  }
+  vector<Result> results = pool.check_sat_assuming_all(queries);
+  for (int i = 0; i < 16; ++i)
+  {
+    assert(results[i].is_sat() == (i < 8));
+  }
+
+  // later assertions and terms reach workers that already answered queries
+  pool.assert_formula(gs->make_term(BVUge, x, gs->make_term(4, bvsort)));
+  assert(pool.check_sat_assuming({ queries[2][0] }).is_unsat());
+  assert(pool.check_sat_assuming({ queries[5][0] }).is_sat());
+}
+
 void test_btor(int buffer_size)
 {
   cout << "testing btor" << endl;
@@ -920,6 +1051,10 @@ int main() {
 #if BUILD_CVC5
     std::cout << "testing cvc5" << std::endl;
     test_cvc5(buffer_size);
+    std::cout << "testing cvc5 with pipelining" << std::endl;
+    test_cvc5_pipelined(buffer_size);
+    std::cout << "testing a pool of cvc5 processes" << std::endl;
+    test_cvc5_pool(buffer_size);
 #endif
 
 // testing with msat binary
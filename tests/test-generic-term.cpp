@@ -43,7 +43,8 @@ int main() {
   Sort int_sort = make_generic_sort(INT);
   GenericTerm one(int_sort, Op(), {}, "1");
   GenericTerm one_prime(int_sort, Op(), {}, "1");
-  assert(one.get_id() == one_prime.get_id());
+  // ids are unique per object, hashes are structural
+  assert(one.get_id() != one_prime.get_id());
   assert(one.hash() == one_prime.hash());
   assert(!one.is_symbol());
   assert(!one.is_param());
@@ -52,9 +53,69 @@ int main() {
   cout << "Testing an integer variable" << endl;
   GenericTerm x(int_sort, Op(), {}, "x", true);
   GenericTerm x_prime(int_sort, Op(), {}, "x", true);
-  assert(x.get_id() == x_prime.get_id());
+  assert(x.get_id() != x_prime.get_id());
   assert(x.hash() == x_prime.hash());
   assert(x.is_symbol());
   assert(!x.is_param());
   assert(x.is_symbolic_const());
+
+  cout << "Testing structural hashing and comparison" << endl;
+  Term y = make_shared<GenericTerm>(int_sort, Op(), TermVec{}, "y", true);
+  Term y_prime = make_shared<GenericTerm>(int_sort, Op(), TermVec{}, "y", true);
+  Term z = make_shared<GenericTerm>(int_sort, Op(), TermVec{}, "z", true);
+  Term sum = make_shared<GenericTerm>(int_sort, Op(Plus), TermVec{ y, z }, "");
+  Term sum_prime =
+      make_shared<GenericTerm>(int_sort, Op(Plus), TermVec{ y_prime, z }, "");
+  Term diff = make_shared<GenericTerm>(int_sort, Op(Minus), TermVec{ y, z }, "");
+  assert(sum->hash() == sum_prime->hash());
+  assert(sum == sum_prime);
+  assert(sum != diff);
+  assert(sum->get_id() != sum_prime->get_id());
+  // printing is computed lazily from the children
+  assert(sum->to_string() == "(+ y z)");
+
+  // two equal DAGs with 2^1000 paths that share no nodes:
+  // hashing and comparing them takes linear time
+  Term t = sum;
+  Term u = sum_prime;
+  for (int i = 0; i < 1000; i++)
+  {
+    t = make_shared<GenericTerm>(int_sort, Op(Plus), TermVec{ t, t }, "");
+    u = make_shared<GenericTerm>(int_sort, Op(Plus), TermVec{ u, u }, "");
+  }
+  assert(t.get() != u.get());
+  assert(t->hash() == u->hash());
+  assert(t == u);
+  // differ at the bottom only
+  Term v = diff;
+  for (int i = 0; i < 1000; i++)
+  {
+    v = make_shared<GenericTerm>(int_sort, Op(Plus), TermVec{ v, v }, "");
+  }
+  assert(t != v);
+
+  cout << "Testing ground terms with quantifiers" << endl;
+  Term p = make_shared<GenericTerm>(int_sort, Op(), TermVec{}, "p", false);
+  Term q = make_shared<GenericTerm>(int_sort, Op(), TermVec{}, "q", false);
+  Sort bool_sort = make_generic_sort(BOOL);
+  Term p_gt_q =
+      make_shared<GenericTerm>(bool_sort, Op(Gt), TermVec{ p, q }, "");
+  Term p_gt_y =
+      make_shared<GenericTerm>(bool_sort, Op(Gt), TermVec{ p, y }, "");
+  assert(!static_pointer_cast<GenericTerm>(p)->is_ground());
+  assert(!static_pointer_cast<GenericTerm>(p_gt_q)->is_ground());
+  // q is still free
+  Term exists_p = make_shared<GenericTerm>(
+      bool_sort, Op(Exists), TermVec{ p, p_gt_q }, "");
+  assert(!static_pointer_cast<GenericTerm>(exists_p)->is_ground());
+  Term forall_q = make_shared<GenericTerm>(
+      bool_sort, Op(Forall), TermVec{ q, exists_p }, "");
+  assert(static_pointer_cast<GenericTerm>(forall_q)->is_ground());
+  Term forall_pq = make_shared<GenericTerm>(
+      bool_sort, Op(Forall), TermVec{ p, q, p_gt_q }, "");
+  assert(static_pointer_cast<GenericTerm>(forall_pq)->is_ground());
+  // binding a parameter that does not occur
+  Term forall_q_y = make_shared<GenericTerm>(
+      bool_sort, Op(Forall), TermVec{ q, p_gt_y }, "");
+  assert(!static_pointer_cast<GenericTerm>(forall_q_y)->is_ground());
 }
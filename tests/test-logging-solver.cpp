@@ -150,6 +150,40 @@ TEST_P(LoggingTests, Compare)
   EXPECT_EQ(fxv, fyv);
 }
 
+TEST_P(LoggingTests, GarbageCollection)
+{
+  shared_ptr<LoggingSolver> ls = static_pointer_cast<LoggingSolver>(s);
+  size_t num_terms = ls->get_stats().num_terms;
+
+  Term sum = x;
+  for (size_t i = 0; i < 100; ++i)
+  {
+    sum = s->make_term(BVAdd, sum, y);
+  }
+  Term kept = s->make_term(BVMul, x, y);
+  LoggingSolverStats stats = ls->get_stats();
+  EXPECT_EQ(stats.num_terms, num_terms + 101);
+
+  // the chain is only referenced by sum
+  sum = nullptr;
+  EXPECT_EQ(ls->collect_garbage(), 100);
+  stats = ls->get_stats();
+  EXPECT_EQ(stats.num_terms, num_terms + 1);
+  EXPECT_EQ(stats.num_collected, 100);
+
+  // terms that are still referenced are hash-consed as before
+  Term kept_2 = s->make_term(BVMul, x, y);
+  EXPECT_EQ(kept.get(), kept_2.get());
+
+  // automatic collection bounds the size of the table
+  ls->set_gc_interval(10);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    Term tmp = s->make_term(BVAdd, kept, s->make_term(i % 16, bvsort4));
+  }
+  EXPECT_LT(ls->get_stats().num_terms, num_terms + 1 + 2 * 10);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverLoggingTests,
     LoggingTests,
@@ -18,6 +18,8 @@
 #define STRFY(A) STRHELPER(A)
 
 #include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
 #include <utility>
 #include <vector>
 
@@ -122,6 +124,24 @@ TEST_P(IntReaderTests, QF_UFLIA_Smt2Files)
   }
 }
 
+TEST_P(IntReaderTests, QF_UFLIA_Smt2FilesParallel)
+{
+  string test = STRFY(SMT_SWITCH_DIR);
+  auto testpair = get<1>(GetParam());
+  test += "/tests/smt2/qf_uflia/" + testpair.first;
+  // with assertions parsed on two threads
+  reader->parse_parallel(test, 2);
+  auto results = reader->get_results();
+  auto expected_results = testpair.second;
+  ASSERT_EQ(results.size(), expected_results.size());
+
+  size_t size = results.size();
+  for (size_t i = 0; i < size; i++)
+  {
+    EXPECT_EQ(results[i], expected_results[i]);
+  }
+}
+
 TEST_P(StrReaderTests, QF_S_Smt2Files)
 {
   // SMT_SWITCH_DIR is a macro defined at build time
@@ -160,6 +180,64 @@ TEST_P(BitVecReaderTests, QF_UFBV_Smt2Files)
   }
 }
 
+TEST_P(BitVecReaderTests, QF_UFBV_Smt2Streams)
+{
+  string test = STRFY(SMT_SWITCH_DIR);
+  auto testpair = get<1>(GetParam());
+  test += "/tests/smt2/qf_ufbv/" + testpair.first;
+  // as commands arriving on a pipe, one line at a time
+  ifstream in(test);
+  reader->parse(in, true, testpair.first);
+  auto results = reader->get_results();
+  auto expected_results = testpair.second;
+  ASSERT_EQ(results.size(), expected_results.size());
+
+  size_t size = results.size();
+  for (size_t i = 0; i < size; i++)
+  {
+    EXPECT_EQ(results[i], expected_results[i]);
+  }
+}
+
+TEST_P(BitVecReaderTests, QF_UFBV_Smt2Strings)
+{
+  string test = STRFY(SMT_SWITCH_DIR);
+  auto testpair = get<1>(GetParam());
+  test += "/tests/smt2/qf_ufbv/" + testpair.first;
+  // from a memory buffer
+  ifstream in(test);
+  stringstream buf;
+  buf << in.rdbuf();
+  reader->parse_string(buf.str());
+  auto results = reader->get_results();
+  auto expected_results = testpair.second;
+  ASSERT_EQ(results.size(), expected_results.size());
+
+  size_t size = results.size();
+  for (size_t i = 0; i < size; i++)
+  {
+    EXPECT_EQ(results[i], expected_results[i]);
+  }
+}
+
+TEST_P(BitVecReaderTests, QF_UFBV_Smt2FilesParallel)
+{
+  string test = STRFY(SMT_SWITCH_DIR);
+  auto testpair = get<1>(GetParam());
+  test += "/tests/smt2/qf_ufbv/" + testpair.first;
+  // with assertions parsed on two threads
+  reader->parse_parallel(test, 2);
+  auto results = reader->get_results();
+  auto expected_results = testpair.second;
+  ASSERT_EQ(results.size(), expected_results.size());
+
+  size_t size = results.size();
+  for (size_t i = 0; i < size; i++)
+  {
+    EXPECT_EQ(results[i], expected_results[i]);
+  }
+}
+
 TEST_P(ArrayIntReaderTests, QF_ALIA_Smt2Files)
 {
   // SMT_SWITCH_DIR is a macro defined at build time
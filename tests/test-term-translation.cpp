@@ -21,6 +21,7 @@
 
 #include "available_solvers.h"
 #include "gtest/gtest.h"
+#include "multi_term_translator.h"
 #include "smt.h"
 #include "test-utils.h"
 
@@ -134,6 +135,27 @@ TEST_P(SelfTranslationTests, BVTransfer)
   ASSERT_TRUE(s2->check_sat().is_sat());
 }
 
+TEST_P(SelfTranslationTests, BVValues)
+{
+  SmtSolver s2 = create_solver(GetParam());
+  TermTranslator tt(s2);
+  tt.reserve(16);
+
+  // values on both sides of the bounds for converting with to_int
+  vector<pair<string, uint64_t>> vals({ { "5", 8 },
+                                        { "4294967296", 40 },
+                                        { "18446744073709551615", 64 },
+                                        { "1267650600228229401496703205376",
+                                          101 } });
+  for (const auto & v : vals)
+  {
+    Term val = s->make_term(v.first, s->make_sort(BV, v.second), 10);
+    Term val_2 = tt.transfer_term(val);
+    ASSERT_TRUE(val_2->is_value());
+    ASSERT_EQ(val_2, s2->make_term(v.first, s2->make_sort(BV, v.second), 10));
+  }
+}
+
 TEST_P(SelfTranslationIntTests, IntTransfer)
 {
   SmtSolver s2 = create_solver(GetParam());
@@ -294,6 +316,38 @@ TEST_P(TranslationTests, UninterpretedSort)
   EXPECT_EQ(fv, fv_1);
 }
 
+TEST_P(TranslationTests, FanOut)
+{
+  SmtSolver s3 = create_solver(get<1>(GetParam()));
+  Term xpy = s1->make_term(BVAdd, x, y);
+  Term constraint = s1->make_term(And,
+                                  s1->make_term(Equal, z, xpy),
+                                  s1->make_term(Or, a, b));
+  constraint = s1->make_term(
+      And, constraint, s1->make_term(BVUlt, x, s1->make_term(5, bvsort8)));
+
+  MultiTermTranslator mtt({ s2, s3 });
+  TermVec res = mtt.transfer_term(constraint, BOOL);
+  ASSERT_EQ(res.size(), 2);
+
+  // same result as translating to each solver separately
+  TermTranslator to_s2(s2);
+  EXPECT_EQ(res[0], to_s2.transfer_term(constraint, BOOL));
+  TermTranslator to_s3(s3);
+  EXPECT_EQ(res[1], to_s3.transfer_term(constraint, BOOL));
+
+  // subterms are available in each target
+  EXPECT_EQ(mtt.get_term(1, xpy), to_s3.transfer_term(xpy));
+
+  // terms are only walked once, new ones can be added incrementally
+  Term xmy = s1->make_term(BVMul, xpy, y);
+  EXPECT_THROW(mtt.get_term(0, xmy), IncorrectUsageException);
+  mtt.prepare({ xmy });
+  mtt.replay(0);
+  EXPECT_EQ(mtt.get_term(0, xmy), to_s2.transfer_term(xmy));
+  EXPECT_THROW(mtt.get_term(1, xmy), IncorrectUsageException);
+}
+
 TEST_P(BoolArrayTranslationTests, Arrays)
 {
   Term f = s1->make_term(false);
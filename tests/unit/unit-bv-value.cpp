@@ -0,0 +1,109 @@
+/*********************                                                        */
+/*! \file unit-bv-value.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for solver-neutral bit-vector values.
+**
+**
+**/
+
+#include <string>
+
+#include "available_solvers.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitBVValueTests);
+class UnitBVValueTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override { s = create_solver(GetParam()); }
+  SmtSolver s;
+};
+
+TEST(UnitBVValue, Bases)
+{
+  // 2^100 + 5
+  string dec = "1267650600228229401496703205381";
+  string hex = "10000000000000000000000005";
+  string bin = "1" + string(97, '0') + "101";
+
+  BVValue v10(dec, 101, 10);
+  BVValue v16(hex, 101, 16);
+  BVValue v2(bin, 101, 2);
+  EXPECT_EQ(v10, v16);
+  EXPECT_EQ(v10, v2);
+  EXPECT_EQ(v10.to_decimal_string(), dec);
+  EXPECT_EQ(v10.to_binary_string(), bin);
+  EXPECT_FALSE(v10.fits_uint64());
+  EXPECT_TRUE(v10.get_bit(100));
+  EXPECT_FALSE(v10.get_bit(99));
+
+  EXPECT_EQ(BVValue::from_smt2("#b" + bin, 101), v10);
+  EXPECT_EQ(BVValue::from_smt2("#x" + hex, 101), v10);
+  EXPECT_EQ(BVValue::from_smt2("(_ bv" + dec + " 101)", 101), v10);
+  EXPECT_EQ(BVValue::from_smt2("true", 1), BVValue(1, 1));
+
+  EXPECT_THROW(BVValue(dec, 100, 10), IncorrectUsageException);
+  EXPECT_THROW(BVValue(hex, 100, 16), IncorrectUsageException);
+  EXPECT_THROW(BVValue("12a", 8, 10), IncorrectUsageException);
+  EXPECT_THROW(BVValue::from_smt2("x", 8), IncorrectUsageException);
+}
+
+TEST(UnitBVValue, Uint64)
+{
+  BVValue v(64, UINT64_MAX);
+  EXPECT_TRUE(v.fits_uint64());
+  EXPECT_EQ(v.to_uint64(), UINT64_MAX);
+  EXPECT_EQ(v.to_decimal_string(), "18446744073709551615");
+
+  // bits above the width are dropped
+  BVValue w(4, 0x1f);
+  EXPECT_EQ(w.to_uint64(), 0xf);
+  EXPECT_EQ(w.to_binary_string(), "1111");
+
+  BVValue z(130);
+  EXPECT_EQ(z.to_decimal_string(), "0");
+  z.set_bit(129, true);
+  EXPECT_THROW(z.to_uint64(), IncorrectUsageException);
+  z.set_bit(129, false);
+  EXPECT_EQ(z, BVValue(130, 0));
+}
+
+TEST_P(UnitBVValueTests, RoundTrip)
+{
+  for (uint64_t width : { 1, 8, 64, 65, 200 })
+  {
+    Sort bvsort = s->make_sort(BV, width);
+    BVValue v(width);
+    for (uint64_t i = 0; i < width; i += 3)
+    {
+      v.set_bit(i, true);
+    }
+    Term t = s->make_term(v, bvsort);
+    ASSERT_TRUE(t->is_value());
+    ASSERT_EQ(t, s->make_term(v.to_binary_string(), bvsort, 2));
+    ASSERT_EQ(t->to_bv_value(), v);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverUnitBVValue,
+                         UnitBVValueTests,
+                         testing::ValuesIn(filter_solver_configurations(
+                             { THEORY_BV })));
+
+}  // namespace smt_tests
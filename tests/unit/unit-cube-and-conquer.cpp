@@ -0,0 +1,139 @@
+/*********************                                                        */
+/*! \file unit-cube-and-conquer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for CubeAndConquer.
+**
+**
+**/
+
+#include "available_solvers.h"
+#include "cube_and_conquer.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitCubeAndConquerTests);
+class UnitCubeAndConquerTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+
+    boolsort = s->make_sort(BOOL);
+    bvsort = s->make_sort(BV, 8);
+  }
+
+  vector<SmtSolver> make_workers(size_t n)
+  {
+    vector<SmtSolver> res;
+    for (size_t i = 0; i < n; ++i)
+    {
+      SmtSolver w = create_solver(GetParam());
+      w->set_opt("produce-models", "true");
+      res.push_back(w);
+    }
+    return res;
+  }
+
+  SmtSolver s;
+  Sort boolsort, bvsort;
+};
+
+TEST_P(UnitCubeAndConquerTests, SplitLiterals)
+{
+  Term b = s->make_symbol("b", boolsort);
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term ite = s->make_term(Ite, b, x, y);
+
+  CubeAndConquer cc(s, make_workers(1));
+  cc.assert_formula(s->make_term(BVUlt, ite, s->make_term(BVAdd, x, x)));
+
+  TermVec lits = cc.choose_split_literals(3);
+  ASSERT_EQ(lits.size(), 3);
+  // Boolean symbols first, then the top bit of x, in the most subterms
+  EXPECT_EQ(lits[0], b);
+  Term one = s->make_term(1, s->make_sort(BV, 1));
+  EXPECT_EQ(lits[1],
+            s->make_term(Equal, s->make_term(Op(Extract, 7, 7), x), one));
+  EXPECT_EQ(lits[2],
+            s->make_term(Equal, s->make_term(Op(Extract, 7, 7), y), one));
+
+  // 1 + 8 + 8 bits
+  EXPECT_EQ(cc.choose_split_literals(100).size(), 17);
+}
+
+TEST_P(UnitCubeAndConquerTests, Sat)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Sort wide = s->make_sort(BV, 16);
+  // factors of 143 = 11 * 13, without overflow
+  Term xw = s->make_term(Op(Zero_Extend, 8), x);
+  Term yw = s->make_term(Op(Zero_Extend, 8), y);
+
+  CubeAndConquer cc(s, make_workers(3));
+  cc.assert_formula(s->make_term(
+      Equal, s->make_term(BVMul, xw, yw), s->make_term(143, wide)));
+  cc.assert_formula(s->make_term(BVUgt, x, s->make_term(1, bvsort)));
+  cc.assert_formula(s->make_term(BVUlt, x, y));
+
+  Result r = cc.check_sat(4);
+  ASSERT_TRUE(r.is_sat());
+  EXPECT_EQ(cc.get_sat_cube().size(), 4);
+  EXPECT_EQ(cc.get_value(x)->to_int(), 11);
+  EXPECT_EQ(cc.get_value(y)->to_int(), 13);
+
+  // later assertions are transferred at the next check
+  cc.assert_formula(s->make_term(BVUgt, x, s->make_term(11, bvsort)));
+  r = cc.check_sat(2);
+  EXPECT_TRUE(r.is_unsat());
+  EXPECT_EQ(cc.get_num_refuted(), 4);
+  EXPECT_THROW(cc.get_sat_cube(), IncorrectUsageException);
+}
+
+TEST_P(UnitCubeAndConquerTests, Unsat)
+{
+  Term b = s->make_symbol("b", boolsort);
+  Term x = s->make_symbol("x", bvsort);
+  Term four = s->make_term(4, bvsort);
+
+  CubeAndConquer cc(s, make_workers(2));
+  cc.assert_formula(s->make_term(Implies, b, s->make_term(BVUlt, x, four)));
+  cc.assert_formula(s->make_term(
+      Implies, s->make_term(Not, b), s->make_term(BVUle, x, four)));
+  cc.assert_formula(s->make_term(BVUgt, x, s->make_term(8, bvsort)));
+
+  Result r = cc.check_sat(3);
+  EXPECT_TRUE(r.is_unsat());
+  EXPECT_EQ(cc.get_num_refuted(), 8);
+
+  // no splitting literals, a single cube
+  r = cc.check_sat_cubes({});
+  EXPECT_TRUE(r.is_unsat());
+  EXPECT_EQ(cc.get_num_refuted(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParameterizedUnitCubeAndConquerTests,
+    UnitCubeAndConquerTests,
+    testing::ValuesIn(filter_solver_configurations({ FULL_TRANSFER,
+                                                     THEORY_BV,
+                                                     TERMITER })));
+
+}  // namespace smt_tests
@@ -0,0 +1,121 @@
+/*********************                                                        */
+/*! \file unit-smtlib-prescan.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for the SMT-LIB pre-scanning used by
+**        SmtLibReader::parse_parallel.
+**
+**
+**/
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "smtlib_prescan.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+TEST(UnitSmtLibPrescan, SplitCommands)
+{
+  string text =
+      "; a comment (\n"
+      "(set-logic QF_UFBV)\n"
+      "(declare-fun |f )| ((_ BitVec 8)) (_ BitVec 8))\n"
+      "(assert (= (|f )| x) #x00)) ; (\n"
+      "(echo \"a ) \\\" (\")\n"
+      "(assert\n  true)\n"
+      "(check-sat) (exit";
+  vector<SmtLibCommand> cmds = split_smtlib_commands(text);
+  ASSERT_EQ(cmds.size(), 7);
+  EXPECT_EQ(cmds[0].keyword, "set-logic");
+  EXPECT_EQ(cmds[0].text, "(set-logic QF_UFBV)");
+  EXPECT_EQ(cmds[0].line, 2);
+  EXPECT_EQ(cmds[1].keyword, "declare-fun");
+  EXPECT_EQ(cmds[2].keyword, "assert");
+  EXPECT_EQ(cmds[2].body, " (= (|f )| x) #x00)");
+  EXPECT_EQ(cmds[3].keyword, "echo");
+  EXPECT_EQ(cmds[4].body, "\n  true");
+  EXPECT_EQ(cmds[4].line, 6);
+  EXPECT_EQ(cmds[5].keyword, "check-sat");
+  EXPECT_EQ(cmds[5].line, 8);
+  // unbalanced
+  EXPECT_EQ(cmds[6].keyword, "");
+  EXPECT_EQ(cmds[6].text, "(exit");
+}
+
+TEST(UnitSmtLibPrescan, ParseTerm)
+{
+  SmtLibTermDag dag;
+  ASSERT_TRUE(dag.parse(
+      "(let ((a (bvadd x #b01)) (b ((_ extract 3 2) a)))"
+      " (and (= b (_ bv2 2)) (|p q| a 10 1.5)))"));
+  const vector<SmtLibTermNode> & nodes = dag.get_nodes();
+  const vector<uint32_t> & children = dag.get_children();
+
+  // x #b01 bvadd extract bv2 = 10 1.5 |p q| and
+  ASSERT_EQ(nodes.size(), 10);
+  EXPECT_EQ(nodes[0].kind, SMTLIB_SYMBOL);
+  EXPECT_EQ(nodes[0].text, "x");
+  EXPECT_EQ(nodes[1].kind, SMTLIB_BINARY);
+  EXPECT_EQ(nodes[1].text, "01");
+  EXPECT_EQ(nodes[2].kind, SMTLIB_APPLY);
+  EXPECT_EQ(nodes[2].text, "bvadd");
+  EXPECT_EQ(nodes[3].kind, SMTLIB_INDEXED_APPLY);
+  EXPECT_EQ(nodes[3].text, "extract");
+  EXPECT_EQ(nodes[3].num_idx, 2);
+  EXPECT_EQ(nodes[3].idx0, 3);
+  EXPECT_EQ(nodes[3].idx1, 2);
+  // a is shared
+  ASSERT_EQ(nodes[3].num_children, 1);
+  EXPECT_EQ(children[nodes[3].first_child], 2);
+  EXPECT_EQ(nodes[4].kind, SMTLIB_BV_DECIMAL);
+  EXPECT_EQ(nodes[4].text, "2");
+  EXPECT_EQ(nodes[4].idx0, 2);
+  EXPECT_EQ(nodes[6].kind, SMTLIB_NUMERAL);
+  EXPECT_EQ(nodes[7].kind, SMTLIB_DECIMAL);
+  EXPECT_EQ(nodes[8].kind, SMTLIB_APPLY);
+  EXPECT_EQ(nodes[8].text, "p q");
+  EXPECT_EQ(children[nodes[8].first_child], 2);
+  EXPECT_EQ(dag.get_root(), 9);
+  EXPECT_EQ(nodes[9].text, "and");
+
+  // a let-bound root
+  ASSERT_TRUE(dag.parse("(let ((a (f x))) (let ((b y)) a))"));
+  EXPECT_EQ(dag.get_nodes()[dag.get_root()].text, "f");
+
+  ASSERT_TRUE(dag.parse(" x "));
+  EXPECT_EQ(dag.get_nodes().size(), 1);
+}
+
+TEST(UnitSmtLibPrescan, Unsupported)
+{
+  SmtLibTermDag dag;
+  for (const string & t : { "(forall ((x Int)) (> x 0))",
+                            "(! x :named y)",
+                            "(= s \"str\")",
+                            "((as const (Array Int Int)) 0)",
+                            "(let ((a x)) (let ((a y)) a))",
+                            "(f x",
+                            "(f x))",
+                            "x y",
+                            "()",
+                            "#q0",
+                            "12ab",
+                            "" })
+  {
+    EXPECT_FALSE(dag.parse(t)) << t;
+  }
+}
+
+}  // namespace smt_tests
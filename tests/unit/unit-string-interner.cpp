@@ -0,0 +1,92 @@
+/*********************                                                        */
+/*! \file unit-string-interner.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for StringInterner.
+**
+**
+**/
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "string_interner.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+TEST(UnitStringInterner, Unique)
+{
+  StringInterner interner;
+  string x = "x";
+  InternedString a = interner.intern(x);
+  InternedString b = interner.intern("x");
+  InternedString c = interner.intern("xy");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.view().data(), b.view().data());
+  EXPECT_NE(a, c);
+  // a substring of an interned string is a different string
+  EXPECT_NE(interner.intern(c.view().substr(0, 1)), c);
+  EXPECT_EQ(interner.intern(c.view().substr(0, 1)), a);
+  EXPECT_EQ(interner.size(), 2);
+
+  EXPECT_EQ(a.str(), "x");
+  EXPECT_EQ(strcmp(c.c_str(), "xy"), 0);
+  EXPECT_EQ("_" + a, "_x");
+  EXPECT_EQ(c + "z", "xyz");
+
+  // the empty string is not null
+  InternedString e = interner.intern("");
+  EXPECT_FALSE(e.is_null());
+  EXPECT_TRUE(InternedString().is_null());
+  EXPECT_NE(e, InternedString());
+  EXPECT_EQ(e, interner.intern(string()));
+  EXPECT_EQ(e.size(), 0);
+}
+
+TEST(UnitStringInterner, ManyStrings)
+{
+  StringInterner interner;
+  vector<InternedString> interned;
+  // enough to fill several blocks, with a few strings that get their own
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    string s = "sym_" + to_string(i);
+    if (i % 1000 == 0)
+    {
+      s += string(100000, 'a');
+    }
+    interned.push_back(interner.intern(s));
+  }
+  EXPECT_EQ(interner.size(), 20000);
+
+  // the strings do not move when more are added
+  unordered_map<InternedString, size_t> index;
+  for (size_t i = 0; i < interned.size(); ++i)
+  {
+    string s = "sym_" + to_string(i);
+    if (i % 1000 == 0)
+    {
+      s += string(100000, 'a');
+    }
+    EXPECT_EQ(interned[i].view(), s);
+    EXPECT_EQ(interner.intern(s), interned[i]);
+    index[interned[i]] = i;
+  }
+  EXPECT_EQ(index.size(), 20000);
+  EXPECT_EQ(index.at(interner.intern("sym_42")), 42);
+}
+
+}  // namespace smt_tests
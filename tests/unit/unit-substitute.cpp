@@ -20,6 +20,7 @@
 #include "gtest/gtest.h"
 
 #include "available_solvers.h"
+#include "substituter.h"
 #include "substitution_walker.h"
 #include "utils.h"
 
@@ -122,6 +123,40 @@ TEST_P(UnitSubstituteTests, SimpleSubstitutionWalker)
   EXPECT_EQ(apb, apb_spec);
 }
 
+TEST_P(UnitSubstituteIterTests, Substituter)
+{
+  Term apb = s->make_term(BVAdd, a, b);
+  Substituter sub(s, { { x, a }, { y, b } });
+  EXPECT_EQ(sub.substitute(xpy), apb);
+  EXPECT_EQ(sub.substitute(a), a);
+
+  // the cache is shared by the calls
+  Term xpy2 = s->make_term(BVMul, xpy, xpy);
+  size_t size = sub.cache_size();
+  TermVec res = sub.substitute_terms({ xpy2, x });
+  EXPECT_EQ(res[0], s->make_term(BVMul, apb, apb));
+  EXPECT_EQ(res[1], a);
+  EXPECT_EQ(sub.cache_size(), size + 1);
+
+  // a new map clears the cache
+  sub.set_map({ { x, b } });
+  EXPECT_EQ(sub.get_map().size(), 1);
+  EXPECT_EQ(sub.substitute(xpy), s->make_term(BVAdd, b, y));
+  sub.clear_cache();
+  EXPECT_EQ(sub.cache_size(), 1);
+}
+
+TEST_P(UnitSubstituteIterTests, SubstituteNonSymbol)
+{
+  // the keys do not have to be symbols
+  Term apb = s->make_term(BVAdd, a, b);
+  Term t = s->make_term(BVMul, xpy, x);
+  Term res = s->substitute(t, { { xpy, apb } });
+  EXPECT_EQ(res, s->make_term(BVMul, apb, x));
+  EXPECT_EQ(s->substitute_terms({ t, xpy }, { { xpy, apb } }),
+            TermVec({ res, apb }));
+}
+
 TEST_P(UnitSubstituteTests, BadSubstitution)
 {
   Sort diff_bvsort = s->make_sort(BV, bvsort->get_width() + 1);
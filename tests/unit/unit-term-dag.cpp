@@ -0,0 +1,221 @@
+/*********************                                                        */
+/*! \file unit-term-dag.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for the binary term DAG format.
+**
+**
+**/
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "available_solvers.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+#include "term_dag.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitTermDagTests);
+class UnitTermDagTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+
+    boolsort = s->make_sort(BOOL);
+    bvsort = s->make_sort(BV, 8);
+    widesort = s->make_sort(BV, 100);
+    funsort = s->make_sort(FUNCTION, SortVec{ bvsort, bvsort, boolsort });
+    arrsort = s->make_sort(ARRAY, bvsort, bvsort);
+  }
+  SmtSolver s;
+  Sort boolsort, bvsort, widesort, funsort, arrsort;
+};
+
+TEST_P(UnitTermDagTests, RoundTrip)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term f = s->make_symbol("f", funsort);
+  Term arr = s->make_symbol("arr", arrsort);
+  Term w = s->make_symbol("w", widesort);
+
+  Term big = s->make_term(BVValue::from_smt2("#x80000000000000000000000ff", 100),
+                          widesort);
+  Term t1 = s->make_term(
+      And,
+      s->make_term(Apply, f, s->make_term(BVAdd, x, s->make_term(1, bvsort)), y),
+      s->make_term(BVUlt, s->make_term(Select, arr, x), y));
+  Term t2 = s->make_term(Equal, s->make_term(Op(Extract, 99, 92), w), x);
+  Term t3 = s->make_term(BVUge, s->make_term(Op(Zero_Extend, 92), y), big);
+  TermVec roots{ t1, t2, t3, t1 };
+
+  stringstream ss;
+  TermDag dag;
+  dag.write(ss, roots);
+
+  // loading into the same solver gives back the same terms
+  TermDagLoader loader(s);
+  TermVec loaded = loader.load(ss);
+  ASSERT_EQ(loaded.size(), roots.size());
+  for (size_t i = 0; i < roots.size(); ++i)
+  {
+    EXPECT_EQ(loaded[i], roots[i]);
+  }
+
+  // and into a fresh one the same structure
+  SmtSolver s2 = create_solver(GetParam());
+  TermDagLoader loader2(s2);
+  ss.clear();
+  ss.seekg(0);
+  TermVec loaded2 = loader2.load(ss);
+  ASSERT_EQ(loaded2.size(), roots.size());
+  for (size_t i = 0; i < roots.size(); ++i)
+  {
+    EXPECT_EQ(loaded2[i]->to_string(), roots[i]->to_string());
+  }
+  EXPECT_EQ(loaded2[0], loaded2[3]);
+}
+
+TEST_P(UnitTermDagTests, Quantifier)
+{
+  if (!solver_has_attribute(s->get_solver_enum(), QUANTIFIERS))
+  {
+    return;
+  }
+  Term x = s->make_symbol("x", bvsort);
+  Term p = s->make_param("p", bvsort);
+  Term q = s->make_term(
+      Forall, p, s->make_term(BVUle, s->make_term(BVAnd, p, x), p));
+
+  stringstream ss;
+  TermDag dag;
+  dag.write(ss, { q });
+
+  // the bound variable comes back as a parameter
+  SmtSolver s2 = create_solver(GetParam());
+  TermDagLoader loader(s2);
+  TermVec loaded = loader.load(ss);
+  ASSERT_EQ(loaded.size(), 1);
+  EXPECT_EQ(loaded[0]->to_string(), q->to_string());
+  TermVec loaded_children(loaded[0]->begin(), loaded[0]->end());
+  ASSERT_EQ(loaded_children.size(), 2);
+  EXPECT_TRUE(loaded_children[0]->is_param());
+}
+
+TEST_P(UnitTermDagTests, Malformed)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term t = s->make_term(BVAdd, x, s->make_term(2, bvsort));
+
+  stringstream ss;
+  TermDag dag;
+  dag.write(ss, { t });
+  string good = ss.str();
+
+  TermDagLoader loader(s);
+
+  istringstream empty("");
+  EXPECT_THROW(loader.load(empty), IncorrectUsageException);
+
+  for (size_t len : { size_t(4), size_t(40), good.size() - 8 })
+  {
+    istringstream truncated(good.substr(0, len));
+    EXPECT_THROW(loader.load(truncated), IncorrectUsageException);
+  }
+
+  string bad_magic = good;
+  bad_magic[0] = 'X';
+  istringstream bm(bad_magic);
+  EXPECT_THROW(loader.load(bm), IncorrectUsageException);
+
+  // the version directly follows the 8-byte magic
+  string bad_version = good;
+  bad_version[8]++;
+  istringstream bv(bad_version);
+  EXPECT_THROW(loader.load(bv), IncorrectUsageException);
+
+  istringstream ok(good);
+  TermVec loaded = loader.load(ok);
+  ASSERT_EQ(loaded.size(), 1);
+  EXPECT_EQ(loaded[0], t);
+}
+
+TEST_P(UnitTermDagTests, MalformedSort)
+{
+  Term f = s->make_symbol("f", funsort);
+  Term x = s->make_symbol("x", bvsort);
+  Term t = s->make_term(Apply, f, x, x);
+
+  stringstream ss;
+  TermDag dag;
+  dag.write(ss, { t });
+  string good = ss.str();
+
+  // the sort table directly follows the 56-byte header,
+  // and the number of sorts follows the magic and the version
+  const size_t sorts_begin = 56;
+  uint32_t num_sorts;
+  memcpy(&num_sorts, good.data() + 12, sizeof(num_sorts));
+
+  // loads good with the first sort of kind sk changed by change
+  auto load_changed = [&](SortKind sk, void (*change)(TermDagSort &)) {
+    string bad = good;
+    for (uint32_t i = 0; i < num_sorts; ++i)
+    {
+      char * pos = &bad[sorts_begin + i * sizeof(TermDagSort)];
+      TermDagSort ds;
+      memcpy(&ds, pos, sizeof(ds));
+      if (ds.kind == sk)
+      {
+        change(ds);
+        memcpy(pos, &ds, sizeof(ds));
+        break;
+      }
+    }
+    istringstream in(bad);
+    TermDagLoader loader(s);
+    return loader.load(in);
+  };
+
+  // a function sort without a domain
+  EXPECT_THROW(
+      load_changed(FUNCTION, [](TermDagSort & ds) { ds.num_args = 1; }),
+      IncorrectUsageException);
+  EXPECT_THROW(load_changed(BV, [](TermDagSort & ds) { ds.width = 0; }),
+               IncorrectUsageException);
+  // an earlier sort as an argument of a boolean sort
+  EXPECT_THROW(load_changed(BOOL,
+                            [](TermDagSort & ds) {
+                              ds.first_arg = 0;
+                              ds.num_args = 1;
+                            }),
+               IncorrectUsageException);
+
+  TermVec loaded = load_changed(FUNCTION, [](TermDagSort & ds) {});
+  ASSERT_EQ(loaded.size(), 1);
+  EXPECT_EQ(loaded[0], t);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverUnitTermDag,
+                         UnitTermDagTests,
+                         testing::ValuesIn(filter_solver_configurations(
+                             { TERMITER, THEORY_BV })));
+
+}  // namespace smt_tests
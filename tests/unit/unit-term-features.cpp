@@ -0,0 +1,234 @@
+/*********************                                                        */
+/*! \file unit-term-features.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for TermFeatures and SolverSelector.
+**
+**
+**/
+
+#include <sstream>
+#include <string>
+
+#include "available_solvers.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+#include "solver_selector.h"
+#include "term_features.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitTermFeaturesTests);
+class UnitTermFeaturesTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+
+    boolsort = s->make_sort(BOOL);
+    bvsort = s->make_sort(BV, 8);
+    widesort = s->make_sort(BV, 100);
+  }
+  SmtSolver s;
+  Sort boolsort, bvsort, widesort;
+};
+
+TEST_P(UnitTermFeaturesTests, Features)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term two = s->make_term(2, bvsort);
+
+  // x * 2 is linear, x * y is not
+  Term lin = s->make_term(BVMul, x, two);
+  Term sum = s->make_term(BVAdd, lin, lin);
+  Term t1 = s->make_term(BVUlt, sum, y);
+
+  TermFeatures f;
+  f.add_term(t1);
+  EXPECT_EQ(f.get_num_symbols(), 2);
+  EXPECT_EQ(f.get_num_values(), 1);
+  // t1, sum, lin, x, y, 2: lin is shared
+  EXPECT_EQ(f.get_num_nodes(), 6);
+  EXPECT_EQ(f.get_op_count(BVMul), 1);
+  EXPECT_EQ(f.get_op_count(BVAdd), 1);
+  EXPECT_EQ(f.get_max_bv_width(), 8);
+  EXPECT_FALSE(f.has_nonlinear());
+  EXPECT_FALSE(f.has_arrays());
+  EXPECT_FALSE(f.has_uf());
+  EXPECT_FALSE(f.has_quantifiers());
+  string bucket = f.get_bucket();
+  EXPECT_EQ(bucket.substr(0, 3), "BV ");
+
+  // adding the same term again changes nothing
+  f.add_term(t1);
+  EXPECT_EQ(f.get_num_nodes(), 6);
+  EXPECT_EQ(f.get_bucket(), bucket);
+
+  Term w = s->make_symbol("w", widesort);
+  Term t2 = s->make_term(
+      Equal, s->make_term(BVMul, w, w), s->make_term(0, widesort));
+  f.add_term(t2);
+  EXPECT_EQ(f.get_num_symbols(), 3);
+  EXPECT_EQ(f.get_max_bv_width(), 100);
+  EXPECT_TRUE(f.has_nonlinear());
+  EXPECT_NE(f.get_bucket(), bucket);
+  EXPECT_EQ(f.get_bucket().substr(0, 6), "BV.NL ");
+
+  f.clear();
+  EXPECT_EQ(f.get_num_nodes(), 0);
+  EXPECT_EQ(f.get_bucket(), "B n0 s0 w0");
+}
+
+// whether the features of t have a nonlinear operator
+bool nonlinear(const Term & t)
+{
+  TermFeatures f;
+  f.add_term(t);
+  return f.has_nonlinear();
+}
+
+TEST_P(UnitTermFeaturesTests, BVDivision)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term one = s->make_term(1, bvsort);
+  Term five = s->make_term(5, bvsort);
+
+  // the divisor decides
+  EXPECT_FALSE(nonlinear(s->make_term(BVUdiv, x, five)));
+  EXPECT_TRUE(nonlinear(s->make_term(BVUdiv, one, x)));
+  EXPECT_FALSE(nonlinear(s->make_term(BVSrem, x, five)));
+  EXPECT_TRUE(nonlinear(s->make_term(BVUrem, five, x)));
+  EXPECT_TRUE(nonlinear(s->make_term(BVSmod, five, x)));
+  EXPECT_FALSE(nonlinear(s->make_term(BVMul, five, x)));
+}
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitTermFeaturesArithTests);
+class UnitTermFeaturesArithTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+
+    intsort = s->make_sort(INT);
+    realsort = s->make_sort(REAL);
+  }
+  SmtSolver s;
+  Sort intsort, realsort;
+};
+
+TEST_P(UnitTermFeaturesArithTests, Arith)
+{
+  Term x = s->make_symbol("x", intsort);
+  Term y = s->make_symbol("y", intsort);
+  Term two = s->make_term(2, intsort);
+  Term five = s->make_term(5, intsort);
+  Term r = s->make_symbol("r", realsort);
+  Term rone = s->make_term(1, realsort);
+  Term rtwo = s->make_term(2, realsort);
+
+  EXPECT_FALSE(nonlinear(s->make_term(Mult, two, x)));
+  EXPECT_TRUE(nonlinear(s->make_term(Mult, x, y)));
+  // the base of a power is not a value
+  EXPECT_TRUE(nonlinear(s->make_term(Pow, x, two)));
+  EXPECT_FALSE(nonlinear(s->make_term(Div, r, rtwo)));
+  EXPECT_TRUE(nonlinear(s->make_term(Div, rone, r)));
+  EXPECT_FALSE(nonlinear(s->make_term(Mod, x, five)));
+  EXPECT_TRUE(nonlinear(s->make_term(Mod, five, x)));
+  EXPECT_FALSE(nonlinear(s->make_term(IntDiv, x, two)));
+  EXPECT_TRUE(nonlinear(s->make_term(IntDiv, two, x)));
+}
+
+TEST(UnitSolverSelectorTests, Rank)
+{
+  SolverSelector sel;
+  vector<string> names{ "a", "b", "c" };
+
+  // unknown buckets keep the given order
+  EXPECT_EQ(sel.rank("bucket", names), vector<size_t>({ 0, 1, 2 }));
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    sel.record("bucket", "a", false, 1.0);
+    sel.record("bucket", "b", true, 0.5);
+    sel.record("bucket", "c", true, 0.25);
+  }
+  SolverPerformance perf = sel.get_performance("bucket", "b");
+  EXPECT_EQ(perf.runs, 4);
+  EXPECT_EQ(perf.wins, 4);
+  EXPECT_DOUBLE_EQ(perf.win_seconds, 2.0);
+
+  // same win rates, c is faster
+  EXPECT_EQ(sel.rank("bucket", names), vector<size_t>({ 2, 1, 0 }));
+  // a solver that was never run ranks before one that always loses
+  EXPECT_EQ(sel.rank("bucket", { "a", "d" }), vector<size_t>({ 1, 0 }));
+  EXPECT_EQ(sel.rank("other", names), vector<size_t>({ 0, 1, 2 }));
+}
+
+TEST(UnitSolverSelectorTests, SaveLoad)
+{
+  SolverSelector sel;
+  sel.record("BV n3 s1 w3", "btor", true, 0.1);
+  sel.record("BV n3 s1 w3", "z3", false, 0);
+  sel.record("B n0 s0 w0", "z3", true, 1.0 / 3);
+
+  stringstream ss;
+  sel.save(ss);
+  SolverSelector loaded;
+  loaded.load(ss);
+  stringstream ss2;
+  loaded.save(ss2);
+  EXPECT_EQ(ss.str(), ss2.str());
+
+  SolverPerformance perf = loaded.get_performance("B n0 s0 w0", "z3");
+  EXPECT_EQ(perf.runs, 1);
+  EXPECT_EQ(perf.wins, 1);
+  EXPECT_EQ(perf.win_seconds, 1.0 / 3);
+
+  // loading adds to the existing entries
+  stringstream ss3(ss.str());
+  loaded.load(ss3);
+  EXPECT_EQ(loaded.get_performance("BV n3 s1 w3", "z3").runs, 2);
+
+  for (const char * bad : { "bucket\tsolver\t1\t1\n",
+                            "bucket\tsolver\t1\t2\t0.5\n",
+                            "bucket\tsolver\tone\t1\t0.5\n",
+                            "bucket\tsolver\t-1\t-1\t0.5\n",
+                            "bucket\tsolver\t1\t1\t-0\n",
+                            "\tsolver\t1\t1\t0.5\n" })
+  {
+    // the first line is valid, but nothing is loaded
+    stringstream in("bucket\tsolver\t1\t1\t0.5\n" + string(bad));
+    EXPECT_THROW(loaded.load(in), IncorrectUsageException);
+    EXPECT_EQ(loaded.get_performance("bucket", "solver").runs, 0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParameterizedUnitTermFeaturesTests,
+    UnitTermFeaturesTests,
+    testing::ValuesIn(filter_solver_configurations({ THEORY_BV })));
+
+INSTANTIATE_TEST_SUITE_P(
+    ParameterizedUnitTermFeaturesArithTests,
+    UnitTermFeaturesArithTests,
+    testing::ValuesIn(filter_solver_configurations({ THEORY_INT,
+                                                     THEORY_REAL })));
+
+}  // namespace smt_tests
@@ -71,6 +71,46 @@ TEST_P(UnitTestsHashTable, HashTable)
   ASSERT_EQ(cp_xp1_2.use_count(), 1);
 }
 
+TEST_P(UnitTestsHashTable, ResizeAndErase)
+{
+  // enough terms for several resizes of the table
+  Term x = s->make_symbol("x", bvsort);
+  TermVec terms{ x };
+  for (size_t i = 0; i < 500; ++i)
+  {
+    terms.push_back(s->make_term(BVAdd, terms.back(), x));
+  }
+  for (const Term & t : terms)
+  {
+    table.insert(t);
+  }
+  // inserting an equal term does not add it again
+  table.insert(s->make_term(BVAdd, terms[0], x));
+  ASSERT_EQ(table.size(), terms.size());
+
+  // erasing leaves the other terms reachable
+  for (size_t i = 0; i < terms.size(); i += 2)
+  {
+    table.erase(terms[i]);
+  }
+  ASSERT_EQ(table.size(), terms.size() / 2);
+  for (size_t i = 0; i < terms.size(); ++i)
+  {
+    ASSERT_EQ(table.contains(terms[i]), i % 2 == 1);
+  }
+
+  Term y = s->make_symbol("y", bvsort);
+  Term xpy = s->make_term(BVAdd, x, y);
+  Term xpy_2 = s->make_term(BVAdd, x, y);
+  ASSERT_FALSE(table.lookup_or_insert(xpy));
+  ASSERT_TRUE(table.lookup_or_insert(xpy_2));
+  ASSERT_EQ(xpy.get(), xpy_2.get());
+
+  table.clear();
+  ASSERT_EQ(table.size(), 0);
+  ASSERT_FALSE(table.contains(xpy));
+}
+
 // similarly to logging solvers, generic solvers
 // increase the usage count and so we ignore
 // them in this test
@@ -0,0 +1,101 @@
+/*********************                                                        */
+/*! \file unit-term-id-map.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for TermIdMap.
+**
+**
+**/
+
+#include "available_solvers.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+#include "term_id_map.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitTestsTermIdMap);
+class UnitTestsTermIdMap
+    : public testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    bvsort = s->make_sort(BV, 8);
+  }
+  SmtSolver s;
+  Sort bvsort;
+  TermIdMap map;
+};
+
+TEST_P(UnitTestsTermIdMap, SetFindClear)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term xpy = s->make_term(BVAdd, x, y);
+  ASSERT_EQ(map.find(x), nullptr);
+
+  map.set(x, y);
+  map.set(xpy, x);
+  ASSERT_EQ(map.size(), 2);
+  ASSERT_NE(map.find(x), nullptr);
+  EXPECT_EQ(*map.find(x), y);
+  EXPECT_EQ(*map.find(xpy), x);
+  EXPECT_EQ(map.find(y), nullptr);
+  // an equal term finds the same entry
+  EXPECT_EQ(*map.find(s->make_term(BVAdd, x, y)), x);
+
+  // overwrite
+  map.set(x, xpy);
+  ASSERT_EQ(map.size(), 2);
+  EXPECT_EQ(*map.find(x), xpy);
+
+  map.clear();
+  ASSERT_EQ(map.size(), 0);
+  EXPECT_EQ(map.find(x), nullptr);
+  EXPECT_EQ(map.find(xpy), nullptr);
+
+  // usable after clearing
+  map.set(y, y);
+  EXPECT_EQ(*map.find(y), y);
+}
+
+TEST_P(UnitTestsTermIdMap, ManyTerms)
+{
+  Term x = s->make_symbol("x", bvsort);
+  TermVec terms{ x };
+  for (size_t i = 0; i < 500; ++i)
+  {
+    terms.push_back(s->make_term(BVAdd, terms.back(), x));
+  }
+  for (size_t i = 1; i < terms.size(); ++i)
+  {
+    map.set(terms[i], terms[i - 1]);
+  }
+  ASSERT_EQ(map.size(), terms.size() - 1);
+  EXPECT_EQ(map.find(x), nullptr);
+  for (size_t i = 1; i < terms.size(); ++i)
+  {
+    ASSERT_NE(map.find(terms[i]), nullptr);
+    EXPECT_EQ(*map.find(terms[i]), terms[i - 1]);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParametrizedUnitTermIdMap,
+    UnitTestsTermIdMap,
+    testing::ValuesIn(filter_solver_configurations({ THEORY_BV })));
+
+}  // namespace smt_tests
@@ -0,0 +1,88 @@
+/*********************                                                        */
+/*! \file unit-term-template.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the smt-switch project.
+** Copyright (c) 2020 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Unit tests for TermTemplate.
+**
+**
+**/
+
+#include "available_solvers.h"
+#include "gtest/gtest.h"
+#include "smt.h"
+#include "term_template.h"
+
+using namespace smt;
+using namespace std;
+
+namespace smt_tests {
+
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(UnitTermTemplateTests);
+class UnitTermTemplateTests
+    : public ::testing::Test,
+      public testing::WithParamInterface<SolverConfiguration>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+
+    bvsort = s->make_sort(BV, 8);
+    x = s->make_symbol("x", bvsort);
+    y = s->make_symbol("y", bvsort);
+    a = s->make_symbol("a", bvsort);
+    b = s->make_symbol("b", bvsort);
+    c = s->make_symbol("c", bvsort);
+  }
+  SmtSolver s;
+  Sort bvsort;
+  Term x, y, a, b, c;
+};
+
+TEST_P(UnitTermTemplateTests, Instantiate)
+{
+  // (x + y) * (c + 1) < x
+  Term cp1 = s->make_term(BVAdd, c, s->make_term(1, bvsort));
+  Term body = s->make_term(
+      BVUlt, s->make_term(BVMul, s->make_term(BVAdd, x, y), cp1), x);
+  TermTemplate tmpl(body, { x, y });
+  EXPECT_EQ(tmpl.num_params(), 2);
+
+  Term res = tmpl.instantiate(s, { a, b });
+  EXPECT_EQ(res, s->substitute(body, { { x, a }, { y, b } }));
+  // memoized
+  EXPECT_EQ(res, tmpl.instantiate(s, { a, b }));
+
+  res = tmpl.instantiate(s, { y, x });
+  EXPECT_EQ(res, s->substitute(body, { { x, y }, { y, x } }));
+
+  EXPECT_THROW(tmpl.instantiate(s, { a }), IncorrectUsageException);
+}
+
+TEST_P(UnitTermTemplateTests, Corners)
+{
+  // the body is a parameter
+  TermTemplate param(y, { x, y });
+  EXPECT_EQ(param.instantiate(s, { a, b }), b);
+
+  // the body does not contain a parameter
+  Term apb = s->make_term(BVAdd, a, b);
+  TermTemplate constant(apb, { x });
+  EXPECT_EQ(constant.instantiate(s, { c }), apb);
+
+  EXPECT_THROW(TermTemplate(apb, { x, x }), IncorrectUsageException);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParameterizedUnitTermTemplateTests,
+    UnitTermTemplateTests,
+    testing::ValuesIn(filter_solver_configurations({ TERMITER, THEORY_BV })));
+
+}  // namespace smt_tests
@@ -175,6 +175,51 @@ TEST_P(UnitWalkerTests, FunSubstitution)
   EXPECT_EQ(fy, iw.visit(fx));
 }
 
+// counts the pre- and post-order visits, without caching anything
+class CountingWalker : public IdentityWalker
+{
+ public:
+  CountingWalker(const SmtSolver & solver) : IdentityWalker(solver, false) {}
+  size_t num_pre = 0;
+  size_t num_post = 0;
+
+ protected:
+  WalkerStepResult visit_term(Term & term) override
+  {
+    preorder_ ? ++num_pre : ++num_post;
+    return Walker_Continue;
+  }
+};
+
+TEST_P(UnitWalkerTests, SharedDag)
+{
+  // x, x + x, (x + x) + (x + x), ... has 2^depth paths
+  size_t depth = 64;
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term t = x;
+  Term expected = y;
+  for (size_t i = 0; i < depth; ++i)
+  {
+    t = s->make_term(BVAdd, t, t);
+    expected = s->make_term(BVAdd, expected, expected);
+  }
+
+  IdentityWalker iw(s, false);
+  EXPECT_EQ(t, iw.visit(t));
+
+  UnorderedTermMap subs({ { x, y } });
+  IdentityWalker sw(s, false, &subs);
+  EXPECT_EQ(expected, sw.visit(t));
+  EXPECT_EQ(subs.size(), depth + 1);
+
+  // each distinct term is visited once in pre-order
+  CountingWalker cw(s);
+  cw.visit(t);
+  EXPECT_EQ(cw.num_pre, depth + 1);
+  EXPECT_GE(cw.num_post, depth + 1);
+}
+
 /* helper function to test equivalency of passed_map that TreeWalker builds up
  * against expected_map that should have been built up. gets used for all tests
  * using TreeWalker */
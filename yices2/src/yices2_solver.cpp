@@ -291,6 +291,35 @@ Term Yices2Solver::make_term(const std::string val,
   return std::make_shared<Yices2Term> (y_term);
 }
 
+Term Yices2Solver::make_term(const BVValue & val, const Sort & sort) const
+{
+  if (sort->get_sort_kind() != BV || sort->get_width() != val.get_width())
+  {
+    string msg("Can't create bit-vector value of width ");
+    msg += std::to_string(val.get_width());
+    msg += " with sort ";
+    msg += sort->to_string();
+    throw IncorrectUsageException(msg);
+  }
+
+  // least significant bit first
+  uint64_t width = val.get_width();
+  std::vector<int32_t> bits(width);
+  for (uint64_t i = 0; i < width; ++i)
+  {
+    bits[i] = val.get_bit(i);
+  }
+  term_t y_term = yices_bvconst_from_array(width, bits.data());
+
+  if (yices_error_code() != 0)
+  {
+    std::string msg(yices_error_string());
+    throw InternalSolverException(msg.c_str());
+  }
+
+  return std::make_shared<Yices2Term>(y_term);
+}
+
 Term Yices2Solver::make_term(const Term & val, const Sort & sort) const
 {
   throw NotImplementedException(
@@ -1021,15 +1050,21 @@ void Yices2Solver::reset_assertions() { yices_reset_context(ctx); }
 Term Yices2Solver::substitute(const Term term,
                               const UnorderedTermMap & substitution_map) const
 {
-  shared_ptr<Yices2Term> yterm = static_pointer_cast<Yices2Term>(term);
+  return substitute_terms({ term }, substitution_map)[0];
+}
 
+TermVec Yices2Solver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
+{
   vector<term_t> to_subst;
   vector<term_t> values;
+  to_subst.reserve(substitution_map.size());
+  values.reserve(substitution_map.size());
 
   shared_ptr<Yices2Term> tmp_key;
   shared_ptr<Yices2Term> tmp_val;
 
-  for (auto elem : substitution_map)
+  for (const auto & elem : substitution_map)
   {
     tmp_key = static_pointer_cast<Yices2Term>(elem.first);
 
@@ -1039,16 +1074,43 @@ Term Yices2Solver::substitute(const Term term,
     values.push_back(tmp_val->term);
   }
 
-  term_t res =
-      yices_subst_term(to_subst.size(), &to_subst[0], &values[0], yterm->term);
+  vector<term_t> yterms;
+  yterms.reserve(terms.size());
+  for (const Term & term : terms)
+  {
+    yterms.push_back(static_pointer_cast<Yices2Term>(term)->term);
+  }
 
-  if (yices_error_code() != 0)
+  // substitutes all the terms at once, in place, sharing the work
+  // on common subterms
+  if (!yterms.empty())
   {
-    std::string msg(yices_error_string());
-    throw InternalSolverException(msg.c_str());
+    yices_subst_term_array(to_subst.size(),
+                           to_subst.data(),
+                           values.data(),
+                           yterms.size(),
+                           yterms.data());
+
+    if (yices_error_code() != 0)
+    {
+      std::string msg(yices_error_string());
+      throw InternalSolverException(msg.c_str());
+    }
   }
 
-  return std::make_shared<Yices2Term> (res);
+  TermVec res;
+  res.reserve(yterms.size());
+  for (term_t t : yterms)
+  {
+    res.push_back(std::make_shared<Yices2Term>(t));
+  }
+  return res;
+}
+
+void Yices2Solver::interrupt()
+{
+  // no effect unless a search is running in ctx
+  yices_stop_search(ctx);
 }
 
 void Yices2Solver::dump_smt2(std::string filename) const
@@ -446,6 +446,33 @@ uint64_t Yices2Term::to_int() const
   }
 }
 
+BVValue Yices2Term::to_bv_value()
+{
+  if (!yices_term_is_bitvector(term)
+      || yices_term_constructor(term) != YICES_BV_CONSTANT)
+  {
+    std::string msg = to_string();
+    msg += " is not a bit-vector constant.";
+    throw IncorrectUsageException(msg.c_str());
+  }
+
+  uint32_t width = yices_term_bitsize(term);
+  // least significant bit first
+  std::vector<int32_t> bits(width);
+  if (yices_bv_const_value(term, bits.data()) != 0)
+  {
+    std::string msg(yices_error_string());
+    throw InternalSolverException(msg.c_str());
+  }
+
+  BVValue res(width);
+  for (uint32_t i = 0; i < width; ++i)
+  {
+    res.set_bit(i, bits[i]);
+  }
+  return res;
+}
+
 TermIter Yices2Term::begin()
 {
   throw NotImplementedException(
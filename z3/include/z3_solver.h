@@ -100,6 +100,7 @@ class Z3Solver : public AbsSmtSolver
   Term make_term(const std::string val,
                  const Sort & sort,
                  uint64_t base = 10) const override;
+  Term make_term(const BVValue & val, const Sort & sort) const override;
   Term make_term(const Term & val, const Sort & sort) const override;
   Term make_symbol(const std::string name, const Sort & sort) override;
   Term get_symbol(const std::string & name) override;
@@ -114,8 +115,12 @@ class Z3Solver : public AbsSmtSolver
   Term make_term(Op op, const TermVec & terms) const override;
   void reset() override;
   void reset_assertions() override;
+  void interrupt() override;
   Term substitute(const Term term,
                   const UnorderedTermMap & substitution_map) const override;
+  TermVec substitute_terms(
+      const TermVec & terms,
+      const UnorderedTermMap & substitution_map) const override;
   void dump_smt2(std::string filename) const override;
 
   // getters for solver-specific objects (EXPERTS ONLY)
@@ -500,6 +500,26 @@ Term Z3Solver::make_term(const std::string val,
   return std::make_shared<Z3Term>(z_term, ctx);
 }
 
+Term Z3Solver::make_term(const BVValue & val, const Sort & sort) const
+{
+  if (sort->get_sort_kind() != BV || sort->get_width() != val.get_width())
+  {
+    throw IncorrectUsageException("Can't create bit-vector value of width "
+                                  + std::to_string(val.get_width())
+                                  + " with sort " + sort->to_string());
+  }
+
+  // least significant bit first
+  uint64_t width = val.get_width();
+  std::unique_ptr<bool[]> bits(new bool[width]);
+  for (uint64_t i = 0; i < width; ++i)
+  {
+    bits[i] = val.get_bit(i);
+  }
+  expr z_term = ctx.bv_val(width, bits.get());
+  return std::make_shared<Z3Term>(z_term, ctx);
+}
+
 Term Z3Solver::make_term(const Term & val, const Sort & sort) const
 {
   std::shared_ptr<Z3Term> zterm = std::static_pointer_cast<Z3Term>(val);
@@ -1247,32 +1267,44 @@ void Z3Solver::reset() { slv.reset(); }
 
 void Z3Solver::reset_assertions() { slv.reset(); }
 
+void Z3Solver::interrupt() { ctx.interrupt(); }
+
 Term Z3Solver::substitute(const Term term,
                           const UnorderedTermMap & substitution_map) const
+{
+  return substitute_terms({ term }, substitution_map)[0];
+}
+
+TermVec Z3Solver::substitute_terms(
+    const TermVec & terms, const UnorderedTermMap & substitution_map) const
 {
   // z3 expression vectors that represent the
   // substitution map, i.e.:
   // substitutionmap[z3sources[i]] = z3destinations[i]
+  // built once for the whole batch
   z3::expr_vector z3sources(ctx);
   z3::expr_vector z3destinations(ctx);
 
-  // z3 counterpart of `term`
-  shared_ptr<Z3Term> z3term = static_pointer_cast<Z3Term>(term);
-  expr z3expr = to_expr(ctx, z3term->term);
   // populate the z3 expr_vectors according to the substitution map
-  for (auto p : substitution_map)
+  for (const auto & p : substitution_map)
   {
-    Term from_term = p.first;
-    Term to_term = p.second;
-    shared_ptr<Z3Term> z3_from_term = static_pointer_cast<Z3Term>(from_term);
-    shared_ptr<Z3Term> z3_to_term = static_pointer_cast<Z3Term>(to_term);
+    shared_ptr<Z3Term> z3_from_term = static_pointer_cast<Z3Term>(p.first);
+    shared_ptr<Z3Term> z3_to_term = static_pointer_cast<Z3Term>(p.second);
     z3sources.push_back(z3_from_term->term);
     z3destinations.push_back(z3_to_term->term);
   }
 
-  // perform the substitution and return the result
-  expr result = z3expr.substitute(z3sources, z3destinations);
-  return std::make_shared<Z3Term>(result, ctx);
+  // perform the substitutions and return the results
+  TermVec res;
+  res.reserve(terms.size());
+  for (const Term & term : terms)
+  {
+    shared_ptr<Z3Term> z3term = static_pointer_cast<Z3Term>(term);
+    expr z3expr = to_expr(ctx, z3term->term);
+    expr result = z3expr.substitute(z3sources, z3destinations);
+    res.push_back(std::make_shared<Z3Term>(result, ctx));
+  }
+  return res;
 }
 
 void Z3Solver::dump_smt2(std::string filename) const